@@ -39,6 +39,14 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
                 sel_col = check_column(all_cols, sel_col);  // 列元数据校验
             }
         }
+        // 处理order by的字段
+        if (x->has_sort) {
+            for (size_t i = 0; i < x->order->cols.size(); i++) {
+                TabCol order_col = {.tab_name = x->order->cols[i]->tab_name, .col_name = x->order->cols[i]->col_name};
+                query->order_cols.push_back(check_column(all_cols, order_col));
+                query->order_descs.push_back(x->order->orderby_dirs[i] == ast::OrderBy_DESC);
+            }
+        }
         //处理where条件
         get_clause(x->conds, query->conds);
         check_clause(query->tables, query->conds);
@@ -30,6 +30,9 @@ class Query{
     std::vector<TabCol> cols;
     // 表名
     std::vector<std::string> tables;
+    // order by的字段（按优先级从高到低）和每个字段是否降序
+    std::vector<TabCol> order_cols;
+    std::vector<bool> order_descs;
     // update 的set 值
     std::vector<SetClause> set_clauses;
     //insert 的values值
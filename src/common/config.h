@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <string>
 
 #define BUFFER_LENGTH 8192
 
@@ -34,8 +35,14 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_PARTITIONS = 8;                              // number of buffer pool partitions, each with its own latch
+static constexpr int BUFFER_POOL_CLEAN_FRAMES = BUFFER_POOL_SIZE / 16;        // clean frames the background page cleaner keeps ready
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 100;                          // interval between two page cleaner passes
+static constexpr int READ_AHEAD_WINDOW = 32;                                  // pages prefetched per read-ahead, 0 disables it
+static constexpr int READ_AHEAD_TRIGGER = 2;                                  // sequential misses on a file that trigger read-ahead
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr size_t EXEC_MEMORY_BUDGET = 64 * 1024 * 1024;               // memory an operator may use before spilling to disk
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -48,7 +55,7 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// replacer: "LRU", "CLOCK" or "LRU-K"
 static const std::string REPLACER_TYPE = "LRU";
 
 static const std::string DB_META_NAME = "db.meta";
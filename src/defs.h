@@ -52,6 +52,11 @@ inline std::string coltype2str(ColType type) {
     return m.at(type);
 }
 
+// 索引的类型：B+树支持范围查询；哈希索引只支持所有索引字段上的等值查询
+enum IndexType {
+    INDEX_BTREE, INDEX_HASH
+};
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -10,5 +10,79 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
 #include "defs.h"
 #include "errors.h"
+
+static constexpr size_t BATCH_SIZE = 1024;  // 批量执行时每批最多的记录条数
+
+/**
+ * @description: 批量执行时在算子之间传递的一批记录。
+ * 记录按行连续存放在同一块内存中（每条tuple_len_字节），避免逐条分配RmRecord；
+ * 选择向量sel_记录仍然有效的行号，过滤时只需改写sel_而不移动数据
+ */
+class RecordBatch {
+   public:
+    RecordBatch() = default;
+
+    explicit RecordBatch(size_t tuple_len) { reset(tuple_len); }
+
+    // 清空batch，并设置每条记录的长度
+    void reset(size_t tuple_len) {
+        tuple_len_ = tuple_len;
+        data_.resize(BATCH_SIZE * tuple_len_);
+        rids_.resize(BATCH_SIZE);
+        clear();
+    }
+
+    // 清空batch中的记录，保留已分配的内存
+    void clear() {
+        num_rows_ = 0;
+        sel_.clear();
+    }
+
+    size_t tuple_len() const { return tuple_len_; }
+
+    // batch中的行数（包括被过滤掉的行）
+    size_t num_rows() const { return num_rows_; }
+
+    bool is_full() const { return num_rows_ == BATCH_SIZE; }
+
+    // 在末尾追加一行并返回其地址，新行默认被选中，调用者负责填充数据
+    char *append_row(const Rid &rid = Rid{-1, -1}) {
+        assert(!is_full());
+        rids_[num_rows_] = rid;
+        sel_.push_back(static_cast<uint16_t>(num_rows_));
+        return row(num_rows_++);
+    }
+
+    // 撤销最后追加的一行
+    void pop_row() {
+        assert(num_rows_ > 0 && sel_.back() == num_rows_ - 1);
+        sel_.pop_back();
+        num_rows_--;
+    }
+
+    char *row(size_t i) { return data_.data() + i * tuple_len_; }
+
+    const Rid &rid(size_t i) const { return rids_[i]; }
+
+    // 选择向量，依次为仍然有效的行号
+    std::vector<uint16_t> &sel() { return sel_; }
+
+    // 有效的行数
+    size_t size() const { return sel_.size(); }
+
+    // 第k条有效记录的地址
+    char *selected_row(size_t k) { return row(sel_[k]); }
+
+   private:
+    size_t tuple_len_ = 0;
+    size_t num_rows_ = 0;
+    std::vector<char> data_;
+    std::vector<Rid> rids_;
+    std::vector<uint16_t> sel_;
+};
@@ -0,0 +1,159 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "common/common.h"
+#include "execution_defs.h"
+#include "system/sm_meta.h"
+
+/**
+ * @description: 编译后的where/join条件。
+ * 构造时一次性解析每个条件中字段的偏移、长度和类型，并按（类型 × 比较运算符）选出模板实例化的比较函数；
+ * 之后对每条记录求值时不再按名字查找字段，也不再按类型和运算符分支
+ */
+class CompiledPredicate {
+   public:
+    CompiledPredicate() = default;
+
+    /**
+     * @param {vector<Condition>&} conds 条件，所有条件之间为AND关系
+     * @param {vector<ColMeta>&} cols 被求值的记录的字段
+     * @note 条件中的字段不在cols中时 throw ColumnNotFoundError
+     */
+    CompiledPredicate(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols) {
+        for (auto &cond : conds) {
+            const ColMeta &lhs_col = find_col(cols, cond.lhs_col);
+            CompiledCond compiled;
+            compiled.lhs_offset = lhs_col.offset;
+            compiled.len = lhs_col.len;
+            ColType type;
+            if (cond.is_rhs_val) {
+                type = cond.rhs_val.type;
+                compiled.rhs_raw = cond.rhs_val.raw;
+                compiled.rhs_val = compiled.rhs_raw->data;
+            } else {
+                const ColMeta &rhs_col = find_col(cols, cond.rhs_col);
+                type = rhs_col.type;
+                compiled.rhs_offset = rhs_col.offset;
+            }
+            compiled.eval = select_eval(type, cond.op);
+            conds_.push_back(std::move(compiled));
+        }
+    }
+
+    bool empty() const { return conds_.empty(); }
+
+    // 判断记录是否满足所有条件
+    bool eval(const char *record) const {
+        for (auto &cond : conds_) {
+            const char *rhs = cond.rhs_val != nullptr ? cond.rhs_val : record + cond.rhs_offset;
+            if (!cond.eval(record + cond.lhs_offset, rhs, cond.len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 对batch中的有效记录求值，从选择向量中去掉不满足条件的行
+    void filter(RecordBatch &batch) const {
+        if (conds_.empty()) {
+            return;
+        }
+        auto &sel = batch.sel();
+        sel.erase(std::remove_if(sel.begin(), sel.end(), [&](uint16_t i) { return !eval(batch.row(i)); }), sel.end());
+    }
+
+   private:
+    using EvalFn = bool (*)(const char *lhs, const char *rhs, int len);
+
+    struct CompiledCond {
+        EvalFn eval;
+        int lhs_offset;
+        int len;                            // 左字段的长度，字符串比较的长度
+        int rhs_offset = 0;                 // 右侧为字段时，右字段的偏移
+        const char *rhs_val = nullptr;      // 右侧为常量时，常量的数据
+        std::shared_ptr<RmRecord> rhs_raw;  // 保证常量的数据在求值期间有效
+    };
+
+    template <CompOp op>
+    static bool apply_op(int cmp) {
+        if constexpr (op == OP_EQ) {
+            return cmp == 0;
+        } else if constexpr (op == OP_NE) {
+            return cmp != 0;
+        } else if constexpr (op == OP_LT) {
+            return cmp < 0;
+        } else if constexpr (op == OP_GT) {
+            return cmp > 0;
+        } else if constexpr (op == OP_LE) {
+            return cmp <= 0;
+        } else {
+            return cmp >= 0;
+        }
+    }
+
+    // 与ix_compare的比较语义一致，按类型特化
+    template <ColType type, CompOp op>
+    static bool eval_cond(const char *lhs, const char *rhs, int len) {
+        if constexpr (type == TYPE_INT) {
+            int a, b;
+            memcpy(&a, lhs, sizeof(int));
+            memcpy(&b, rhs, sizeof(int));
+            return apply_op<op>((a < b) ? -1 : ((a > b) ? 1 : 0));
+        } else if constexpr (type == TYPE_FLOAT) {
+            float a, b;
+            memcpy(&a, lhs, sizeof(float));
+            memcpy(&b, rhs, sizeof(float));
+            return apply_op<op>((a < b) ? -1 : ((a > b) ? 1 : 0));
+        } else {
+            return apply_op<op>(memcmp(lhs, rhs, len));
+        }
+    }
+
+    template <ColType type>
+    static EvalFn select_eval(CompOp op) {
+        switch (op) {
+            case OP_EQ: return eval_cond<type, OP_EQ>;
+            case OP_NE: return eval_cond<type, OP_NE>;
+            case OP_LT: return eval_cond<type, OP_LT>;
+            case OP_GT: return eval_cond<type, OP_GT>;
+            case OP_LE: return eval_cond<type, OP_LE>;
+            case OP_GE: return eval_cond<type, OP_GE>;
+            default: throw InternalError("Invalid CompOp");
+        }
+    }
+
+    static EvalFn select_eval(ColType type, CompOp op) {
+        switch (type) {
+            case TYPE_INT: return select_eval<TYPE_INT>(op);
+            case TYPE_FLOAT: return select_eval<TYPE_FLOAT>(op);
+            case TYPE_STRING: return select_eval<TYPE_STRING>(op);
+            default: throw InternalError("Unexpected data type");
+        }
+    }
+
+    static const ColMeta &find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        auto pos = std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+            return col.tab_name == target.tab_name && col.name == target.col_name;
+        });
+        if (pos == cols.end()) {
+            throw ColumnNotFoundError(target.tab_name + '.' + target.col_name);
+        }
+        return *pos;
+    }
+
+    std::vector<CompiledCond> conds_;
+};
@@ -11,39 +11,323 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 #include "execution_defs.h"
 #include "execution_manager.h"
+#include "execution_spill.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
-class SortExecutor : public AbstractExecutor {
+/**
+ * @description: 排序，支持多个排序键，每个键可以分别指定升序或降序。
+ * 每条记录的排序键转换为规范化的格式（ix_normalize_key()，降序的键再按位取反），两条记录的顺序就是规范化key的memcmp结果，
+ * 排序时先比较规范化key的前8个字节（prefix），相同时才比较剩下的部分。
+ * 输入不超过内存预算时在内存中排序；超过时把每个内存预算大小的有序段（run）写入临时文件，
+ * 最后用败者树对所有run做k路归并，边归并边输出；run的数量超过MAX_MERGE_FANIN时先把其中一部分归并成更长的run。
+ * 排序键相同的记录保持输入的顺序
+ */
+class SortExecutor : public BatchExecutor {
    private:
+    static constexpr size_t MAX_MERGE_FANIN = 64;  // 一次归并的最大路数，每一路有一个SpillFile的缓冲区
+    static constexpr uint32_t NONE = UINT32_MAX;   // 败者树中表示没有记录的一路
+
+    // 排序键在记录中的位置
+    struct SortKey {
+        ColType type;
+        int len;
+        int offset;
+        bool is_desc;
+    };
+
+    // 内存中的一条记录：规范化key的前缀和记录在rows_中的下标
+    struct SortEntry {
+        uint64_t prefix;
+        uint32_t row;
+    };
+
+    // 归并的一路输入：临时文件中的run，或者（最后一次归并时）内存中已经排好序的记录
+    struct MergeSource {
+        std::unique_ptr<SpillFile> file;
+        std::vector<char> row_buf;
+        std::vector<char> key_buf;
+        size_t mem_pos;
+        const char *row;                        // 当前记录，读完时为nullptr
+        const char *key;                        // 当前记录的规范化key
+    };
+
     std::unique_ptr<AbstractExecutor> prev_;
-    ColMeta cols_;                              // 框架中只支持一个键排序，需要自行修改数据结构支持多个键排序
-    size_t tuple_num;
-    bool is_desc_;
-    std::vector<size_t> used_tuple;
-    std::unique_ptr<RmRecord> current_tuple;
+    size_t len_;                                // 每条记录的长度
+    std::vector<SortKey> keys_;                 // 排序键，按优先级从高到低
+    std::vector<ColType> key_types_;            // 按顺序拼接起来的排序键的类型和长度，用于ix_normalize_key()
+    std::vector<int> key_lens_;
+    size_t key_len_;                            // 规范化key的长度
+    std::vector<char> raw_key_;                 // make_key()中拼接排序键的缓冲区
+    size_t mem_budget_;                         // 内存预算：内存中的记录、规范化key和SortEntry的总大小不超过该值
+
+    // 内存中的记录：rows_和norm_keys_中按输入顺序存放，entries_排序后给出输出顺序
+    std::vector<char> rows_;
+    std::vector<char> norm_keys_;
+    std::vector<SortEntry> entries_;
+    size_t entry_pos_;                          // 只在内存中排序时，下一个要输出的记录在entries_中的下标
+
+    std::vector<std::unique_ptr<SpillFile>> runs_;  // 已经写入临时文件的run
+    size_t num_runs_;                           // 输入生成的run的数量
+    std::vector<MergeSource> sources_;          // 最后一次归并的所有输入
+    std::vector<uint32_t> tree_;                // 败者树：tree_[0]为胜者，tree_[1..k-1]为每个内部结点上的败者
 
    public:
-    SortExecutor(std::unique_ptr<AbstractExecutor> prev, TabCol sel_cols, bool is_desc) {
+    /**
+     * @param sel_cols 排序键，按优先级从高到低
+     * @param is_descs 每个排序键是否降序
+     */
+    SortExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols,
+                 const std::vector<bool> &is_descs, size_t mem_budget = EXEC_MEMORY_BUDGET) {
         prev_ = std::move(prev);
-        cols_ = prev_->get_col_offset(sel_cols);
-        is_desc_ = is_desc;
-        tuple_num = 0;
-        used_tuple.clear();
+        len_ = prev_->tupleLen();
+        key_len_ = 0;
+        for (size_t i = 0; i < sel_cols.size(); i++) {
+            const ColMeta &col = *get_col(prev_->cols(), sel_cols[i]);
+            keys_.push_back({col.type, col.len, col.offset, is_descs[i]});
+            key_types_.push_back(col.type);
+            key_lens_.push_back(col.len);
+            key_len_ += col.len;
+        }
+        raw_key_.resize(key_len_);
+        mem_budget_ = mem_budget;
+        num_runs_ = 0;
+        entry_pos_ = 0;
+    }
+
+    // 读入全部输入并排序（或者生成所有run并准备好最后一次归并），然后取出第一个batch供逐条接口使用
+    void beginTuple() override {
+        rows_.clear();
+        norm_keys_.clear();
+        entries_.clear();
+        entry_pos_ = 0;
+        runs_.clear();
+        num_runs_ = 0;
+        sources_.clear();
+        tree_.clear();
+
+        RecordBatch batch;
+        prev_->beginTuple();
+        while (prev_->NextBatch(batch)) {
+            for (size_t k = 0; k < batch.size(); k++) {
+                if (!entries_.empty() && memory_usage() >= mem_budget_) {
+                    spill_run();
+                }
+                const char *row = batch.selected_row(k);
+                uint32_t idx = static_cast<uint32_t>(entries_.size());
+                rows_.insert(rows_.end(), row, row + len_);
+                norm_keys_.resize(norm_keys_.size() + key_len_);
+                make_key(row, norm_keys_.data() + idx * key_len_);
+                entries_.push_back({load_prefix(norm_keys_.data() + idx * key_len_), idx});
+            }
+        }
+        sort_entries();
+        if (num_runs_ > 0) {
+            start_merge();
+        }
+        BatchExecutor::beginTuple();
+    }
+
+    size_t tupleLen() const override { return len_; };
+
+    std::string getType() override { return "SortExecutor"; };
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); };
+
+    // 生成的run的数量，为0表示只在内存中排序
+    size_t num_runs() const { return num_runs_; }
+
+   private:
+    size_t memory_usage() const { return rows_.size() + norm_keys_.size() + entries_.size() * sizeof(SortEntry); }
+
+    // 把记录的排序键拼接起来转换为规范化的key，降序的键按位取反
+    void make_key(const char *row, char *key) {
+        char *raw = raw_key_.data();
+        for (auto &sort_key : keys_) {
+            memcpy(raw, row + sort_key.offset, sort_key.len);
+            raw += sort_key.len;
+        }
+        ix_normalize_key(raw_key_.data(), key, key_types_, key_lens_);
+        for (auto &sort_key : keys_) {
+            if (sort_key.is_desc) {
+                for (int i = 0; i < sort_key.len; i++) {
+                    key[i] = static_cast<char>(~key[i]);
+                }
+            }
+            key += sort_key.len;
+        }
+    }
+
+    // 规范化key的前8个字节按大端序组成的整数，整数的大小关系与这8个字节的memcmp结果一致
+    uint64_t load_prefix(const char *key) const {
+        uint64_t prefix = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); i++) {
+            prefix = (prefix << 8) | (i < key_len_ ? static_cast<unsigned char>(key[i]) : 0);
+        }
+        return prefix;
+    }
+
+    // 对entries_排序：先比较prefix，相同时比较规范化key剩下的部分，再相同时按输入顺序
+    void sort_entries() {
+        const char *keys = norm_keys_.data();
+        size_t key_len = key_len_;
+        std::sort(entries_.begin(), entries_.end(), [keys, key_len](const SortEntry &a, const SortEntry &b) {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            if (key_len > sizeof(uint64_t)) {
+                int cmp = memcmp(keys + a.row * key_len + sizeof(uint64_t), keys + b.row * key_len + sizeof(uint64_t),
+                                 key_len - sizeof(uint64_t));
+                if (cmp != 0) {
+                    return cmp < 0;
+                }
+            }
+            return a.row < b.row;
+        });
+    }
+
+    // 把内存中的记录排序后作为一个run写入临时文件，清空内存
+    void spill_run() {
+        sort_entries();
+        auto file = std::make_unique<SpillFile>(len_);
+        for (auto &entry : entries_) {
+            file->append(rows_.data() + entry.row * len_);
+        }
+        runs_.push_back(std::move(file));
+        num_runs_++;
+        rows_.clear();
+        norm_keys_.clear();
+        entries_.clear();
     }
 
-    void beginTuple() override { 
-        
+    /**
+     * @description: 准备最后一次归并：run的数量超过MAX_MERGE_FANIN时，每一趟把相邻的每fanin个run归并成一个新的run，
+     * 直到所有run加上内存中剩下的记录不超过fanin路，再对它们建立败者树。相邻的run归并后仍然按输入的顺序排列
+     */
+    void start_merge() {
+        size_t fanin = std::max<size_t>(2, std::min(MAX_MERGE_FANIN, mem_budget_ / SpillFile::IO_BUFFER_SIZE));
+        while (runs_.size() + 1 > fanin) {
+            std::vector<std::unique_ptr<SpillFile>> merged;
+            for (size_t i = 0; i < runs_.size(); i += fanin) {
+                size_t end = std::min(runs_.size(), i + fanin);
+                if (end - i == 1) {
+                    merged.push_back(std::move(runs_[i]));
+                    continue;
+                }
+                open_sources({std::make_move_iterator(runs_.begin() + i), std::make_move_iterator(runs_.begin() + end)},
+                             false);
+                auto file = std::make_unique<SpillFile>(len_);
+                for (uint32_t winner = tree_[0]; winner != NONE; winner = pop(winner)) {
+                    file->append(sources_[winner].row);
+                }
+                merged.push_back(std::move(file));
+            }
+            runs_ = std::move(merged);
+        }
+        open_sources(std::move(runs_), !entries_.empty());
+        runs_.clear();
     }
 
-    void nextTuple() override {
-        
+    // 用inputs（以及内存中的记录）作为归并的各路输入，读出每一路的第一条记录并建立败者树
+    void open_sources(std::vector<std::unique_ptr<SpillFile>> inputs, bool with_memory) {
+        sources_.clear();
+        for (auto &file : inputs) {
+            MergeSource source;
+            file->rewind();
+            source.file = std::move(file);
+            source.row_buf.resize(len_);
+            source.key_buf.resize(key_len_);
+            sources_.push_back(std::move(source));
+        }
+        if (with_memory) {
+            MergeSource source;
+            source.mem_pos = 0;
+            sources_.push_back(std::move(source));
+        }
+        for (auto &source : sources_) {
+            advance(source);
+        }
+        tree_.assign(sources_.size(), NONE);
+        uint32_t winner = build(1);
+        tree_[0] = sources_[winner].row == nullptr ? NONE : winner;
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    // 读出一路输入的下一条记录
+    void advance(MergeSource &source) {
+        if (source.file == nullptr) {
+            if (source.mem_pos < entries_.size()) {
+                uint32_t idx = entries_[source.mem_pos++].row;
+                source.row = rows_.data() + idx * len_;
+                source.key = norm_keys_.data() + idx * key_len_;
+            } else {
+                source.row = nullptr;
+            }
+        } else if (source.file->read(source.row_buf.data())) {
+            make_key(source.row_buf.data(), source.key_buf.data());
+            source.row = source.row_buf.data();
+            source.key = source.key_buf.data();
+        } else {
+            source.row = nullptr;
+        }
     }
 
-    Rid &rid() override { return _abstract_rid; }
-};
\ No newline at end of file
+    // 第a路的当前记录是否排在第b路之前：读完的一路排在最后，key相同时编号小的一路（输入中较早的记录）在前
+    bool before(uint32_t a, uint32_t b) const {
+        if (a == NONE || sources_[a].row == nullptr) {
+            return false;
+        }
+        if (b == NONE || sources_[b].row == nullptr) {
+            return true;
+        }
+        int cmp = memcmp(sources_[a].key, sources_[b].key, key_len_);
+        return cmp != 0 ? cmp < 0 : a < b;
+    }
+
+    // 建立以node为根的子树，node >= k时是第node - k路输入对应的叶子；返回子树的胜者，败者留在结点上
+    uint32_t build(size_t node) {
+        size_t k = sources_.size();
+        if (node >= k) {
+            return static_cast<uint32_t>(node - k);
+        }
+        uint32_t left = build(2 * node);
+        uint32_t right = build(2 * node + 1);
+        if (before(left, right)) {
+            tree_[node] = right;
+            return left;
+        }
+        tree_[node] = left;
+        return right;
+    }
+
+    // 输出胜者的当前记录之后，读出这一路的下一条记录，沿着到根的路径重新比赛；返回新的胜者，全部读完时返回NONE
+    uint32_t pop(uint32_t winner) {
+        advance(sources_[winner]);
+        for (size_t node = (winner + sources_.size()) / 2; node > 0; node /= 2) {
+            if (before(tree_[node], winner)) {
+                std::swap(tree_[node], winner);
+            }
+        }
+        tree_[0] = sources_[winner].row == nullptr ? NONE : winner;
+        return tree_[0];
+    }
+
+    /**
+     * @description: 把排好序的下一批记录写入batch
+     * @return batch中是否有记录
+     */
+    bool fill_batch(RecordBatch &batch) override {
+        batch.reset(len_);
+        if (sources_.empty()) {
+            for (; entry_pos_ < entries_.size() && !batch.is_full(); entry_pos_++) {
+                memcpy(batch.append_row(), rows_.data() + entries_[entry_pos_].row * len_, len_);
+            }
+            return batch.size() > 0;
+        }
+        while (!batch.is_full() && tree_[0] != NONE) {
+            memcpy(batch.append_row(), sources_[tree_[0]].row, len_);
+            pop(tree_[0]);
+        }
+        return batch.size() > 0;
+    }
+};
@@ -0,0 +1,77 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+
+#include "common/config.h"
+#include "errors.h"
+
+/**
+ * @description: 算子的内存超过EXEC_MEMORY_BUDGET时，用来把定长记录溢出到磁盘的临时文件。
+ * 记录只能追加写入，rewind()之后从头顺序读出；文件由tmpfile()创建，关闭后自动删除，不经过BufferPoolManager
+ */
+class SpillFile {
+   public:
+    static constexpr size_t IO_BUFFER_SIZE = 16 * PAGE_SIZE;  // 每个文件的stdio缓冲区大小
+
+    explicit SpillFile(size_t tuple_len) : tuple_len_(tuple_len) {
+        file_ = std::tmpfile();
+        if (file_ == nullptr) {
+            throw UnixError();
+        }
+        std::setvbuf(file_, nullptr, _IOFBF, IO_BUFFER_SIZE);
+    }
+
+    ~SpillFile() { std::fclose(file_); }
+
+    SpillFile(const SpillFile &) = delete;
+    SpillFile &operator=(const SpillFile &) = delete;
+
+    // 在文件末尾追加一条记录
+    void append(const char *row) {
+        if (std::fwrite(row, tuple_len_, 1, file_) != 1) {
+            throw UnixError();
+        }
+        num_rows_++;
+    }
+
+    // 回到文件开头，之后用read()顺序读出所有记录
+    void rewind() {
+        if (std::fflush(file_) != 0) {
+            throw UnixError();
+        }
+        std::rewind(file_);
+    }
+
+    // 读出下一条记录，已经读完时返回false
+    bool read(char *row) {
+        if (std::fread(row, tuple_len_, 1, file_) == 1) {
+            return true;
+        }
+        if (std::ferror(file_)) {
+            throw UnixError();
+        }
+        return false;
+    }
+
+    size_t tuple_len() const { return tuple_len_; }
+
+    size_t num_rows() const { return num_rows_; }
+
+    // 文件中记录的总字节数
+    size_t size() const { return num_rows_ * tuple_len_; }
+
+   private:
+    FILE *file_;
+    size_t tuple_len_;
+    size_t num_rows_ = 0;
+};
@@ -42,6 +42,22 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    /**
+     * @description: 批量获取记录。调用beginTuple()之后反复调用，直到返回false。
+     * 默认实现是逐条接口的适配：从当前位置起依次调用Next()/nextTuple()，填充最多BATCH_SIZE条记录，
+     * 未实现批量接口的算子因此也可以作为批量算子的儿子节点
+     * @return {bool} batch中是否有记录，返回false表示已经没有更多记录
+     * @param {RecordBatch&} batch 存放结果的batch，会被清空并按tupleLen()重新设置
+     */
+    virtual bool NextBatch(RecordBatch &batch) {
+        batch.reset(tupleLen());
+        for (; !is_end() && !batch.is_full(); nextTuple()) {
+            auto record = Next();
+            memcpy(batch.append_row(rid()), record->data, batch.tuple_len());
+        }
+        return batch.size() > 0;
+    }
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
@@ -53,4 +69,55 @@ class AbstractExecutor {
         }
         return pos;
     }
+};
+
+/**
+ * @description: 以批量方式生成结果的算子（连接、排序等）的基类。子类只需实现fill_batch()，
+ * 逐条接口由基类适配：beginTuple()时预先取出第一个batch，Next()/nextTuple()逐条读取其中的记录，
+ * NextBatch()先返回预先取出而逐条接口还没有取走的记录，再调用fill_batch()
+ */
+class BatchExecutor : public AbstractExecutor {
+   public:
+    // 子类完成自己的初始化之后调用，预先取出第一个batch
+    void beginTuple() override {
+        fill_batch(out_batch_);
+        out_pos_ = 0;
+    }
+
+    void nextTuple() override {
+        if (++out_pos_ >= out_batch_.size()) {
+            fill_batch(out_batch_);
+            out_pos_ = 0;
+        }
+    }
+
+    std::unique_ptr<RmRecord> Next() override {
+        return std::make_unique<RmRecord>(static_cast<int>(tupleLen()), out_batch_.selected_row(out_pos_));
+    }
+
+    bool NextBatch(RecordBatch &batch) override {
+        if (out_pos_ < out_batch_.size()) {
+            batch.reset(tupleLen());
+            for (; out_pos_ < out_batch_.size(); out_pos_++) {
+                memcpy(batch.append_row(), out_batch_.selected_row(out_pos_), tupleLen());
+            }
+            return true;
+        }
+        return fill_batch(batch);
+    }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    bool is_end() const override { return out_pos_ >= out_batch_.size(); }
+
+   protected:
+    /**
+     * @description: 生成下一批结果记录写入batch，直到batch写满或者没有更多记录
+     * @return batch中是否有记录
+     */
+    virtual bool fill_batch(RecordBatch &batch) = 0;
+
+   private:
+    RecordBatch out_batch_;
+    size_t out_pos_ = 0;
 };
\ No newline at end of file
@@ -42,18 +42,40 @@ class DeleteExecutor : public AbstractExecutor {
     }
     // 用于删除操作
     std::unique_ptr<RmRecord> Next() override {
+        // 1. 找出满足删除条件的记录
+        std::vector<Rid> rids;
+        std::vector<std::unique_ptr<RmRecord>> recs;
         for (Rid rid : rids_) {          // 扫描记录
             if (!fh_->is_record(rid)) {  // 无记录扫描下一条
                 continue;
             }
-
-            if (!condCheck(fh_->get_record(rid, context_).get())) {  // 记录检查是否符合where语句
+            auto rec = fh_->get_record(rid, context_);
+            if (!condCheck(rec.get())) {  // 记录检查是否符合where语句
                 continue;
             }
-
-            // 满足删除条件，删除
+            rids.push_back(rid);
+            recs.push_back(std::move(rec));
+        }
+        // 2. 先删除记录（同时加上记录的X锁），再维护索引，避免加锁失败时记录还在而索引中的key已经被删除
+        for (auto &rid : rids) {
             fh_->delete_record(rid, context_);
         }
+        // 3. 从表上的每个索引中批量删除这些记录的key
+        for (auto &index : tab_.indexes) {
+            std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            std::vector<char> keys(recs.size() * index.col_tot_len);
+            std::vector<const char *> key_ptrs;
+            for (size_t i = 0; i < recs.size(); i++) {
+                char *key = keys.data() + i * index.col_tot_len;
+                index.get_key(recs[i]->data, key);
+                key_ptrs.push_back(key);
+            }
+            if (index.type == INDEX_HASH) {
+                sm_manager_->hhs_.at(ix_name)->delete_entries(key_ptrs, rids, context_->txn_);
+            } else {
+                sm_manager_->ihs_.at(ix_name)->delete_entries(key_ptrs, rids, context_->txn_);
+            }
+        }
         return nullptr;
     }
 
@@ -0,0 +1,369 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "execution_predicate.h"
+#include "execution_spill.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * @description: 哈希连接。连接条件中左右字段类型和长度都相同的等值条件作为连接键，
+ * 在较小的一侧（build侧）上建立哈希表，用另一侧（probe侧）的每条记录查找哈希值相同的记录，拼接后再检查全部连接条件。
+ * 事先不知道左右两侧的大小：交替从左右儿子各取一个batch缓存在内存中，先结束的一侧较小，作为build侧；
+ * 缓存的记录超过内存预算时两侧都还没有结束，改为grace hash join：按哈希值的高位把两侧的记录分别写入NUM_PARTITIONS个临时文件，
+ * 再逐对连接分区，每对分区中较小的一侧作为build侧；build侧仍然超过内存预算时用哈希值的下一段位继续分区。
+ * 输出记录的格式与NestedLoopJoinExecutor相同（左表字段在前，右表字段在后），输出顺序不确定
+ */
+class HashJoinExecutor : public BatchExecutor {
+   private:
+    static constexpr int LEFT = 0;
+    static constexpr int RIGHT = 1;
+    static constexpr int PARTITION_BITS = 4;
+    static constexpr int NUM_PARTITIONS = 1 << PARTITION_BITS;  // 每次分区的分区数
+    static constexpr int MAX_PARTITION_LEVEL = 4;  // 分区的最大层数，再往下仍然超过预算说明大量记录的连接键相同，不再分区
+    static constexpr uint32_t NIL = UINT32_MAX;    // 哈希链的结尾
+    static constexpr size_t ROW_OVERHEAD = sizeof(uint64_t) + 2 * sizeof(uint32_t);  // 哈希表中每条记录额外占用的内存
+
+    // 连接键在左右两侧记录中的位置
+    struct JoinKey {
+        ColType type;
+        int len;
+        int offset[2];
+    };
+
+    // 一对待连接的分区，files[LEFT]和files[RIGHT]中的记录的哈希值在同一个范围内
+    struct PartitionPair {
+        std::unique_ptr<SpillFile> files[2];
+        int level;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;          // join条件
+    CompiledPredicate pred_;                    // 编译后的join条件，对哈希值相同的记录求值
+    std::vector<JoinKey> keys_;                 // 连接键
+    size_t mem_budget_;                         // 内存预算：build侧的记录加上哈希表的开销不超过该值
+
+    // 哈希表：build侧的记录连续存放在build_rows_中，同一个桶的记录通过build_next_串成链
+    int build_side_;
+    std::vector<char> build_rows_;
+    std::vector<uint64_t> build_hashes_;
+    std::vector<uint32_t> build_next_;
+    std::vector<uint32_t> buckets_;             // 每个桶的链表头，桶的数量为2的幂
+
+    // probe侧的记录：先取probe_buf_中缓存的记录，再从probe侧儿子节点（内存模式）或者分区文件（grace模式）中读取
+    std::vector<char> probe_buf_;
+    size_t probe_buf_pos_;
+    bool probe_from_child_;
+    RecordBatch probe_batch_;
+    size_t probe_batch_pos_;
+    std::unique_ptr<SpillFile> probe_file_;
+    std::vector<char> probe_row_buf_;
+
+    // 当前的probe记录和它在哈希链上的位置，输出batch满时保留，下次从该位置继续
+    const char *probe_row_;
+    uint64_t probe_hash_;
+    uint32_t chain_pos_;
+
+    std::vector<PartitionPair> partitions_;     // 还没有连接的分区（grace模式）
+    bool finished_;
+
+   public:
+    HashJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                     std::vector<Condition> conds, size_t mem_budget = EXEC_MEMORY_BUDGET) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        len_ = left_->tupleLen() + right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_->tupleLen();
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_);
+        mem_budget_ = mem_budget;
+        chain_pos_ = NIL;
+        finished_ = true;
+
+        // 两侧字段类型和长度都相同的等值条件才能作为连接键：它们相等当且仅当（规范化之后的）字节相同
+        auto find = [](const std::vector<ColMeta> &cols, const TabCol &target) {
+            return std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+                return col.tab_name == target.tab_name && col.name == target.col_name;
+            });
+        };
+        auto &left_cols = left_->cols();
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                continue;
+            }
+            TabCol left_col = cond.lhs_col, right_col = cond.rhs_col;
+            if (find(left_cols, left_col) == left_cols.end()) {
+                std::swap(left_col, right_col);
+            }
+            auto lhs = find(left_cols, left_col);
+            auto rhs = find(right_cols, right_col);
+            if (lhs == left_cols.end() || rhs == right_cols.end() || lhs->type != rhs->type || lhs->len != rhs->len) {
+                continue;
+            }
+            keys_.push_back({lhs->type, lhs->len, {lhs->offset, rhs->offset - static_cast<int>(left_->tupleLen())}});
+        }
+    }
+
+    // 读入build侧建立哈希表（或者把两侧写入分区文件），并取出第一个batch供逐条接口使用
+    void beginTuple() override {
+        partitions_.clear();
+        probe_buf_.clear();
+        probe_buf_pos_ = 0;
+        probe_from_child_ = false;
+        probe_batch_.clear();
+        probe_batch_pos_ = 0;
+        probe_file_.reset();
+        chain_pos_ = NIL;
+        finished_ = false;
+        left_->beginTuple();
+        right_->beginTuple();
+        build();
+        BatchExecutor::beginTuple();
+    }
+
+    size_t tupleLen() const override { return len_; };
+
+    std::string getType() override { return "HashJoinExecutor"; };
+
+    const std::vector<ColMeta> &cols() const override { return cols_; };
+
+   private:
+    AbstractExecutor *child(int side) const { return side == LEFT ? left_.get() : right_.get(); }
+
+    // 连接键的哈希值；-0.0与0.0相等，先把浮点数规范化
+    uint64_t hash_key(int side, const char *row) const {
+        uint64_t hash = 0;
+        for (auto &key : keys_) {
+            const char *val = row + key.offset[side];
+            uint64_t col_hash;
+            if (key.type == TYPE_FLOAT) {
+                float f;
+                memcpy(&f, val, sizeof(float));
+                if (f == 0.0f) {
+                    f = 0.0f;
+                }
+                col_hash = ix_hash(reinterpret_cast<const char *>(&f), sizeof(float));
+            } else {
+                col_hash = ix_hash(val, key.len);
+            }
+            hash = (hash ^ col_hash) * 0x9e3779b97f4a7c15ull;
+        }
+        return hash;
+    }
+
+    // 第level层分区使用哈希值从高位开始的第level段PARTITION_BITS位，哈希表的桶使用低位，两者互不相关
+    static int partition_of(uint64_t hash, int level) {
+        return static_cast<int>((hash >> (64 - PARTITION_BITS * (level + 1))) & (NUM_PARTITIONS - 1));
+    }
+
+    /**
+     * @description: 交替从左右儿子节点各取一个batch，直到有一侧结束或者缓存的记录超过内存预算。
+     * 有一侧结束时在这一侧上建立哈希表，另一侧缓存的记录作为probe侧的开头；否则把两侧全部写入分区文件
+     */
+    void build() {
+        RecordBatch batch;
+        std::vector<char> bufs[2];
+        bool ended[2] = {false, false};
+        size_t used = 0;
+        while (!ended[LEFT] && !ended[RIGHT] && used <= mem_budget_) {
+            for (int side : {LEFT, RIGHT}) {
+                if (!child(side)->NextBatch(batch)) {
+                    ended[side] = true;
+                    continue;
+                }
+                for (size_t k = 0; k < batch.size(); k++) {
+                    bufs[side].insert(bufs[side].end(), batch.selected_row(k), batch.selected_row(k) + batch.tuple_len());
+                }
+                used += batch.size() * (batch.tuple_len() + ROW_OVERHEAD);
+            }
+        }
+
+        if (ended[LEFT] || ended[RIGHT]) {
+            int build_side = (ended[LEFT] && (!ended[RIGHT] || bufs[LEFT].size() <= bufs[RIGHT].size())) ? LEFT : RIGHT;
+            if (bufs[build_side].empty()) {
+                finished_ = true;
+                return;
+            }
+            build_table(build_side, std::move(bufs[build_side]));
+            probe_buf_ = std::move(bufs[1 - build_side]);
+            probe_from_child_ = !ended[1 - build_side];
+            return;
+        }
+
+        // grace模式：两侧都超过了内存预算的一半
+        std::vector<PartitionPair> pairs = make_partitions(0);
+        for (int side : {LEFT, RIGHT}) {
+            size_t tuple_len = child(side)->tupleLen();
+            for (size_t pos = 0; pos < bufs[side].size(); pos += tuple_len) {
+                const char *row = bufs[side].data() + pos;
+                pairs[partition_of(hash_key(side, row), 0)].files[side]->append(row);
+            }
+            std::vector<char>().swap(bufs[side]);
+            while (child(side)->NextBatch(batch)) {
+                for (size_t k = 0; k < batch.size(); k++) {
+                    const char *row = batch.selected_row(k);
+                    pairs[partition_of(hash_key(side, row), 0)].files[side]->append(row);
+                }
+            }
+        }
+        add_partitions(std::move(pairs));
+        if (!next_partition()) {
+            finished_ = true;
+        }
+    }
+
+    std::vector<PartitionPair> make_partitions(int level) const {
+        std::vector<PartitionPair> pairs(NUM_PARTITIONS);
+        for (auto &pair : pairs) {
+            pair.files[LEFT] = std::make_unique<SpillFile>(left_->tupleLen());
+            pair.files[RIGHT] = std::make_unique<SpillFile>(right_->tupleLen());
+            pair.level = level;
+        }
+        return pairs;
+    }
+
+    // 加入待连接的分区，内连接中有一侧为空的分区不会产生结果，直接丢弃
+    void add_partitions(std::vector<PartitionPair> pairs) {
+        for (auto &pair : pairs) {
+            if (pair.files[LEFT]->num_rows() > 0 && pair.files[RIGHT]->num_rows() > 0) {
+                partitions_.push_back(std::move(pair));
+            }
+        }
+    }
+
+    /**
+     * @description: 取出下一对分区，在较小的一侧上建立哈希表，另一侧的分区文件作为probe侧
+     * @return 是否还有分区
+     * @note build侧超过内存预算并且还没有达到最大层数时，两侧用下一段哈希位重新分区
+     */
+    bool next_partition() {
+        while (!partitions_.empty()) {
+            PartitionPair pair = std::move(partitions_.back());
+            partitions_.pop_back();
+            for (int side : {LEFT, RIGHT}) {
+                pair.files[side]->rewind();
+            }
+            int build_side = pair.files[LEFT]->size() <= pair.files[RIGHT]->size() ? LEFT : RIGHT;
+            SpillFile &build_file = *pair.files[build_side];
+            if (build_file.num_rows() * (build_file.tuple_len() + ROW_OVERHEAD) > mem_budget_ &&
+                pair.level + 1 < MAX_PARTITION_LEVEL) {
+                std::vector<PartitionPair> pairs = make_partitions(pair.level + 1);
+                for (int side : {LEFT, RIGHT}) {
+                    std::vector<char> row(pair.files[side]->tuple_len());
+                    while (pair.files[side]->read(row.data())) {
+                        pairs[partition_of(hash_key(side, row.data()), pair.level + 1)].files[side]->append(row.data());
+                    }
+                    pair.files[side].reset();
+                }
+                add_partitions(std::move(pairs));
+                continue;
+            }
+            std::vector<char> rows(build_file.size());
+            for (size_t pos = 0; pos < rows.size(); pos += build_file.tuple_len()) {
+                build_file.read(rows.data() + pos);
+            }
+            build_table(build_side, std::move(rows));
+            probe_file_ = std::move(pair.files[1 - build_side]);
+            probe_row_buf_.resize(probe_file_->tuple_len());
+            return true;
+        }
+        return false;
+    }
+
+    // 在side一侧的记录rows上建立哈希表，桶的数量不少于记录数
+    void build_table(int side, std::vector<char> rows) {
+        build_side_ = side;
+        build_rows_ = std::move(rows);
+        size_t tuple_len = child(side)->tupleLen();
+        size_t num_rows = build_rows_.size() / tuple_len;
+        size_t num_buckets = 1;
+        while (num_buckets < num_rows) {
+            num_buckets <<= 1;
+        }
+        buckets_.assign(num_buckets, NIL);
+        build_hashes_.resize(num_rows);
+        build_next_.resize(num_rows);
+        for (size_t i = 0; i < num_rows; i++) {
+            uint64_t hash = hash_key(side, build_rows_.data() + i * tuple_len);
+            uint32_t &head = buckets_[hash & (num_buckets - 1)];
+            build_hashes_[i] = hash;
+            build_next_[i] = head;
+            head = static_cast<uint32_t>(i);
+        }
+    }
+
+    // 取出下一条probe记录，当前哈希表对应的probe记录已经取完时返回nullptr
+    const char *next_probe_row() {
+        if (probe_buf_pos_ < probe_buf_.size()) {
+            const char *row = probe_buf_.data() + probe_buf_pos_;
+            probe_buf_pos_ += child(1 - build_side_)->tupleLen();
+            return row;
+        }
+        if (probe_file_ != nullptr) {
+            return probe_file_->read(probe_row_buf_.data()) ? probe_row_buf_.data() : nullptr;
+        }
+        while (probe_from_child_) {
+            if (probe_batch_pos_ < probe_batch_.size()) {
+                return probe_batch_.selected_row(probe_batch_pos_++);
+            }
+            probe_from_child_ = child(1 - build_side_)->NextBatch(probe_batch_);
+            probe_batch_pos_ = 0;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @description: 生成连接后的记录写入batch，直到batch写满或者连接结束
+     * @return batch中是否有记录
+     */
+    bool fill_batch(RecordBatch &batch) override {
+        // 1. 当前probe记录的哈希链走完时取下一条probe记录，probe记录取完时换到下一对分区，没有分区则连接结束
+        // 2. 沿哈希链找到哈希值相同的build记录，按左、右的顺序拼接并检查连接条件
+        batch.reset(len_);
+        size_t left_len = left_->tupleLen();
+        while (!finished_ && !batch.is_full()) {
+            if (chain_pos_ == NIL) {  // 1
+                probe_row_ = next_probe_row();
+                if (probe_row_ == nullptr) {
+                    finished_ = !next_partition();
+                    continue;
+                }
+                probe_hash_ = hash_key(1 - build_side_, probe_row_);
+                chain_pos_ = buckets_[probe_hash_ & (buckets_.size() - 1)];
+                continue;
+            }
+            uint32_t idx = chain_pos_;  // 2
+            chain_pos_ = build_next_[idx];
+            if (build_hashes_[idx] != probe_hash_) {
+                continue;
+            }
+            const char *build_row = build_rows_.data() + idx * child(build_side_)->tupleLen();
+            char *record = batch.append_row();
+            memcpy(record, build_side_ == LEFT ? build_row : probe_row_, left_len);
+            memcpy(record + left_len, build_side_ == LEFT ? probe_row_ : build_row, len_ - left_len);
+            if (!pred_.eval(record)) {
+                batch.pop_row();
+            }
+        }
+        return batch.size() > 0;
+    }
+};
@@ -0,0 +1,236 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "execution_predicate.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * @description: 索引嵌套循环连接。左儿子节点为外表，右边的内表不再扫描，而是对外表的每条记录，
+ * 用外表的字段（连接条件）和内表上的常量等值条件拼出内表索引的key前缀，在索引中查找匹配的记录。
+ * 外表的一个batch一起查找：前缀覆盖了所有索引字段时调用索引的批量接口get_values()（B+树上先把key排序），
+ * 否则对每个key在B+树上用lower_bound()/upper_bound()确定范围，再用IxScan读出。
+ * 查找到的rid所在的内表数据页一起读入缓冲池，再逐条读出内表记录。
+ * 读出的内表记录先检查内表自己的条件，拼接之后再检查全部连接条件。输出记录的格式为外表字段在前，内表字段在后
+ */
+class IndexNestedLoopJoinExecutor : public BatchExecutor {
+   private:
+    // 索引key中一个字段的来源：外表记录中的字段（outer_offset >= 0），或者内表条件中的常量
+    struct KeyPart {
+        int outer_offset;
+        const char *val;
+    };
+
+    std::unique_ptr<AbstractExecutor> outer_;   // 左儿子节点：外表
+    std::string tab_name_;                      // 右儿子节点：内表的表名称
+    std::vector<Condition> inner_conds_;        // 内表上的条件
+    CompiledPredicate inner_pred_;              // 编译后的inner_conds_，对内表的记录求值
+    RmFileHandle *fh_;                          // 内表的数据文件句柄
+    IndexMeta index_meta_;                      // 内表上用来查找的索引
+    IxIndexHandle *ih_ = nullptr;               // 索引句柄
+    IxHashHandle *hh_ = nullptr;                // 哈希索引句柄，使用哈希索引时ih_为nullptr
+    std::vector<KeyPart> key_parts_;            // 索引字段的前缀上每个字段的来源
+    size_t outer_len_;                          // 外表记录的长度
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;          // join条件
+    CompiledPredicate pred_;                    // 编译后的join条件
+    SmManager *sm_manager_;
+
+    // 批量执行的状态
+    RecordBatch outer_batch_;                   // 外表当前的batch
+    std::vector<char> keys_;                    // outer_batch_中每条有效记录的key，连续存放
+    std::vector<std::vector<Rid>> rids_;        // outer_batch_中每条有效记录在内表上匹配的rid
+    size_t outer_pos_;                          // 外表当前记录在outer_batch_中的下标（选择向量中的下标）
+    size_t rid_pos_;                            // 下一个要读取的rid在rids_[outer_pos_]中的下标
+
+   public:
+    /**
+     * @param inner_conds 内表上的条件（字段与常量比较）
+     * @param index_col_names 内表上用来查找的索引的字段
+     * @param conds join条件，其中的等值条件把外表的字段与索引字段的前缀对应起来
+     */
+    IndexNestedLoopJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> outer, std::string tab_name,
+                                std::vector<Condition> inner_conds, const std::vector<std::string> &index_col_names,
+                                std::vector<Condition> conds, Context *context) {
+        sm_manager_ = sm_manager;
+        context_ = context;
+        outer_ = std::move(outer);
+        tab_name_ = std::move(tab_name);
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        index_meta_ = *tab.get_index_meta(index_col_names);
+        std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names);
+        if (index_meta_.type == INDEX_HASH) {
+            hh_ = sm_manager_->hhs_.at(ix_name).get();
+        } else {
+            ih_ = sm_manager_->ihs_.at(ix_name).get();
+        }
+        fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        inner_conds_ = std::move(inner_conds);
+        inner_pred_ = CompiledPredicate(inner_conds_, tab.cols);
+
+        outer_len_ = outer_->tupleLen();
+        len_ = outer_len_ + tab.cols.back().offset + tab.cols.back().len;
+        cols_ = outer_->cols();
+        for (auto col : tab.cols) {
+            col.offset += outer_len_;
+            cols_.push_back(col);
+        }
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_);
+
+        // 索引字段的最长前缀，每个字段与外表的某个类型和长度相同的字段有等值连接条件，或者在内表上有等值条件
+        auto &outer_cols = outer_->cols();
+        for (auto &index_col : index_meta_.cols) {
+            KeyPart part{-1, nullptr};
+            for (auto &cond : fed_conds_) {
+                if (cond.is_rhs_val || cond.op != OP_EQ) {
+                    continue;
+                }
+                TabCol inner_col = cond.lhs_col, outer_col = cond.rhs_col;
+                if (inner_col.tab_name != tab_name_) {
+                    std::swap(inner_col, outer_col);
+                }
+                auto pos = std::find_if(outer_cols.begin(), outer_cols.end(), [&](const ColMeta &col) {
+                    return col.tab_name == outer_col.tab_name && col.name == outer_col.col_name;
+                });
+                if (inner_col.tab_name == tab_name_ && inner_col.col_name == index_col.name && pos != outer_cols.end() &&
+                    pos->type == index_col.type && pos->len == index_col.len) {
+                    part.outer_offset = pos->offset;
+                    break;
+                }
+            }
+            if (part.outer_offset < 0) {
+                for (auto &cond : inner_conds_) {
+                    if (cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == index_col.name &&
+                        cond.rhs_val.type == index_col.type) {
+                        part.val = cond.rhs_val.raw->data;
+                        break;
+                    }
+                }
+            }
+            if (part.outer_offset < 0 && part.val == nullptr) {
+                break;
+            }
+            key_parts_.push_back(part);
+        }
+        if (key_parts_.empty() || (hh_ != nullptr && key_parts_.size() < index_meta_.cols.size())) {
+            throw InternalError("IndexNestedLoopJoinExecutor: index " + ix_name + " does not match the join conditions");
+        }
+    }
+
+    void beginTuple() override {
+        outer_->beginTuple();
+        outer_batch_.clear();
+        rids_.clear();
+        outer_pos_ = rid_pos_ = 0;
+        BatchExecutor::beginTuple();
+    }
+
+    size_t tupleLen() const override { return len_; };
+
+    std::string getType() override { return "IndexNestedLoopJoinExecutor"; };
+
+    const std::vector<ColMeta> &cols() const override { return cols_; };
+
+   private:
+    /**
+     * @description: 生成连接后的记录写入batch，直到batch写满或者连接结束
+     * @return batch中是否有记录
+     */
+    bool fill_batch(RecordBatch &batch) override {
+        // 1. 外表当前batch的记录都处理完时获取外表的下一个batch，并在索引中查找这个batch的所有key
+        // 2. 外表当前记录匹配的rid都处理完时换到下一条记录
+        // 3. 读出内表记录，检查内表条件，拼接后检查连接条件
+        batch.reset(len_);
+        while (!batch.is_full()) {
+            if (outer_pos_ >= outer_batch_.size()) {  // 1
+                if (!outer_->NextBatch(outer_batch_)) {
+                    break;
+                }
+                outer_pos_ = rid_pos_ = 0;
+                probe();
+                load_inner_pages();
+                continue;
+            }
+            if (rid_pos_ >= rids_[outer_pos_].size()) {  // 2
+                outer_pos_++;
+                rid_pos_ = 0;
+                continue;
+            }
+            auto inner = fh_->get_record(rids_[outer_pos_][rid_pos_++], context_);  // 3
+            if (!inner_pred_.eval(inner->data)) {
+                continue;
+            }
+            char *record = batch.append_row();
+            memcpy(record, outer_batch_.selected_row(outer_pos_), outer_len_);
+            memcpy(record + outer_len_, inner->data, len_ - outer_len_);
+            if (!pred_.eval(record)) {
+                batch.pop_row();
+            }
+        }
+        return batch.size() > 0;
+    }
+
+    // 为outer_batch_中的每条有效记录拼出key，在索引中查找匹配的rid，结果写入rids_
+    void probe() {
+        size_t num = outer_batch_.size();
+        size_t key_len = index_meta_.col_tot_len;
+        keys_.resize(num * key_len);
+        std::vector<const char *> keys(num);
+        for (size_t k = 0; k < num; k++) {
+            char *key = keys_.data() + k * key_len;
+            const char *outer = outer_batch_.selected_row(k);
+            int offset = 0;
+            for (size_t i = 0; i < key_parts_.size(); i++) {
+                const ColMeta &col = index_meta_.cols[i];
+                memcpy(key + offset, key_parts_[i].outer_offset >= 0 ? outer + key_parts_[i].outer_offset : key_parts_[i].val,
+                       col.len);
+                offset += col.len;
+            }
+            keys[k] = key;
+        }
+        if (hh_ != nullptr) {
+            hh_->get_values(keys, &rids_, context_->txn_);
+            return;
+        }
+        if (key_parts_.size() == index_meta_.cols.size()) {
+            ih_->get_values(keys, &rids_, context_->txn_);
+            return;
+        }
+        // 只有key前缀：前缀之后的字段在下界中取最小值、在上界中取最大值
+        rids_.assign(num, std::vector<Rid>());
+        std::vector<char> lower(key_len), upper(key_len);
+        for (size_t k = 0; k < num; k++) {
+            memcpy(lower.data(), keys[k], key_len);
+            memcpy(upper.data(), keys[k], key_len);
+            index_meta_.fill_key_bound(lower.data(), key_parts_.size(), false);
+            index_meta_.fill_key_bound(upper.data(), key_parts_.size(), true);
+            IxScan scan(ih_, ih_->lower_bound(lower.data()), ih_->upper_bound(upper.data()), sm_manager_->get_bpm());
+            for (; !scan.is_end(); scan.next()) {
+                rids_[k].push_back(scan.rid());
+            }
+        }
+    }
+
+    // 把rids_中的记录所在的内表数据页一起读入缓冲池，缺页的读入合并为批量I/O
+    void load_inner_pages() {
+        std::vector<Rid> rids;
+        for (auto &matched : rids_) {
+            rids.insert(rids.end(), matched.begin(), matched.end());
+        }
+        fh_->load_pages(rids);
+    }
+};
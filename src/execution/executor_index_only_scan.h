@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// IndexOnlyScanExecutor 在查询用到的字段都包含在索引中时使用，直接由索引中的key生成记录，不再读取表的数据文件
+#pragma once
+
+#include "executor_index_scan.h"
+
+class IndexOnlyScanExecutor : public IndexScanExecutor {
+   public:
+    IndexOnlyScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                          std::vector<std::string> index_col_names, Context *context)
+        : IndexScanExecutor(sm_manager, std::move(tab_name), std::move(conds), std::move(index_col_names), context) {
+        // 生成的记录就是原始格式的key：只包含索引字段，按索引中的顺序连续存放
+        cols_.clear();
+        int offset = 0;
+        for (auto &col : index_meta_.cols) {
+            ColMeta key_col = col;
+            key_col.offset = offset;
+            offset += col.len;
+            cols_.push_back(key_col);
+        }
+        len_ = offset;
+        pred_ = CompiledPredicate(conds_, cols_);
+        record_ = std::make_unique<RmRecord>(len_);
+    }
+
+    std::string getType() override { return "IndexOnlyScanExecutor"; };
+
+   protected:
+    void find_next() override {
+        for (; !scan_->is_end(); scan_->next()) {
+            // key和rid在同一次叶结点访问中读出；仍然对记录加读锁，与IndexScanExecutor的隔离性一致
+            rid_ = scan_->entry(record_->data);
+            fh_->lock_shared_on_record(rid_, context_);
+            if (pred_.eval(record_->data)) {
+                break;
+            }
+        }
+    }
+};
@@ -12,25 +12,37 @@ See the Mulan PSL v2 for more details. */
 
 #include "execution_defs.h"
 #include "execution_manager.h"
+#include "execution_predicate.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
 class IndexScanExecutor : public AbstractExecutor {
-   private:
+   protected:
     std::string tab_name_;                      // 表名称
-    TabMeta tab_;                               // 表的元数据
     std::vector<Condition> conds_;              // 扫描条件
     RmFileHandle *fh_;                          // 表的数据文件句柄
     std::vector<ColMeta> cols_;                 // 需要读取的字段
     size_t len_;                                // 选取出来的一条记录的长度
     std::vector<Condition> fed_conds_;          // 扫描条件，和conds_字段相同
+    CompiledPredicate pred_;                    // 编译后的conds_，对索引范围内的记录逐条检查
 
     std::vector<std::string> index_col_names_;  // index scan涉及到的索引包含的字段
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
+    IxIndexHandle *ih_ = nullptr;               // 索引句柄
+    IxHashHandle *hh_ = nullptr;                // 哈希索引句柄，使用哈希索引时ih_为nullptr
+    std::vector<Rid> hash_rids_;                // 哈希索引中key对应的所有rid
+    size_t hash_pos_ = 0;                       // 当前rid在hash_rids_中的位置
+
+    std::vector<char> lower_key_;               // 扫描范围的下界
+    std::vector<char> upper_key_;               // 扫描范围的上界
+    bool lower_strict_ = false;                 // 下界是否不包含在范围内（>）
+    bool upper_strict_ = false;                 // 上界是否不包含在范围内（<）
+    bool empty_range_ = false;                  // 条件互相矛盾，范围内没有记录
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
+    std::unique_ptr<RmRecord> record_;          // 当前满足条件的记录
 
     SmManager *sm_manager_;
 
@@ -40,13 +52,19 @@ class IndexScanExecutor : public AbstractExecutor {
         sm_manager_ = sm_manager;
         context_ = context;
         tab_name_ = std::move(tab_name);
-        tab_ = sm_manager_->db_.get_table(tab_name_);
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
         conds_ = std::move(conds);
         // index_no_ = index_no;
         index_col_names_ = index_col_names; 
-        index_meta_ = *(tab_.get_index_meta(index_col_names_));
+        index_meta_ = *(tab.get_index_meta(index_col_names_));
+        std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_col_names_);
+        if (index_meta_.type == INDEX_HASH) {
+            hh_ = sm_manager_->hhs_.at(ix_name).get();
+        } else {
+            ih_ = sm_manager_->ihs_.at(ix_name).get();
+        }
         fh_ = sm_manager_->fhs_.at(tab_name_).get();
-        cols_ = tab_.cols;
+        cols_ = tab.cols;
         len_ = cols_.back().offset + cols_.back().len;
         std::map<CompOp, CompOp> swap_op = {
             {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
@@ -62,19 +80,139 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         fed_conds_ = conds_;
+        pred_ = CompiledPredicate(conds_, cols_);
+        init_range();
     }
 
     void beginTuple() override {
-        
+        // 哈希索引只用于所有索引字段上都有等值条件的查询，lower_key_就是完整的key
+        if (hh_ != nullptr) {
+            hash_rids_.clear();
+            hash_pos_ = 0;
+            if (!empty_range_) {
+                hh_->get_value(lower_key_.data(), &hash_rids_, context_->txn_);
+            }
+            find_next();
+            return;
+        }
+        // 下界包含在范围内时从第一个>=下界的位置开始，否则从第一个>下界的位置开始；上界相反
+        Iid lower = lower_strict_ ? ih_->upper_bound(lower_key_.data()) : ih_->lower_bound(lower_key_.data());
+        Iid upper = upper_strict_ ? ih_->lower_bound(upper_key_.data()) : ih_->upper_bound(upper_key_.data());
+        if (empty_range_) {
+            lower = upper;
+        }
+        scan_ = std::make_unique<IxScan>(ih_, lower, upper, sm_manager_->get_bpm());
+        find_next();
     }
 
     void nextTuple() override {
-        
+        if (hh_ != nullptr) {
+            hash_pos_++;
+        } else {
+            scan_->next();
+        }
+        find_next();
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
-    }
+    bool is_end() const override { return hh_ != nullptr ? hash_pos_ == hash_rids_.size() : scan_->is_end(); }
+
+    std::unique_ptr<RmRecord> Next() override { return std::make_unique<RmRecord>(record_->size, record_->data); }
 
     Rid &rid() override { return rid_; }
-};
\ No newline at end of file
+
+    size_t tupleLen() const override { return len_; };
+
+    std::string getType() override { return "IndexScanExecutor"; };
+
+    const std::vector<ColMeta> &cols() const override { return cols_; };
+
+   protected:
+    /**
+     * @description: 根据条件计算索引上的扫描范围[lower_key_, upper_key_]。
+     * 索引字段的最长前缀上的等值条件确定key的前缀，紧接着的一个字段上的范围条件确定这个字段的上下界，
+     * 其余字段在下界中取最小值、在上界中取最大值（不包含边界时相反）。所有条件在扫描时仍然逐条检查
+     */
+    void init_range() {
+        lower_key_.assign(index_meta_.col_tot_len, 0);
+        upper_key_.assign(index_meta_.col_tot_len, 0);
+        int offset = 0;
+        size_t i = 0;
+        // 1. 等值条件构成的前缀
+        for (; i < index_meta_.cols.size(); i++) {
+            const ColMeta &col = index_meta_.cols[i];
+            auto eq = std::find_if(conds_.begin(), conds_.end(),
+                                   [&](const Condition &cond) { return is_range_cond(cond, col) && cond.op == OP_EQ; });
+            if (eq == conds_.end()) {
+                break;
+            }
+            memcpy(lower_key_.data() + offset, eq->rhs_val.raw->data, col.len);
+            memcpy(upper_key_.data() + offset, eq->rhs_val.raw->data, col.len);
+            offset += col.len;
+        }
+        if (i == index_meta_.cols.size()) {
+            return;
+        }
+        // 2. 下一个字段上的范围条件，有多个时取最紧的上下界
+        const ColMeta &col = index_meta_.cols[i];
+        bool has_lower = false, has_upper = false;
+        for (auto &cond : conds_) {
+            if (!is_range_cond(cond, col) || cond.op == OP_EQ) {
+                continue;
+            }
+            const char *val = cond.rhs_val.raw->data;
+            if (cond.op == OP_GT || cond.op == OP_GE) {
+                bool strict = cond.op == OP_GT;
+                int cmp = has_lower ? ix_compare(val, lower_key_.data() + offset, col.type, col.len) : 1;
+                if (cmp > 0 || (cmp == 0 && strict)) {
+                    memcpy(lower_key_.data() + offset, val, col.len);
+                    lower_strict_ = strict;
+                    has_lower = true;
+                }
+            } else {
+                bool strict = cond.op == OP_LT;
+                int cmp = has_upper ? ix_compare(val, upper_key_.data() + offset, col.type, col.len) : -1;
+                if (cmp < 0 || (cmp == 0 && strict)) {
+                    memcpy(upper_key_.data() + offset, val, col.len);
+                    upper_strict_ = strict;
+                    has_upper = true;
+                }
+            }
+        }
+        if (has_lower && has_upper) {
+            int cmp = ix_compare(lower_key_.data() + offset, upper_key_.data() + offset, col.type, col.len);
+            empty_range_ = cmp > 0 || (cmp == 0 && (lower_strict_ || upper_strict_));
+        }
+        // 3. 剩下的字段：包含边界时，下界取最小值、上界取最大值，这样与边界相等的key都在范围内；不包含边界时相反
+        size_t lower_from = has_lower ? i + 1 : i;
+        size_t upper_from = has_upper ? i + 1 : i;
+        index_meta_.fill_key_bound(lower_key_.data(), lower_from, lower_strict_);
+        index_meta_.fill_key_bound(upper_key_.data(), upper_from, !upper_strict_);
+    }
+
+    // 条件可以用来确定cond.lhs_col = col这个索引字段的范围
+    bool is_range_cond(const Condition &cond, const ColMeta &col) const {
+        return cond.is_rhs_val && cond.lhs_col.tab_name == tab_name_ && cond.lhs_col.col_name == col.name &&
+               cond.rhs_val.type == col.type && cond.op != OP_NE;
+    }
+
+    // 从扫描的当前位置开始，找到第一条满足所有条件的记录
+    virtual void find_next() {
+        if (hh_ != nullptr) {
+            for (; hash_pos_ < hash_rids_.size(); hash_pos_++) {
+                rid_ = hash_rids_[hash_pos_];
+                record_ = fh_->get_record(rid_, context_);
+                if (pred_.eval(record_->data)) {
+                    break;
+                }
+            }
+            return;
+        }
+        for (; !scan_->is_end(); scan_->next()) {
+            rid_ = scan_->rid();
+            record_ = fh_->get_record(rid_, context_);
+            if (pred_.eval(record_->data)) {
+                break;
+            }
+        }
+    }
+};
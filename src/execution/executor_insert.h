@@ -54,20 +54,40 @@ class InsertExecutor : public AbstractExecutor {
             val.init_raw(col.len);
             memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
+        // 唯一索引中已经存在相同的key时不能插入
+        for (auto &index : tab_.indexes) {
+            if (!index.unique) {
+                continue;
+            }
+            std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            std::vector<char> key(index.col_tot_len);
+            index.get_key(rec.data, key.data());
+            std::vector<Rid> rids;
+            bool found = index.type == INDEX_HASH
+                             ? sm_manager_->hhs_.at(ix_name)->get_value(key.data(), &rids, context_->txn_)
+                             : sm_manager_->ihs_.at(ix_name)->get_value(key.data(), &rids, context_->txn_);
+            if (found) {
+                throw UniqueConstraintError(tab_name_, index.get_col_names());
+            }
+        }
         // 将记录缓冲中的数据插入到表的数据文件中，并获取插入的位置 rid_
         rid_ = fh_->insert_record(rec.data, context_);
         
         // 遍历表的每个索引，获取索引句柄，并将插入的数据插入到相应的索引中
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+            std::string ix_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
             char* key = new char[index.col_tot_len];
             int offset = 0;
             for(size_t i = 0; i < index.col_num; ++i) {
                 memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
                 offset += index.cols[i].len;
             }
-            ih->insert_entry(key, rid_, context_->txn_);
+            if (index.type == INDEX_HASH) {
+                sm_manager_->hhs_.at(ix_name)->insert_entry(key, rid_, context_->txn_);
+            } else {
+                sm_manager_->ihs_.at(ix_name)->insert_entry(key, rid_, context_->txn_);
+            }
         }
         return nullptr;// 插入算子在执行过程中没有返回值，Next 函数返回一个空指针
     }
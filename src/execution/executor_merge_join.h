@@ -0,0 +1,188 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "execution_predicate.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * @description: 排序归并连接。连接条件中第一个左右字段类型和长度都相同的等值条件作为连接键，
+ * 要求左右儿子节点都按连接键从小到大（与ix_compare的顺序一致）输出记录，例如在以连接键开头的B+树索引上扫描。
+ * 两侧的游标交替前进：右表上连接键相同的一段记录（run）被复制到run_中，左表上连接键相同的每条记录依次与run_中的记录拼接，
+ * 因此两侧都有重复的连接键时也只需各扫描一遍；拼接后的记录再检查全部连接条件。
+ * 输出记录的格式与NestedLoopJoinExecutor相同，并且仍然按连接键有序
+ */
+class MergeJoinExecutor : public BatchExecutor {
+   private:
+    static constexpr int LEFT = 0;
+    static constexpr int RIGHT = 1;
+
+    // 儿子节点输出的记录上的游标
+    struct Cursor {
+        RecordBatch batch;
+        size_t pos;
+        bool end;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+    std::vector<Condition> fed_conds_;          // join条件
+    CompiledPredicate pred_;                    // 编译后的join条件
+    ColType key_type_;                          // 连接键的类型
+    int key_len_;                               // 连接键的长度
+    int key_offset_[2];                         // 连接键在左右两侧记录中的偏移
+
+    Cursor cursors_[2];
+    std::vector<char> run_;                     // 右表当前连接键相同的一段记录
+    size_t run_pos_;                            // 左表当前记录下一个要拼接的run_中的记录
+    bool in_run_;                               // 左表当前记录的连接键是否与run_相同
+
+   public:
+    MergeJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                      std::vector<Condition> conds) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        len_ = left_->tupleLen() + right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_->tupleLen();
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_);
+        cursors_[LEFT].end = cursors_[RIGHT].end = true;
+        in_run_ = false;
+
+        auto find = [](const std::vector<ColMeta> &cols, const TabCol &target) {
+            return std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+                return col.tab_name == target.tab_name && col.name == target.col_name;
+            });
+        };
+        auto &left_cols = left_->cols();
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                continue;
+            }
+            TabCol left_col = cond.lhs_col, right_col = cond.rhs_col;
+            if (find(left_cols, left_col) == left_cols.end()) {
+                std::swap(left_col, right_col);
+            }
+            auto lhs = find(left_cols, left_col);
+            auto rhs = find(right_cols, right_col);
+            if (lhs != left_cols.end() && rhs != right_cols.end() && lhs->type == rhs->type && lhs->len == rhs->len) {
+                key_type_ = lhs->type;
+                key_len_ = lhs->len;
+                key_offset_[LEFT] = lhs->offset;
+                key_offset_[RIGHT] = rhs->offset - static_cast<int>(left_->tupleLen());
+                return;
+            }
+        }
+        throw InternalError("MergeJoinExecutor: no equi-join condition");
+    }
+
+    void beginTuple() override {
+        for (int side : {LEFT, RIGHT}) {
+            child(side)->beginTuple();
+            cursors_[side].pos = 0;
+            cursors_[side].batch.clear();
+            cursors_[side].end = false;
+            fetch(side);
+        }
+        run_.clear();
+        in_run_ = false;
+        BatchExecutor::beginTuple();
+    }
+
+    size_t tupleLen() const override { return len_; };
+
+    std::string getType() override { return "MergeJoinExecutor"; };
+
+    const std::vector<ColMeta> &cols() const override { return cols_; };
+
+   private:
+    AbstractExecutor *child(int side) const { return side == LEFT ? left_.get() : right_.get(); }
+
+    // 当前batch用完时取下一个batch
+    void fetch(int side) {
+        Cursor &cursor = cursors_[side];
+        while (!cursor.end && cursor.pos >= cursor.batch.size()) {
+            cursor.end = !child(side)->NextBatch(cursor.batch);
+            cursor.pos = 0;
+        }
+    }
+
+    const char *current(int side) { return cursors_[side].batch.selected_row(cursors_[side].pos); }
+
+    void advance(int side) {
+        cursors_[side].pos++;
+        fetch(side);
+    }
+
+    int compare_key(const char *a, const char *b) const { return ix_compare(a, b, key_type_, key_len_); }
+
+    /**
+     * @description: 生成连接后的记录写入batch，直到batch写满或者连接结束
+     * @return batch中是否有记录
+     */
+    bool fill_batch(RecordBatch &batch) override {
+        // 1. 左表当前记录与run_中的记录逐条拼接；拼接完后左表前进，连接键改变时run_结束
+        // 2. 两侧连接键不同时，连接键较小的一侧前进
+        // 3. 两侧连接键相同时，把右表上连接键相同的记录全部复制到run_中
+        batch.reset(len_);
+        size_t left_len = left_->tupleLen();
+        size_t right_len = right_->tupleLen();
+        while (!batch.is_full()) {
+            if (in_run_) {  // 1
+                if (run_pos_ < run_.size()) {
+                    char *record = batch.append_row();
+                    memcpy(record, current(LEFT), left_len);
+                    memcpy(record + left_len, run_.data() + run_pos_, right_len);
+                    run_pos_ += right_len;
+                    if (!pred_.eval(record)) {
+                        batch.pop_row();
+                    }
+                    continue;
+                }
+                advance(LEFT);
+                run_pos_ = 0;
+                in_run_ = !cursors_[LEFT].end &&
+                          compare_key(current(LEFT) + key_offset_[LEFT], run_.data() + key_offset_[RIGHT]) == 0;
+                continue;
+            }
+            if (cursors_[LEFT].end || cursors_[RIGHT].end) {
+                break;
+            }
+            int cmp = compare_key(current(LEFT) + key_offset_[LEFT], current(RIGHT) + key_offset_[RIGHT]);
+            if (cmp < 0) {  // 2
+                advance(LEFT);
+            } else if (cmp > 0) {
+                advance(RIGHT);
+            } else {  // 3
+                run_.assign(current(RIGHT), current(RIGHT) + right_len);
+                for (advance(RIGHT); !cursors_[RIGHT].end; advance(RIGHT)) {
+                    if (compare_key(current(RIGHT) + key_offset_[RIGHT], run_.data() + key_offset_[RIGHT]) != 0) {
+                        break;
+                    }
+                    run_.insert(run_.end(), current(RIGHT), current(RIGHT) + right_len);
+                }
+                run_pos_ = 0;
+                in_run_ = true;
+            }
+        }
+        return batch.size() > 0;
+    }
+};
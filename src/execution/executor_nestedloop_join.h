@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 #include "execution_defs.h"
 #include "execution_manager.h"
+#include "execution_predicate.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
@@ -23,12 +24,22 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // join后获得的记录的字段
 
     std::vector<Condition> fed_conds_;          // join条件
+    CompiledPredicate pred_;                    // 编译后的join条件
     bool isend;                                 // 记录是否到达连接的末尾
 
+    // 批量执行的状态：block nested loop，右表为外层，左表为内层
+    size_t block_budget_;                       // 一个block中右表记录占用的内存上限
+    std::vector<char> block_;                   // 当前block：连续存放的右表记录
+    size_t block_rows_;                         // 当前block中的记录数
+    size_t block_pos_;                          // 当前右表记录在block_中的下标
+    RecordBatch left_batch_;                    // 左表当前的batch
+    size_t left_pos_;                           // 左表当前记录在left_batch_中的下标（选择向量中的下标）
+    bool right_end_;                            // 右表是否已经全部读入过block
+
    public:
    // 构造函数接受左右两个源执行器和连接条件
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, 
-                            std::vector<Condition> conds) {
+                            std::vector<Condition> conds, size_t block_budget = EXEC_MEMORY_BUDGET) {
         left_ = std::move(left);
         right_ = std::move(right);
         len_ = left_->tupleLen() + right_->tupleLen();// 计算连接后每条记录的长度 len_
@@ -42,12 +53,19 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
+        pred_ = CompiledPredicate(fed_conds_, cols_);
+        block_budget_ = block_budget;
     }
 
     // 调用左右两个执行器的 beginTuple 函数开始新的记录的处理
     void beginTuple() override {
         left_->beginTuple();
         right_->beginTuple();
+        block_.clear();
+        block_rows_ = block_pos_ = 0;
+        left_batch_.reset(left_->tupleLen());
+        left_pos_ = 0;
+        right_end_ = false;
     }
     // 通过嵌套循环遍历左右两个执行器的所有记录，检查连接条件
     void nextTuple() override {
@@ -58,7 +76,7 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
                 left_->nextTuple();
 
             for (; !left_->is_end(); left_->nextTuple()) {
-                if (condCheck(get_rec().get())) return;
+                if (condCheck(get_rec()->data)) return;
             }
         }
     }
@@ -67,6 +85,64 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         return get_rec();
     }
 
+    /**
+     * @description: 批量获取连接后的记录（block nested loop）。把右表的记录按内存预算分成若干block，
+     * 每个block连续存放在block_中，左表对每个block只扫描一遍；左表的每个batch与block中的每条记录逐条拼接，
+     * 拼接后的记录直接写入输出batch，不满足连接条件时撤销。输出batch满时保留循环位置，下次从该位置继续
+     */
+    bool NextBatch(RecordBatch &batch) override {
+        // 1. 左表当前batch与整个block拼接完后获取左表的下一个batch
+        // 2. 左表扫描完时读入右表的下一个block，并重新扫描左表；右表没有更多记录则连接结束
+        // 3. 拼接左表当前记录与block中的当前记录，并检查连接条件
+        batch.reset(len_);
+        size_t left_len = left_->tupleLen();
+        size_t right_len = len_ - left_len;
+        while (!batch.is_full()) {
+            if (block_pos_ >= block_rows_) { // 1
+                if (block_rows_ > 0 && left_->NextBatch(left_batch_)) {
+                    block_pos_ = left_pos_ = 0;
+                    continue;
+                }
+                if (!next_block()) { // 2
+                    break;
+                }
+                left_->beginTuple();
+                continue;
+            }
+            char *record = batch.append_row(); // 3
+            memcpy(record, left_batch_.selected_row(left_pos_), left_len);
+            memcpy(record + left_len, block_.data() + block_pos_ * right_len, right_len);
+            if (!condCheck(record)) {
+                batch.pop_row();
+            }
+            if (++left_pos_ >= left_batch_.size()) {
+                left_pos_ = 0;
+                block_pos_++;
+            }
+        }
+        return batch.size() > 0;
+    }
+
+    // 从右表读入下一个block，直到block中的记录超过内存预算或者右表结束；没有读到记录时返回false
+    bool next_block() {
+        block_.clear();
+        block_rows_ = block_pos_ = 0;
+        RecordBatch right_batch;
+        while (!right_end_ && block_.size() < block_budget_) {
+            if (!right_->NextBatch(right_batch)) {
+                right_end_ = true;
+                break;
+            }
+            for (size_t k = 0; k < right_batch.size(); k++) {
+                block_.insert(block_.end(), right_batch.selected_row(k), right_batch.selected_row(k) + right_batch.tuple_len());
+            }
+            block_rows_ += right_batch.size();
+        }
+        // 把block_pos_置于末尾，由NextBatch()获取左表的第一个batch
+        block_pos_ = block_rows_;
+        return block_rows_ > 0;
+    }
+
     Rid &rid() override { return _abstract_rid; }
     bool is_end() const override { return left_->is_end(); }
 
@@ -83,59 +159,8 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
         return record;
     }
-    // 用于检查连接条件是否满足
-    bool condCheck(const RmRecord *l_record) {
-        char *l_val_buf, *r_val_buf;
-        const RmRecord *r_record;
-
-        for (auto &condition : fed_conds_) {  // 遍历连接条件，逐一判断左表的字段和右表的字段是否满足条件
-            CompOp op = condition.op;
-            int cmp;
-
-            // record和col确定数据位置
-            auto l_col = get_col(cols_, condition.lhs_col);  // 左列元数据
-            l_val_buf = l_record->data + l_col->offset;      // 确定左数据起点
-
-            if (condition.is_rhs_val) {  // 值
-                r_record = condition.rhs_val.raw.get();
-                r_val_buf = r_record->data;
-                //cond_compare函数用于比较两个字段的值
-                cmp = cond_compare(l_val_buf, r_val_buf, condition.rhs_val.type, l_col->len);
-            } else {  // 列
-                auto r_col = get_col(cols_, condition.rhs_col);
-                r_val_buf = l_record->data + r_col->offset;
-
-                cmp = cond_compare(l_val_buf, r_val_buf, r_col->type, l_col->len);
-            }
-            
-            if (!op_compare(op, cmp))  // 不满足条件
-                return false;
-        }
-        return true;
-    }
-    // cond_compare函数用于比较两个字段的值
-    int cond_compare(const char *l_val_buf, const char *r_val_buf, ColType type, int col_len) const {
-        int cmp = ix_compare(l_val_buf, r_val_buf, type, col_len);
-        return cmp;
-    }
-    // op_compare 函数用于比较两个值满足条件的情况
-    bool op_compare(CompOp op, int cmp) const {
-        if (op == OP_EQ) {
-            return cmp == 0;
-        } else if (op == OP_NE) {
-            return cmp != 0;
-        } else if (op == OP_LT) {
-            return cmp < 0;
-        } else if (op == OP_GT) {
-            return cmp > 0;
-        } else if (op == OP_LE) {
-            return cmp <= 0;
-        } else if (op == OP_GE) {
-            return cmp >= 0;
-        } else {
-            throw InternalError("Invalid CompOp");
-        }
-    }
+    // 用于检查连接条件是否满足，条件在构造时已编译
+    bool condCheck(const char *l_data) const { return pred_.eval(l_data); }
     // 返回连接后每条记录的长度 len_
     size_t tupleLen() const override { return len_; };
     // 返回执行器的类型名称
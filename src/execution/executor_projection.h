@@ -24,6 +24,8 @@ class ProjectionExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度，即投影后每条记录的长度
     std::vector<size_t> sel_idxs_;                  // 记录在源执行器中需要被投影的字段的索引
+    std::vector<size_t> prev_offsets_;              // 被投影的字段在源执行器记录中的偏移
+    RecordBatch prev_batch_;                        // 批量执行时源执行器输出的batch
 
    public:
    // 构造函数接受一个源执行器和一个包含被投影字段信息的向量
@@ -36,6 +38,7 @@ class ProjectionExecutor : public AbstractExecutor {
         for (auto &sel_col : sel_cols) {
             auto pos = get_col(prev_cols, sel_col);
             sel_idxs_.push_back(pos - prev_cols.begin());
+            prev_offsets_.push_back(pos->offset);
             auto col = *pos;
             col.offset = curr_offset;
             curr_offset += col.len;
@@ -62,6 +65,22 @@ class ProjectionExecutor : public AbstractExecutor {
 
         return rt_record;
     }
+    // 批量获取投影后的记录：对源执行器batch中每条有效记录，按预先计算好的偏移复制被投影的字段
+    bool NextBatch(RecordBatch &batch) override {
+        batch.reset(len_);
+        if (!prev_->NextBatch(prev_batch_)) {
+            return false;
+        }
+        for (size_t k = 0; k < prev_batch_.size(); k++) {
+            const char *prev_record = prev_batch_.selected_row(k);
+            char *record = batch.append_row(prev_batch_.rid(prev_batch_.sel()[k]));
+            for (size_t i = 0; i < cols_.size(); i++) {
+                memcpy(record + cols_[i].offset, prev_record + prev_offsets_[i], cols_[i].len);
+            }
+        }
+        return true;
+    }
+
     //返回 _abstract_rid，表示当前记录的位置标识
     Rid &rid() override { return _abstract_rid; }
     // 调用源执行器的 is_end 函数判断是否到达末尾
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "execution_defs.h"
 #include "execution_manager.h"
+#include "execution_predicate.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
@@ -25,9 +26,10 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    CompiledPredicate pred_;            // 编译后的conds_
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;  // table_iterator
+    std::unique_ptr<RmScan> scan_;   // table_iterator，按页扫描，当前页面保持固定
 
     SmManager *sm_manager_;
 
@@ -42,6 +44,7 @@ class SeqScanExecutor : public AbstractExecutor {
         len_ = cols_.back().offset + cols_.back().len;
         context_ = context;
         fed_conds_ = conds_;
+        pred_ = CompiledPredicate(conds_, cols_);
     }
 
     void beginTuple() override {// 用于初始化迭代器并开始扫描
@@ -50,7 +53,9 @@ class SeqScanExecutor : public AbstractExecutor {
 
         while (!scan_->is_end()) {
             // 使用 condCheck 函数检查满足条件的记录，并将扫描位置移动到满足条件的下一个记录
-            if (condCheck(fh_->get_record(rid_, context_).get())) break;
+            // 记录直接在固定的页面中检查，不再重新获取页面、复制记录
+            fh_->lock_shared_on_record(rid_, context_);
+            if (condCheck(scan_->record())) break;
             scan_->next();
             rid_ = scan_->rid();
         }
@@ -60,68 +65,37 @@ class SeqScanExecutor : public AbstractExecutor {
         // 将扫描位置移动到下一个记录，并使用 condCheck 函数检查是否满足条件
         for (scan_->next(); !scan_->is_end(); scan_->next()) {
             rid_ = scan_->rid();
-            if (condCheck(fh_->get_record(rid_, context_).get())) break;
+            fh_->lock_shared_on_record(rid_, context_);
+            if (condCheck(scan_->record())) break;
         }
     }
 
-    bool condCheck(const RmRecord *l_record) {// 用于检查给定的记录是否满足查询条件
-        char *l_val_buf, *r_val_buf;
-        const RmRecord *r_record;
-
-        for (auto &condition : conds_) {  // 遍历扫描条件 conds_，对每个条件进行比较
-            CompOp op = condition.op;
-            int cmp;
-
-            // record和col确定数据位置
-            auto l_col = get_col(cols_, condition.lhs_col);  // 左列元数据
-            l_val_buf = l_record->data + l_col->offset;      // 确定左数据起点
-            //根据条件的左值、右值（值或者列）以及比较操作符，使用 cond_compare 函数比较
-            if (condition.is_rhs_val) {  // 值
-                r_record = condition.rhs_val.raw.get();
-                r_val_buf = r_record->data;
-
-                cmp = cond_compare(l_val_buf, r_val_buf, condition.rhs_val.type, l_col->len);
-            } else {  // 列
-                auto r_col = get_col(cols_, condition.rhs_col);
-                r_val_buf = l_record->data + r_col->offset;
-
-                cmp = cond_compare(l_val_buf, r_val_buf, r_col->type, l_col->len);
+    /**
+     * @description: 批量获取满足条件的记录：记录直接从固定的页面复制到batch中，
+     * 再对整批记录求值扫描条件，不满足条件的行从选择向量中去掉
+     */
+    bool NextBatch(RecordBatch &batch) override {
+        batch.reset(len_);
+        while (batch.size() == 0 && !scan_->is_end()) {
+            batch.clear();
+            for (; !scan_->is_end() && !batch.is_full(); scan_->next()) {
+                rid_ = scan_->rid();
+                fh_->lock_shared_on_record(rid_, context_);
+                memcpy(batch.append_row(rid_), scan_->record(), len_);
             }
-            if (!op_compare(op, cmp))  // 不满足条件
-                return false;
+            pred_.filter(batch);
         }
-        return true;
+        return batch.size() > 0;
     }
 
-    // 用于比较两个值或列，返回比较的结果
-    int cond_compare(const char *l_val_buf, const char *r_val_buf, ColType type, int col_len) const {
-        int cmp = ix_compare(l_val_buf, r_val_buf, type, col_len);
-        return cmp;
-    }
-    // 用于根据比较操作符判断比较结果是否满足条件
-    bool op_compare(CompOp op, int cmp) const {
-        if (op == OP_EQ) {
-            return cmp == 0;
-        } else if (op == OP_NE) {
-            return cmp != 0;
-        } else if (op == OP_LT) {
-            return cmp < 0;
-        } else if (op == OP_GT) {
-            return cmp > 0;
-        } else if (op == OP_LE) {
-            return cmp <= 0;
-        } else if (op == OP_GE) {
-            return cmp >= 0;
-        } else {
-            throw InternalError("Invalid CompOp");
-        }
-    }
+    // 用于检查给定的记录数据是否满足条件，条件在构造时已编译
+    bool condCheck(const char *l_data) const { return pred_.eval(l_data); }
     // 判断是否到达扫描结束位置
     bool is_end() const override { return scan_->is_end(); }
 
     // 返回当前扫描位置的记录
     std::unique_ptr<RmRecord> Next() override {
-        return fh_->get_record(rid_, context_);
+        return std::make_unique<RmRecord>(fh_->get_file_hdr().record_size, scan_->record());
     }
     // 返回当前记录的位置标识 Rid
     Rid &rid() override { return rid_; }
@@ -48,46 +48,113 @@ class UpdateExecutor : public AbstractExecutor {
     }
     // 用于更新操作
     std::unique_ptr<RmRecord> Next() override {
-        // Update each rid of record file and index file
+        // 1. 读取要更新的记录，对于每个记录，根据赋值语句列表 set_clauses_ 生成更新后的记录
+        std::vector<std::unique_ptr<RmRecord>> old_recs, new_recs;
         for (auto &rid : rids_) {// 遍历要更新的记录位置 rids
-            auto rec = fh_->get_record(rid, context_);
-            for (auto &set_clause : set_clauses_) {// 对于每个记录位置，获取记录，并根据赋值语句列表 set_clauses_ 更新对应的字段值
+            old_recs.push_back(fh_->get_record(rid, context_));
+            new_recs.push_back(std::make_unique<RmRecord>(*old_recs.back()));
+            for (auto &set_clause : set_clauses_) {
                 auto lhs_col = tab_.get_col(set_clause.lhs.col_name);
-                memcpy(rec->data + lhs_col->offset, set_clause.rhs.raw->data, lhs_col->len);
+                memcpy(new_recs.back()->data + lhs_col->offset, set_clause.rhs.raw->data, lhs_col->len);
             }
-            // 对于每个更新的记录，首先从索引中删除旧的记录，然后在数据文件中更新记录，最后将新的记录插入到索引中
-            // Remove old entry from index
-            for (size_t i = 0; i < tab_.indexes.size(); ++i) {
-                auto &index = tab_.indexes[i];
-                auto ih =
-                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-                char *key = new char[index.col_tot_len];
-                int offset = 0;
-                for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(key + offset, rec->data + index.cols[j].offset, index.cols[j].len);
-                    offset += index.cols[j].len;
-                }
-                ih->delete_entry(key, context_->txn_);
+        }
+        // 2. 只有包含被更新字段的索引需要维护，唯一索引先检查更新后的key
+        std::vector<const IndexMeta *> indexes;
+        for (auto &index : tab_.indexes) {
+            bool updated = std::any_of(index.cols.begin(), index.cols.end(), [&](const ColMeta &col) {
+                return std::any_of(set_clauses_.begin(), set_clauses_.end(),
+                                   [&](const SetClause &set_clause) { return set_clause.lhs.col_name == col.name; });
+            });
+            if (updated) {
+                indexes.push_back(&index);
             }
-            // Update record in record file
-            fh_->update_record(rid, rec->data, context_);
-            // Insert new index into index
-            for (size_t i = 0; i < tab_.indexes.size(); ++i) {
-                auto &index = tab_.indexes[i];
-                auto ih =
-                    sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-                char *key = new char[index.col_tot_len];
-                int offset = 0;
-                for (size_t j = 0; j < index.col_num; ++j) {
-                    memcpy(key + offset, rec->data + index.cols[j].offset, index.cols[j].len);
-                    offset += index.cols[j].len;
-                }
-                ih->insert_entry(key, rid, context_->txn_);
+        }
+        for (auto index : indexes) {
+            if (index->unique) {
+                check_unique(*index, new_recs);
+            }
+        }
+        // 3. 先在数据文件中更新记录（同时加上记录的X锁），再维护索引，避免加锁失败时记录没有更新而索引已经改变
+        for (size_t i = 0; i < rids_.size(); i++) {
+            fh_->update_record(rids_[i], new_recs[i]->data, context_);
+        }
+        // 4. 批量删除旧的key
+        for (auto index : indexes) {
+            std::vector<char> keys;
+            auto key_ptrs = make_keys(*index, old_recs, &keys);
+            if (index->type == INDEX_HASH) {
+                get_hh(*index)->delete_entries(key_ptrs, rids_, context_->txn_);
+            } else {
+                get_ih(*index)->delete_entries(key_ptrs, rids_, context_->txn_);
+            }
+        }
+        // 5. 最后批量插入新的key
+        for (auto index : indexes) {
+            std::vector<char> keys;
+            auto key_ptrs = make_keys(*index, new_recs, &keys);
+            if (index->type == INDEX_HASH) {
+                get_hh(*index)->insert_entries(key_ptrs, rids_, context_->txn_);
+            } else {
+                get_ih(*index)->insert_entries(key_ptrs, rids_, context_->txn_);
             }
         }
         return nullptr;
     }
 
+    IxIndexHandle *get_ih(const IndexMeta &index) {
+        return sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+    }
+
+    IxHashHandle *get_hh(const IndexMeta &index) {
+        return sm_manager_->hhs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
+    }
+
+    // 唯一索引：更新后的key两两不同，且索引中已有的相同key只能属于本次被更新的记录（它们的旧key会被删除）
+    void check_unique(const IndexMeta &index, const std::vector<std::unique_ptr<RmRecord>> &new_recs) {
+        std::vector<char> keys;
+        auto key_ptrs = make_keys(index, new_recs, &keys);
+        std::vector<const char *> sorted_keys = key_ptrs;
+        std::sort(sorted_keys.begin(), sorted_keys.end(), [&](const char *a, const char *b) {
+            return memcmp(a, b, index.col_tot_len) < 0;
+        });
+        for (size_t i = 1; i < sorted_keys.size(); i++) {
+            if (memcmp(sorted_keys[i - 1], sorted_keys[i], index.col_tot_len) == 0) {
+                throw UniqueConstraintError(tab_name_, index.get_col_names());
+            }
+        }
+        auto rid_less = [](const Rid &a, const Rid &b) {
+            return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+        };
+        std::vector<Rid> updated_rids = rids_;
+        std::sort(updated_rids.begin(), updated_rids.end(), rid_less);
+        for (auto key : key_ptrs) {
+            std::vector<Rid> rids;
+            if (index.type == INDEX_HASH) {
+                get_hh(index)->get_value(key, &rids, context_->txn_);
+            } else {
+                get_ih(index)->get_value(key, &rids, context_->txn_);
+            }
+            for (auto &rid : rids) {
+                if (!std::binary_search(updated_rids.begin(), updated_rids.end(), rid, rid_less)) {
+                    throw UniqueConstraintError(tab_name_, index.get_col_names());
+                }
+            }
+        }
+    }
+
+    // 生成每条记录在索引中的key，存放在keys中，返回指向每个key的指针
+    std::vector<const char *> make_keys(const IndexMeta &index, const std::vector<std::unique_ptr<RmRecord>> &recs,
+                                        std::vector<char> *keys) {
+        keys->resize(recs.size() * index.col_tot_len);
+        std::vector<const char *> key_ptrs;
+        for (size_t i = 0; i < recs.size(); i++) {
+            char *key = keys->data() + i * index.col_tot_len;
+            index.get_key(recs[i]->data, key);
+            key_ptrs.push_back(key);
+        }
+        return key_ptrs;
+    }
+
     Rid &rid() override { return _abstract_rid; }// 表示当前记录的位置标识
 
     // 返回记录的长度，对于更新操作，可以直接返回 0
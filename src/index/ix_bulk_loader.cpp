@@ -0,0 +1,368 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bulk_loader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+
+IxBulkLoader::IxBulkLoader(IxIndexHandle *ih, double fill_factor, size_t memory_limit)
+    : ih_(ih),
+      file_hdr_(ih->file_hdr_),
+      entry_len_(ih->file_hdr_->col_tot_len_ + static_cast<int>(sizeof(Rid))),
+      fill_factor_(fill_factor),
+      memory_limit_(std::max(memory_limit, static_cast<size_t>(entry_len_))) {}
+
+IxBulkLoader::~IxBulkLoader() {
+    for (auto &run_file : run_files_) {
+        std::remove(run_file.c_str());
+    }
+}
+
+/**
+ * @description: 添加一个键值对，内存中的键值对超出内存上限时先排序并写入临时文件
+ */
+void IxBulkLoader::add(const char *key, const Rid &rid) {
+    if (buffer_.size() + entry_len_ > memory_limit_) {
+        spill_run();
+    }
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + entry_len_);
+    // 按索引中存储的格式（非唯一索引的key附加了rid）排序和写入结点
+    ih_->to_index_key(key, rid, buffer_.data() + offset);
+    memcpy(buffer_.data() + offset + file_hdr_->col_tot_len_, &rid, sizeof(Rid));
+}
+
+/**
+ * @description: 排序所有键值对，并自底向上构建B+树
+ * @return {size_t} 写入索引的键值对数量（不含重复的key）
+ */
+size_t IxBulkLoader::finish() {
+    // 1. 只能对空索引进行批量构建：根结点是初始的空叶结点
+    IxNodeHandle *root = ih_->fetch_node(file_hdr_->root_page_);
+    bool empty = file_hdr_->root_page_ == IX_INIT_ROOT_PAGE && root->is_leaf_page() && root->get_size() == 0;
+    ih_->buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    if (!empty) {
+        throw InternalError("IxBulkLoader::finish: index is not empty");
+    }
+
+    // 2. 按顺序把键值对追加到叶结点层：数据都在内存中时直接排序，否则归并所有run
+    if (run_files_.empty()) {
+        for (const char *entry : sort_buffer()) {
+            append(entry);
+        }
+        buffer_.clear();
+    } else {
+        spill_run();
+        merge_runs();
+    }
+    if (levels_.empty()) {
+        return 0;
+    }
+
+    // 3. 自底向上把每一层暂存的键值对写成结点，最上层只有一个结点时即为根结点
+    for (size_t level = 0; level < levels_.size(); level++) {
+        finish_level(level);
+    }
+
+    // 4. 最后一个叶结点指向leaf header，leaf header的prev_leaf指向最后一个叶结点
+    page_id_t last_leaf = levels_[0].prev;
+    IxNodeHandle *last = ih_->fetch_node(last_leaf);
+    last->set_next_leaf(IX_LEAF_HEADER_PAGE);
+    ih_->buffer_pool_manager_->unpin_page(last->get_page_id(), true);
+    delete last;
+    IxNodeHandle *leaf_header = ih_->fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header->set_prev_leaf(last_leaf);
+    ih_->buffer_pool_manager_->unpin_page(leaf_header->get_page_id(), true);
+    delete leaf_header;
+    ih_->file_hdr_->last_leaf_ = last_leaf;
+    levels_.clear();
+    return num_entries_;
+}
+
+/**
+ * @description: 比较两个键值对，非唯一索引的key中已经包含rid，相同的索引字段按rid排列
+ */
+int IxBulkLoader::compare_entry(const char *a, const char *b) const { return ix_compare(a, b, file_hdr_); }
+
+/**
+ * @description: 对内存中的键值对排序
+ * @return {vector<const char*>} 按顺序排列的键值对在buffer_中的地址
+ */
+std::vector<const char *> IxBulkLoader::sort_buffer() const {
+    std::vector<const char *> entries;
+    entries.reserve(buffer_.size() / entry_len_);
+    for (size_t offset = 0; offset < buffer_.size(); offset += entry_len_) {
+        entries.push_back(buffer_.data() + offset);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [this](const char *a, const char *b) { return compare_entry(a, b) < 0; });
+    return entries;
+}
+
+/**
+ * @description: 把内存中的键值对排序后写入一个新的临时文件，作为一个run
+ */
+void IxBulkLoader::spill_run() {
+    std::string run_file = ih_->disk_manager_->get_file_name(ih_->fd_) + ".run" + std::to_string(run_files_.size());
+    FILE *file = fopen(run_file.c_str(), "wb");
+    if (file == nullptr) {
+        throw UnixError();
+    }
+    run_files_.push_back(run_file);
+    for (const char *entry : sort_buffer()) {
+        if (fwrite(entry, entry_len_, 1, file) != 1) {
+            fclose(file);
+            throw UnixError();
+        }
+    }
+    fclose(file);
+    buffer_.clear();
+}
+
+/**
+ * @description: 多路归并所有run，按顺序把键值对写入叶结点
+ */
+void IxBulkLoader::merge_runs() {
+    struct Run {
+        FILE *file;
+        std::vector<char> entry;
+    };
+    std::vector<Run> runs;
+    auto close_runs = [&runs]() {
+        for (auto &run : runs) {
+            fclose(run.file);
+        }
+    };
+    // 小根堆，堆顶为当前最小的键值对所在的run
+    auto greater = [this, &runs](size_t a, size_t b) {
+        return compare_entry(runs[a].entry.data(), runs[b].entry.data()) > 0;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+
+    for (auto &run_file : run_files_) {
+        FILE *file = fopen(run_file.c_str(), "rb");
+        if (file == nullptr) {
+            close_runs();
+            throw UnixError();
+        }
+        runs.push_back({file, std::vector<char>(entry_len_)});
+    }
+    for (size_t i = 0; i < runs.size(); i++) {
+        if (fread(runs[i].entry.data(), entry_len_, 1, runs[i].file) == 1) {
+            heap.push(i);
+        }
+    }
+    while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        append(runs[i].entry.data());
+        if (fread(runs[i].entry.data(), entry_len_, 1, runs[i].file) == 1) {
+            heap.push(i);
+        }
+    }
+    close_runs();
+}
+
+/**
+ * @description: 按顺序追加一个键值对到叶结点层
+ */
+void IxBulkLoader::append(const char *entry) {
+    // 与insert_entry()一致，重复的key（非唯一索引中是重复的(key, rid)）只保留一条
+    if (!last_key_.empty() && ix_compare(entry, last_key_.data(), file_hdr_) == 0) {
+        return;
+    }
+    last_key_.assign(entry, entry + file_hdr_->col_tot_len_);
+
+    Rid rid;
+    memcpy(&rid, entry + file_hdr_->col_tot_len_, sizeof(Rid));
+    push_pair(0, entry, rid);
+    num_entries_++;
+}
+
+/**
+ * @description: 把键值对追加到第level层的暂存区，需要时创建新的一层
+ * 暂存区的第j个key作为下一个结点的第一个key时，前j个键值对超出了结点的容量，就把前j - 1个键值对写成一个结点：
+ * 上一次追加时没有写出结点，说明前j - 1个键值对放得下
+ */
+void IxBulkLoader::push_pair(size_t level, const char *key, const Rid &rid) {
+    if (level == levels_.size()) {
+        levels_.emplace_back();
+    }
+    Level &staged = levels_[level];
+    staged.keys.insert(staged.keys.end(), key, key + file_hdr_->col_tot_len_);
+    staged.rids.push_back(rid);
+    int j = static_cast<int>(staged.rids.size()) - 1;
+    if (j > capacity(prefix_len(level, j))) {
+        write_node(level, j - 1, prefix_len(level, j - 1), false);
+    }
+}
+
+/**
+ * @description: 把第level层暂存区的前n个键值对写成一个结点时，结点的公共前缀长度
+ * 结点的key都在它的第一个key与下一个结点的第一个key之间；每层的第一个结点没有下界，不使用公共前缀
+ */
+int IxBulkLoader::prefix_len(size_t level, int n) const {
+    const Level &staged = levels_[level];
+    if (!file_hdr_->normalized_ || staged.prev == IX_NO_PAGE) {
+        return 0;
+    }
+    int len = file_hdr_->col_tot_len_;
+    return ix_common_prefix(staged.keys.data(), staged.keys.data() + n * len, len);
+}
+
+/**
+ * @description: 公共前缀长度为prefix_len的结点写入的键值对数量：按填充因子计算，但不能少于最小大小，也不能触发分裂
+ */
+int IxBulkLoader::capacity(int prefix_len) const {
+    int max_pairs = IxNodeHandle::max_size_of(file_hdr_, prefix_len) - 1;
+    int min_pairs = (file_hdr_->btree_order_ + 1) / 2;
+    int cap = static_cast<int>(max_pairs * fill_factor_);
+    return std::min(std::max(cap, min_pairs), max_pairs);
+}
+
+/**
+ * @description: 把第level层暂存区的前n个键值对写成一个结点，不是根结点时把它的第一个key追加到上一层
+ */
+void IxBulkLoader::write_node(size_t level, int n, int prefix_len, bool is_root) {
+    IxNodeHandle *node;
+    page_id_t prev = levels_[level].prev;
+    if (level == 0 && prev == IX_NO_PAGE) {
+        // 第一个叶结点沿用初始的根结点，即file_hdr_->first_leaf_
+        node = ih_->fetch_node(IX_INIT_ROOT_PAGE);
+    } else {
+        node = ih_->create_node();
+        node->page_hdr->next_free_page_no = IX_NO_PAGE;
+        node->page_hdr->num_key = 0;
+        node->page_hdr->is_leaf = level == 0;
+        node->page_hdr->prefix_len = 0;
+        node->page_hdr->prev_leaf = IX_NO_PAGE;
+        node->page_hdr->next_leaf = IX_NO_PAGE;
+    }
+    node->page_hdr->parent = IX_NO_PAGE;
+
+    Level &staged = levels_[level];
+    int len = file_hdr_->col_tot_len_;
+    if (prefix_len > 0) {
+        node->set_prefix(staged.keys.data(), prefix_len);
+    }
+    node->insert_pairs(0, staged.keys.data(), staged.rids.data(), n);
+    for (int i = 0; i < n; i++) {
+        ih_->maintain_child(node, i);
+    }
+    if (level == 0 && prev != IX_NO_PAGE) {
+        IxNodeHandle *prev_leaf = ih_->fetch_node(prev);
+        prev_leaf->set_next_leaf(node->get_page_no());
+        node->set_prev_leaf(prev);
+        ih_->buffer_pool_manager_->unpin_page(prev_leaf->get_page_id(), true);
+        delete prev_leaf;
+    }
+    std::vector<char> first_key(staged.keys.begin(), staged.keys.begin() + len);
+    staged.keys.erase(staged.keys.begin(), staged.keys.begin() + n * len);
+    staged.rids.erase(staged.rids.begin(), staged.rids.begin() + n);
+    staged.prev = node->get_page_no();
+
+    Rid child = {.page_no = node->get_page_no(), .slot_no = -1};
+    ih_->buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+    delete node;
+    if (is_root) {
+        ih_->update_root_page_no(child.page_no);
+    } else {
+        // 可能创建新的一层，levels_中的引用会失效
+        push_pair(level + 1, first_key.data(), child);
+    }
+}
+
+/**
+ * @description: 所有键值对都追加完之后，把第level层暂存区剩下的键值对写成这一层最右边的结点
+ * 最右边的结点没有上界，不使用公共前缀；它不足最小大小时，从左边的结点移入一些键值对，或者合并到左边的结点
+ */
+void IxBulkLoader::finish_level(size_t level) {
+    int n = static_cast<int>(levels_[level].rids.size());
+    int max_pairs = file_hdr_->btree_order_;
+    int min_pairs = (max_pairs + 1) / 2;
+    // 1. 这一层还没有写出过结点，说明它是最上层：放得下就作为根结点；只有一个孩子时由孩子作为根结点
+    if (levels_[level].prev == IX_NO_PAGE) {
+        if (n == 1 && level > 0) {
+            page_id_t child_page = levels_[level].rids[0].page_no;
+            IxNodeHandle *child = ih_->fetch_node(child_page);
+            child->set_parent_page_no(IX_NO_PAGE);
+            ih_->buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+            delete child;
+            ih_->update_root_page_no(child_page);
+            return;
+        }
+        if (n <= max_pairs) {
+            write_node(level, n, 0, true);
+            return;
+        }
+    }
+    // 2. 剩下的键值对超出没有公共前缀的结点的容量，先写出除最后一个以外的键值对
+    if (n > capacity(0)) {
+        write_node(level, n - 1, prefix_len(level, n - 1), false);
+        n = 1;
+    }
+    // 3. 与左边的结点一起调整到最小大小以上，左边的结点已经插入上一层，只能移动它末尾的键值对
+    if (n < min_pairs) {
+        IxNodeHandle *prev = ih_->fetch_node(levels_[level].prev);
+        int total = prev->get_size() + n;
+        ih_->buffer_pool_manager_->unpin_page(prev->get_page_id(), false);
+        delete prev;
+        if (total <= max_pairs) {
+            merge_into_prev(level);
+            return;
+        }
+        take_from_prev(level, min_pairs - n);
+        n = min_pairs;
+    }
+    write_node(level, n, 0, false);
+}
+
+/**
+ * @description: 把第level层上一个结点末尾的n个键值对移到暂存区的开头
+ */
+void IxBulkLoader::take_from_prev(size_t level, int n) {
+    Level &staged = levels_[level];
+    int len = file_hdr_->col_tot_len_;
+    IxNodeHandle *prev = ih_->fetch_node(staged.prev);
+    int pos = prev->get_size() - n;
+    std::vector<char> keys(n * len);
+    for (int i = 0; i < n; i++) {
+        memcpy(keys.data() + i * len, prev->get_key(pos + i), len);
+    }
+    staged.keys.insert(staged.keys.begin(), keys.begin(), keys.end());
+    staged.rids.insert(staged.rids.begin(), prev->get_rid(pos), prev->get_rid(pos) + n);
+    prev->set_size(pos);
+    ih_->buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
+}
+
+/**
+ * @description: 把第level层暂存区剩下的键值对合并到上一个结点中，它成为这一层最右边的结点，不再有公共前缀
+ */
+void IxBulkLoader::merge_into_prev(size_t level) {
+    Level &staged = levels_[level];
+    IxNodeHandle *prev = ih_->fetch_node(staged.prev);
+    if (prev->get_prefix_len() > 0) {
+        prev->set_prefix(prev->get_prefix(), 0);
+    }
+    int pos = prev->get_size();
+    int n = static_cast<int>(staged.rids.size());
+    prev->insert_pairs(pos, staged.keys.data(), staged.rids.data(), n);
+    for (int i = pos; i < pos + n; i++) {
+        ih_->maintain_child(prev, i);
+    }
+    staged.keys.clear();
+    staged.rids.clear();
+    ih_->buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
+}
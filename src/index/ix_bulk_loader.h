@@ -0,0 +1,100 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ix_defs.h"
+#include "ix_index_handle.h"
+
+/**
+ * @description: 自底向上批量构建B+树，用于在已有数据的表上创建索引。
+ * 1. add()收集所有(key, rid)，超出内存上限时把排好序的一段（run）写入临时文件；
+ * 2. finish()对内存中的数据排序，或者对所有run进行多路归并（外部排序），得到有序的键值对；
+ * 3. 有序的键值对依次追加到叶结点层的暂存区，暂存区的键值对达到一个结点的容量时写成一个结点，
+ *    并把结点的第一个key追加到上一层的暂存区中，一趟完成所有内部结点的构建
+ * @note 只能用于空索引；与insert_entry()一致，唯一索引中重复的key只保留一条；
+ * 非唯一索引中重复的key按rid排列，重复的(key, rid)只保留一条
+ * @note 规范化格式下结点的公共前缀取它的第一个key与下一个结点第一个key的公共前缀，
+ *       写出一个结点时才知道下一个结点的第一个key，因此每层先暂存键值对，而不是直接写入结点
+ */
+class IxBulkLoader {
+   public:
+    /**
+     * @param {IxIndexHandle*} ih 要构建的空索引
+     * @param {double} fill_factor 结点的填充因子，每个结点最多写入结点容量 * fill_factor个键值对
+     * @param {size_t} memory_limit 排序可用的内存（字节）
+     */
+    explicit IxBulkLoader(IxIndexHandle *ih, double fill_factor = IX_BULK_LOAD_FILL_FACTOR,
+                          size_t memory_limit = IX_BULK_LOAD_MEMORY);
+
+    ~IxBulkLoader();
+
+    IxBulkLoader(const IxBulkLoader &) = delete;
+    IxBulkLoader &operator=(const IxBulkLoader &) = delete;
+
+    // 添加一个键值对，key的长度为索引字段的总长度（不包括rid）
+    void add(const char *key, const Rid &rid);
+
+    // 排序所有键值对并构建B+树，返回写入索引的键值对数量
+    size_t finish();
+
+    // 已经写入临时文件的run的数量
+    size_t num_runs() const { return run_files_.size(); }
+
+   private:
+    // for sort
+    int compare_entry(const char *a, const char *b) const;
+
+    std::vector<const char *> sort_buffer() const;
+
+    void spill_run();
+
+    void merge_runs();
+
+    // for build
+    void append(const char *entry);
+
+    void push_pair(size_t level, const char *key, const Rid &rid);
+
+    int prefix_len(size_t level, int n) const;
+
+    int capacity(int prefix_len) const;
+
+    void write_node(size_t level, int n, int prefix_len, bool is_root);
+
+    void finish_level(size_t level);
+
+    void take_from_prev(size_t level, int n);
+
+    void merge_into_prev(size_t level);
+
+    // 每一层尚未写入结点的键值对
+    struct Level {
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        page_id_t prev = IX_NO_PAGE;        // 这一层上一个写入的结点
+    };
+
+    IxIndexHandle *ih_;
+    const IxFileHdr *file_hdr_;
+    int entry_len_;                         // 每个键值对的长度：key + Rid
+    double fill_factor_;
+    size_t memory_limit_;
+
+    std::vector<char> buffer_;              // 内存中尚未排序的键值对
+    std::vector<std::string> run_files_;    // 已排序的run所在的临时文件
+
+    std::vector<Level> levels_;             // levels_[0]为叶结点层
+    std::vector<char> last_key_;            // 上一个写入叶结点的key，用于去除重复的key
+    size_t num_entries_ = 0;
+};
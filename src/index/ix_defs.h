@@ -21,21 +21,41 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+constexpr int IX_FILE_VERSION = 1;                          // 索引文件格式的版本号，存放在文件头的最前面
+constexpr int IX_RID_COL_NUM = 2;                           // 非唯一索引的key最后附加的两个INT字段：记录的rid（page_no, slot_no）
+constexpr int IX_MAX_KEY_LEN = IX_MAX_COL_LEN + sizeof(Rid);  // 附加rid之后key的最大长度
+constexpr Rid IX_MIN_RID = {INT32_MIN, INT32_MIN};  // 与key组合得到该key的第一个键值对的下界
+constexpr Rid IX_MAX_RID = {INT32_MAX, INT32_MAX};  // 与key组合得到该key的最后一个键值对的上界
+constexpr double IX_BULK_LOAD_FILL_FACTOR = 0.9;            // 批量构建B+树时结点的填充因子，预留空间给之后的插入
+constexpr size_t IX_BULK_LOAD_MEMORY = 64 * 1024 * 1024;    // 批量构建B+树时排序可用的内存，超出后进行外部排序
+constexpr const char *IX_REBUILD_SUFFIX = ".rebuild";       // REINDEX时新索引的临时文件名后缀
+
+// 可扩展哈希索引：第0页为文件头，第1页为初始的桶，第2页起存放目录
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 1;
+constexpr int IX_HASH_INIT_DIR_PAGE = 2;
+constexpr int IX_HASH_INIT_NUM_PAGES = 3;
+constexpr int IX_HASH_MAX_DEPTH = 16;                       // 目录的最大全局深度，达到后桶满时只能追加溢出页
+constexpr int IX_HASH_DIR_SLOTS_PER_PAGE = PAGE_SIZE / sizeof(page_id_t);  // 每个目录页存放的桶页面号数量
 
 class IxFileHdr {
 public: 
+    int version_ = IX_FILE_VERSION;     // 文件格式的版本号，打开时检查；旧格式的文件头在这个位置存放tot_len_
     page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号
     int num_pages_;                     // 磁盘文件中页面的数量
     page_id_t root_page_;               // B+树根节点对应的页面号
-    int col_num_;                       // 索引包含的字段数量
+    // 唯一索引的key就是索引字段；非唯一索引的key由索引字段和记录的rid组成，相同的索引字段按rid排列，
+    // 两种索引中B+树的每个key都是唯一的
+    int col_num_;                       // key包含的字段数量（非唯一索引包括最后IX_RID_COL_NUM个rid字段）
     std::vector<ColType> col_types_;    // 字段的类型
     std::vector<int> col_lens_;         // 字段的长度
-    int col_tot_len_;                   // 索引包含的字段的总长度
+    int col_tot_len_;                   // key的总长度（非唯一索引为索引字段的总长度 + sizeof(Rid)）
     int btree_order_;                   // # children per page 每个结点最多可插入的键值对数量
     int keys_size_;                     // keys_size = (btree_order + 1) * col_tot_len
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    bool normalized_ = false;           // 结点中是否存放规范化的key（可以直接memcmp比较），并按结点截断公共前缀
+    bool unique_ = false;               // 是否为唯一索引，唯一索引的key不附加rid
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
@@ -49,14 +69,19 @@ public:
                     tot_len_ = 0;
                 } 
 
+    // 索引字段的总长度，也就是非唯一索引的key中rid的位置
+    int rid_offset() const { return unique_ ? col_tot_len_ : col_tot_len_ - static_cast<int>(sizeof(Rid)); }
+
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 7 + sizeof(bool) * 2;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
     void serialize(char* dest) {
         int offset = 0;
+        memcpy(dest + offset, &version_, sizeof(int));
+        offset += sizeof(int);
         memcpy(dest + offset, &tot_len_, sizeof(int));
         offset += sizeof(int);
         memcpy(dest + offset, &first_free_page_no_, sizeof(page_id_t));
@@ -85,11 +110,20 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &normalized_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &unique_, sizeof(bool));
+        offset += sizeof(bool);
         assert(offset == tot_len_);
     }
 
     void deserialize(char* src) {
         int offset = 0;
+        version_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        if (version_ != IX_FILE_VERSION) {
+            throw InternalError("IxFileHdr::deserialize: unsupported index file version " + std::to_string(version_));
+        }
         tot_len_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
         first_free_page_no_ = *reinterpret_cast<const page_id_t*>(src + offset);
@@ -123,16 +157,97 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        normalized_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        unique_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
         assert(offset == tot_len_);
     }
 };
 
+/* 可扩展哈希索引的文件头，关闭索引时写回第0页 */
+class IxHashFileHdr {
+public:
+    page_id_t first_free_page_no_;          // 文件中第一个空闲的磁盘页面的页面号
+    int num_pages_;                         // 磁盘文件中页面的数量
+    int global_depth_;                      // 目录的全局深度，目录共有2^global_depth_个槽位
+    int col_num_;                           // 索引字段的数量（哈希索引的key不附加rid）
+    std::vector<ColType> col_types_;        // 字段的类型
+    std::vector<int> col_lens_;             // 字段的长度
+    int col_tot_len_;                       // 索引字段的总长度
+    int bucket_capacity_;                   // 每个桶页面最多存放的键值对数量
+    std::vector<page_id_t> dir_page_nos_;   // 存放目录的页面，按顺序每页IX_HASH_DIR_SLOTS_PER_PAGE个槽位
+    int tot_len_;                           // 序列化之后的长度
+
+    IxHashFileHdr() { tot_len_ = col_num_ = 0; }
+
+    void update_tot_len() {
+        tot_len_ = sizeof(int) * 8 + (sizeof(ColType) + sizeof(int)) * col_num_ +
+                   sizeof(page_id_t) * static_cast<int>(dir_page_nos_.size());
+    }
+
+    void serialize(char *dest) {
+        int offset = 0;
+        auto put = [&](const void *src, size_t len) {
+            memcpy(dest + offset, src, len);
+            offset += static_cast<int>(len);
+        };
+        int num_dir_pages = static_cast<int>(dir_page_nos_.size());
+        put(&tot_len_, sizeof(int));
+        put(&first_free_page_no_, sizeof(page_id_t));
+        put(&num_pages_, sizeof(int));
+        put(&global_depth_, sizeof(int));
+        put(&col_num_, sizeof(int));
+        put(col_types_.data(), sizeof(ColType) * col_num_);
+        put(col_lens_.data(), sizeof(int) * col_num_);
+        put(&col_tot_len_, sizeof(int));
+        put(&bucket_capacity_, sizeof(int));
+        put(&num_dir_pages, sizeof(int));
+        put(dir_page_nos_.data(), sizeof(page_id_t) * num_dir_pages);
+        assert(offset == tot_len_);
+    }
+
+    void deserialize(const char *src) {
+        int offset = 0;
+        auto get = [&](void *dest, size_t len) {
+            memcpy(dest, src + offset, len);
+            offset += static_cast<int>(len);
+        };
+        int num_dir_pages;
+        get(&tot_len_, sizeof(int));
+        get(&first_free_page_no_, sizeof(page_id_t));
+        get(&num_pages_, sizeof(int));
+        get(&global_depth_, sizeof(int));
+        get(&col_num_, sizeof(int));
+        col_types_.resize(col_num_);
+        col_lens_.resize(col_num_);
+        get(col_types_.data(), sizeof(ColType) * col_num_);
+        get(col_lens_.data(), sizeof(int) * col_num_);
+        get(&col_tot_len_, sizeof(int));
+        get(&bucket_capacity_, sizeof(int));
+        get(&num_dir_pages, sizeof(int));
+        dir_page_nos_.resize(num_dir_pages);
+        get(dir_page_nos_.data(), sizeof(page_id_t) * num_dir_pages);
+        assert(offset == tot_len_);
+    }
+};
+
+/* 哈希桶页面的页头，之后依次存放键值对：规范化的key（col_tot_len_字节）和rid */
+class IxHashBucketHdr {
+public:
+    page_id_t next_free_page_no;    // 页面被回收后，空闲页面链表中的下一个空闲页面
+    page_id_t next_overflow;        // 桶的下一个溢出页，没有时为IX_NO_PAGE；溢出页的local_depth与桶相同
+    int local_depth;                // 桶的局部深度：目录中所有低local_depth位相同的槽位都指向这个桶
+    int num_entries;                // 页面中键值对的数量
+};
+
 class IxPageHdr {
 public:
-    page_id_t next_free_page_no;    // unused
+    page_id_t next_free_page_no;    // 结点被删除后，空闲页面链表中的下一个空闲页面
     page_id_t parent;               // 父亲节点所在页面的叶号
     int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf;                   // 是否为叶节点
+    uint16_t prefix_len;            // 结点中所有key的公共前缀长度，只用于规范化格式（file_hdr->normalized_），前缀存放在页头之后
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
 };
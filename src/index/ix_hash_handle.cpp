@@ -0,0 +1,430 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash_handle.h"
+
+#include <algorithm>
+
+#include "ix_index_handle.h"
+
+IxHashHandle::IxHashHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    char buf[PAGE_SIZE];
+    memset(buf, 0, PAGE_SIZE);
+    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    file_hdr_ = new IxHashFileHdr();
+    file_hdr_->deserialize(buf);
+
+    // 与IxIndexHandle相同，新分配的page_no不能小于文件中已有的页面数
+    int now_page_no = disk_manager_->get_fd2pageno(fd);
+    int file_pages = disk_manager_->get_file_size(disk_manager_->get_file_name(fd)) / PAGE_SIZE;
+    disk_manager_->set_fd2pageno(fd, std::max(now_page_no + 1, file_pages));
+
+    // 从目录页读入目录
+    dir_.resize(static_cast<size_t>(1) << file_hdr_->global_depth_);
+    for (size_t i = 0; i < file_hdr_->dir_page_nos_.size(); ++i) {
+        size_t begin = i * IX_HASH_DIR_SLOTS_PER_PAGE;
+        if (begin >= dir_.size()) {
+            break;
+        }
+        size_t num = std::min(dir_.size() - begin, static_cast<size_t>(IX_HASH_DIR_SLOTS_PER_PAGE));
+        Page *page = fetch_page(file_hdr_->dir_page_nos_[i]);
+        memcpy(dir_.data() + begin, page->get_data(), num * sizeof(page_id_t));
+        unpin_page(page, false);
+    }
+}
+
+/**
+ * @description: 查找key对应的所有rid
+ * @param result 传出参数：按rid从小到大排列
+ * @return key是否存在
+ */
+bool IxHashHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    char entry[IX_MAX_KEY_LEN];
+    uint64_t hash = make_entry(key, Rid{0, 0}, entry);
+    size_t old_size = result->size();
+    {
+        std::shared_lock lock{dir_latch_};
+        Page *bucket = fetch_page(bucket_of(hash));
+        bucket->rlatch();
+        for (page_id_t page_no = bucket->get_page_id().page_no; page_no != IX_NO_PAGE;) {
+            Page *page = page_no == bucket->get_page_id().page_no ? bucket : fetch_page(page_no);
+            auto hdr = bucket_hdr(page);
+            for (int i = 0; i < hdr->num_entries; ++i) {
+                char *cur = entry_at(page, i);
+                if (memcmp(cur, entry, file_hdr_->col_tot_len_) == 0) {
+                    result->push_back(*reinterpret_cast<Rid *>(cur + file_hdr_->col_tot_len_));
+                }
+            }
+            page_no = hdr->next_overflow;
+            if (page != bucket) {
+                unpin_page(page, false);
+            }
+        }
+        bucket->runlatch();
+        unpin_page(bucket, false);
+    }
+    std::sort(result->begin() + old_size, result->end(), [](const Rid &a, const Rid &b) {
+        return a.page_no < b.page_no || (a.page_no == b.page_no && a.slot_no < b.slot_no);
+    });
+    return result->size() > old_size;
+}
+
+/**
+ * @description: 插入键值对
+ * @return 插入成功返回true，(key, value)已经存在时返回false
+ * @note 先只持有目录的读锁尝试插入；桶满时改为持有目录的写锁，分裂桶直到有空位，无法分裂时追加溢出页
+ */
+bool IxHashHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
+    char entry[IX_MAX_KEY_LEN];
+    uint64_t hash = make_entry(key, value, entry);
+    {
+        std::shared_lock lock{dir_latch_};
+        Page *bucket = fetch_page(bucket_of(hash));
+        bucket->wlatch();
+        int res = try_insert(bucket, entry);
+        bucket->wunlatch();
+        unpin_page(bucket, res == 1);
+        if (res >= 0) {
+            return res == 1;
+        }
+    }
+    // 持有目录的写锁时，其他操作都不会访问桶页面，不需要再加页面的latch
+    std::unique_lock lock{dir_latch_};
+    while (true) {
+        Page *bucket = fetch_page(bucket_of(hash));
+        int res = try_insert(bucket, entry);
+        if (res >= 0) {
+            unpin_page(bucket, res == 1);
+            return res == 1;
+        }
+        if (!split(bucket)) {
+            add_overflow_page(bucket);
+        }
+        unpin_page(bucket, true);
+    }
+}
+
+/**
+ * @description: 删除键值对
+ * @return 删除成功返回true，(key, value)不存在时返回false
+ * @note 被删除的位置用同一页面的最后一个键值对填补；溢出页变空时从链中摘下并回收
+ */
+bool IxHashHandle::delete_entry(const char *key, const Rid &value, Transaction *transaction) {
+    char entry[IX_MAX_KEY_LEN];
+    uint64_t hash = make_entry(key, value, entry);
+    std::shared_lock lock{dir_latch_};
+    Page *bucket = fetch_page(bucket_of(hash));
+    bucket->wlatch();
+    bool deleted = false;
+    Page *prev = nullptr;  // page的前一个页面，保持pin以便把变空的page从链中摘下
+    Page *page = bucket;
+    while (true) {
+        auto hdr = bucket_hdr(page);
+        int idx = find_entry(page, entry);
+        if (idx >= 0) {
+            memmove(entry_at(page, idx), entry_at(page, hdr->num_entries - 1), entry_len());
+            hdr->num_entries--;
+            deleted = true;
+            if (page != bucket && hdr->num_entries == 0) {
+                bucket_hdr(prev)->next_overflow = hdr->next_overflow;
+                release_page(page);
+                page = nullptr;
+            }
+            break;
+        }
+        if (hdr->next_overflow == IX_NO_PAGE) {
+            break;
+        }
+        if (prev != nullptr && prev != bucket) {
+            unpin_page(prev, false);
+        }
+        prev = page;
+        page = fetch_page(hdr->next_overflow);
+    }
+    if (page != nullptr && page != bucket) {
+        unpin_page(page, deleted);
+    }
+    if (prev != nullptr && prev != bucket) {
+        unpin_page(prev, deleted);
+    }
+    bucket->wunlatch();
+    unpin_page(bucket, deleted);
+    return deleted;
+}
+
+/**
+ * @description: 批量查找，结果与对每个key调用get_value()相同
+ * @param result 传出参数：与keys一一对应，每个key的所有rid，key不存在时为空
+ * @return size_t 存在的key的数量
+ */
+size_t IxHashHandle::get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *result,
+                                Transaction *transaction) {
+    result->assign(keys.size(), std::vector<Rid>());
+    size_t num_found = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        num_found += get_value(keys[i], &(*result)[i], transaction);
+    }
+    return num_found;
+}
+
+/**
+ * @description: 批量插入，结果与逐个调用insert_entry()相同
+ * @return size_t 插入成功的键值对数量
+ */
+size_t IxHashHandle::insert_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values,
+                                    Transaction *transaction) {
+    size_t num_inserted = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        num_inserted += insert_entry(keys[i], values[i], transaction);
+    }
+    return num_inserted;
+}
+
+/**
+ * @description: 批量删除，结果与逐个调用delete_entry()相同
+ * @return size_t 删除成功的键值对数量
+ */
+size_t IxHashHandle::delete_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values,
+                                    Transaction *transaction) {
+    size_t num_deleted = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        num_deleted += delete_entry(keys[i], values[i], transaction);
+    }
+    return num_deleted;
+}
+
+uint64_t IxHashHandle::make_entry(const char *key, const Rid &rid, char *entry) const {
+    // 规范化之后-0.0与0.0相同，相等的key的字节也完全相同，可以直接哈希和memcmp
+    ix_normalize_key(key, entry, file_hdr_->col_types_, file_hdr_->col_lens_);
+    memcpy(entry + file_hdr_->col_tot_len_, &rid, sizeof(Rid));
+    return entry_hash(entry);
+}
+
+int IxHashHandle::find_entry(Page *page, const char *entry) const {
+    auto hdr = bucket_hdr(page);
+    for (int i = 0; i < hdr->num_entries; ++i) {
+        if (memcmp(entry_at(page, i), entry, entry_len()) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int IxHashHandle::try_insert(Page *bucket, const char *entry) {
+    Page *target = nullptr;  // 链中第一个有空位的页面
+    for (Page *page = bucket;;) {
+        auto hdr = bucket_hdr(page);
+        if (find_entry(page, entry) >= 0) {
+            if (target != nullptr && target != bucket) {
+                unpin_page(target, false);
+            }
+            if (page != bucket && page != target) {
+                unpin_page(page, false);
+            }
+            return 0;
+        }
+        page_id_t next = hdr->next_overflow;
+        if (target == nullptr && hdr->num_entries < file_hdr_->bucket_capacity_) {
+            target = page;
+        } else if (page != bucket) {
+            unpin_page(page, false);
+        }
+        if (next == IX_NO_PAGE) {
+            break;
+        }
+        page = fetch_page(next);
+    }
+    if (target == nullptr) {
+        return -1;
+    }
+    auto hdr = bucket_hdr(target);
+    memcpy(entry_at(target, hdr->num_entries), entry, entry_len());
+    hdr->num_entries++;
+    if (target != bucket) {
+        unpin_page(target, true);
+    }
+    return 1;
+}
+
+/**
+ * @description: 分裂桶：局部深度加一，哈希值第local_depth位为1的键值对移到新桶
+ * @return 能否分裂；桶中所有键值对的哈希值都相同，或者局部深度已经达到IX_HASH_MAX_DEPTH时返回false
+ * @note 调用者持有目录的写锁
+ */
+bool IxHashHandle::split(Page *bucket) {
+    auto hdr = bucket_hdr(bucket);
+    if (hdr->local_depth >= IX_HASH_MAX_DEPTH) {
+        return false;
+    }
+    // 读出整条链中的键值对
+    std::vector<char> entries;
+    for (Page *page = bucket;;) {
+        auto page_hdr = bucket_hdr(page);
+        entries.insert(entries.end(), entry_at(page, 0), entry_at(page, page_hdr->num_entries));
+        page_id_t next = page_hdr->next_overflow;
+        if (page != bucket) {
+            unpin_page(page, false);
+        }
+        if (next == IX_NO_PAGE) {
+            break;
+        }
+        page = fetch_page(next);
+    }
+    size_t num = entries.size() / entry_len();
+    uint64_t first_hash = entry_hash(entries.data());
+    bool same_hash = true;
+    for (size_t i = 1; i < num && same_hash; ++i) {
+        same_hash = entry_hash(entries.data() + i * entry_len()) == first_hash;
+    }
+    if (same_hash) {
+        return false;
+    }
+
+    int depth = hdr->local_depth;
+    if (depth == file_hdr_->global_depth_) {
+        dir_.insert(dir_.end(), dir_.begin(), dir_.end());
+        file_hdr_->global_depth_++;
+    }
+    Page *image = create_page();
+    page_id_t bucket_no = bucket->get_page_id().page_no;
+    page_id_t image_no = image->get_page_id().page_no;
+    *bucket_hdr(image) = {.next_free_page_no = IX_NO_PAGE, .next_overflow = IX_NO_PAGE, .local_depth = depth + 1,
+                          .num_entries = 0};
+    hdr->local_depth = depth + 1;
+    for (size_t i = 0; i < dir_.size(); ++i) {
+        if (dir_[i] == bucket_no && ((i >> depth) & 1)) {
+            dir_[i] = image_no;
+        }
+    }
+    std::vector<char> stay, move;
+    for (size_t i = 0; i < num; ++i) {
+        const char *entry = entries.data() + i * entry_len();
+        auto &part = ((entry_hash(entry) >> depth) & 1) ? move : stay;
+        part.insert(part.end(), entry, entry + entry_len());
+    }
+    write_chain(bucket, stay);
+    write_chain(image, move);
+    unpin_page(image, true);
+    return true;
+}
+
+// 在桶的溢出页链末尾追加一个空的溢出页，调用者持有目录的写锁
+void IxHashHandle::add_overflow_page(Page *bucket) {
+    Page *last = bucket;
+    while (bucket_hdr(last)->next_overflow != IX_NO_PAGE) {
+        page_id_t next = bucket_hdr(last)->next_overflow;
+        if (last != bucket) {
+            unpin_page(last, false);
+        }
+        last = fetch_page(next);
+    }
+    Page *page = create_page();
+    *bucket_hdr(page) = {.next_free_page_no = IX_NO_PAGE, .next_overflow = IX_NO_PAGE,
+                         .local_depth = bucket_hdr(bucket)->local_depth, .num_entries = 0};
+    bucket_hdr(last)->next_overflow = page->get_page_id().page_no;
+    unpin_page(page, true);
+    if (last != bucket) {
+        unpin_page(last, true);
+    }
+}
+
+void IxHashHandle::write_chain(Page *bucket, const std::vector<char> &entries) {
+    int capacity = file_hdr_->bucket_capacity_;
+    int num = static_cast<int>(entries.size()) / entry_len();
+    int local_depth = bucket_hdr(bucket)->local_depth;
+    Page *page = bucket;
+    for (int written = 0;;) {
+        auto hdr = bucket_hdr(page);
+        int cnt = std::min(capacity, num - written);
+        memcpy(entry_at(page, 0), entries.data() + written * entry_len(), cnt * entry_len());
+        hdr->num_entries = cnt;
+        written += cnt;
+        if (written == num) {
+            // 回收剩下的溢出页
+            page_id_t next = hdr->next_overflow;
+            hdr->next_overflow = IX_NO_PAGE;
+            while (next != IX_NO_PAGE) {
+                Page *rest = fetch_page(next);
+                next = bucket_hdr(rest)->next_overflow;
+                release_page(rest);
+            }
+            if (page != bucket) {
+                unpin_page(page, true);
+            }
+            return;
+        }
+        Page *next_page;
+        if (hdr->next_overflow != IX_NO_PAGE) {
+            next_page = fetch_page(hdr->next_overflow);
+        } else {
+            next_page = create_page();
+            *bucket_hdr(next_page) = {.next_free_page_no = IX_NO_PAGE, .next_overflow = IX_NO_PAGE,
+                                      .local_depth = local_depth, .num_entries = 0};
+            hdr->next_overflow = next_page->get_page_id().page_no;
+        }
+        bucket_hdr(next_page)->local_depth = local_depth;
+        if (page != bucket) {
+            unpin_page(page, true);
+        }
+        page = next_page;
+    }
+}
+
+void IxHashHandle::flush_dir() {
+    std::unique_lock lock{dir_latch_};
+    size_t num_pages = (dir_.size() + IX_HASH_DIR_SLOTS_PER_PAGE - 1) / IX_HASH_DIR_SLOTS_PER_PAGE;
+    for (size_t i = 0; i < num_pages; ++i) {
+        Page *page;
+        if (i < file_hdr_->dir_page_nos_.size()) {
+            page = fetch_page(file_hdr_->dir_page_nos_[i]);
+        } else {
+            page = create_page();
+            file_hdr_->dir_page_nos_.push_back(page->get_page_id().page_no);
+        }
+        size_t begin = i * IX_HASH_DIR_SLOTS_PER_PAGE;
+        size_t num = std::min(dir_.size() - begin, static_cast<size_t>(IX_HASH_DIR_SLOTS_PER_PAGE));
+        memcpy(page->get_data(), dir_.data() + begin, num * sizeof(page_id_t));
+        unpin_page(page, true);
+    }
+    file_hdr_->update_tot_len();
+}
+
+/**
+ * @description: 分配一个清空的页面，优先复用空闲页面链表头的页面
+ * @note pin the page, remember to unpin it outside!
+ */
+Page *IxHashHandle::create_page() {
+    Page *page = nullptr;
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+            page = fetch_page(file_hdr_->first_free_page_no_);
+            file_hdr_->first_free_page_no_ = bucket_hdr(page)->next_free_page_no;
+        } else {
+            file_hdr_->num_pages_++;
+        }
+    }
+    if (page != nullptr) {
+        memset(page->get_data(), 0, PAGE_SIZE);
+    } else {
+        PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+        page = buffer_pool_manager_->new_page(&new_page_id);
+    }
+    return page;
+}
+
+// 把页面放入空闲页面链表并unpin
+void IxHashHandle::release_page(Page *page) {
+    std::scoped_lock lock{file_hdr_latch_};
+    bucket_hdr(page)->next_free_page_no = file_hdr_->first_free_page_no_;
+    file_hdr_->first_free_page_no_ = page->get_page_id().page_no;
+    unpin_page(page, true);
+}
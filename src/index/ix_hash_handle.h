@@ -0,0 +1,122 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "ix_defs.h"
+#include "transaction/transaction.h"
+
+/**
+ * @description: 计算规范化之后的key的哈希值（64位FNV-1a，再经过murmur3的fmix64打散低位），
+ * 哈希值会持久化地决定键值对所在的桶，不能使用随实现变化的std::hash
+ */
+inline uint64_t ix_hash(const char *key, int len) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (int i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(key[i]);
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/* 可扩展哈希索引，只支持所有索引字段上的等值查询
+ * 目录常驻内存，打开索引时从目录页读入，关闭索引时由IxManager::close_hash_index()写回；桶页面通过BufferPoolManager读写
+ * 自身不检查key是否重复：同一个key可以对应多个rid，(key, rid)不能重复；唯一索引的约束由SmManager和DML算子检查
+ * 桶满时分裂，局部深度等于全局深度时先把目录扩大一倍；桶中所有键值对哈希值相同（同一个key的大量重复）
+ * 或者已经达到IX_HASH_MAX_DEPTH时不再分裂，改为在桶后追加溢出页。删除不合并桶，只回收变空的溢出页
+ * 并发：普通的查找/插入/删除持有目录的读锁和桶的第一个页面的latch（它同时保护整条溢出页链）；
+ * 分裂持有目录的写锁，这时没有其他操作在访问桶页面 */
+class IxHashHandle {
+    friend class IxManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    IxHashFileHdr *file_hdr_;
+    std::vector<page_id_t> dir_;        // 目录：第i个槽位指向哈希值低global_depth_位为i的键值对所在的桶
+    std::shared_mutex dir_latch_;       // 保护dir_和file_hdr_->global_depth_
+    std::mutex file_hdr_latch_;         // 保护file_hdr_->num_pages_和空闲页面链表
+
+   public:
+    IxHashHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+
+    ~IxHashHandle() { delete file_hdr_; }
+
+    // key为索引字段按顺序拼接的原始格式，长度为col_tot_len_；结果按rid从小到大排列
+    bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
+
+    // (key, value)已经存在时返回false
+    bool insert_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    bool delete_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    // for batch：与IxIndexHandle的批量接口相同，哈希索引中每个key只需访问一个桶，逐个处理即可
+    size_t get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *result,
+                      Transaction *transaction);
+
+    size_t insert_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values, Transaction *transaction);
+
+    size_t delete_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values, Transaction *transaction);
+
+    int get_global_depth() const { return file_hdr_->global_depth_; }
+
+   private:
+    // 把上层传入的key规范化并附加rid，写入entry（长度为entry_len()），返回哈希值
+    uint64_t make_entry(const char *key, const Rid &rid, char *entry) const;
+
+    int entry_len() const { return file_hdr_->col_tot_len_ + static_cast<int>(sizeof(Rid)); }
+
+    uint64_t entry_hash(const char *entry) const { return ix_hash(entry, file_hdr_->col_tot_len_); }
+
+    page_id_t bucket_of(uint64_t hash) const {
+        return dir_[hash & ((static_cast<uint64_t>(1) << file_hdr_->global_depth_) - 1)];
+    }
+
+    static IxHashBucketHdr *bucket_hdr(Page *page) { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    char *entry_at(Page *page, int idx) const {
+        return page->get_data() + sizeof(IxHashBucketHdr) + idx * entry_len();
+    }
+
+    // entry在页面中的位置，不存在时返回-1
+    int find_entry(Page *page, const char *entry) const;
+
+    // 在桶（bucket为桶的第一个页面）中插入entry：1表示插入成功，0表示已经存在，-1表示整条溢出页链都满了
+    int try_insert(Page *bucket, const char *entry);
+
+    bool split(Page *bucket);
+
+    void add_overflow_page(Page *bucket);
+
+    // 把entries按顺序写入以bucket开头的溢出页链，页面不够时追加，多余的溢出页回收
+    void write_chain(Page *bucket, const std::vector<char> &entries);
+
+    // 将目录写回目录页，目录页不够时追加；由IxManager::close_hash_index()调用
+    void flush_dir();
+
+    Page *fetch_page(page_id_t page_no) const { return buffer_pool_manager_->fetch_page(PageId{fd_, page_no}); }
+
+    void unpin_page(Page *page, bool is_dirty) const {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty);
+    }
+
+    Page *create_page();
+
+    void release_page(Page *page);
+};
@@ -12,6 +12,31 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_scan.h"
 #include <algorithm>
+#include <numeric>
+
+/**
+ * @brief 比较target与结点中第key_idx个key
+ * @note target和key都是索引中存储的格式，规范化格式下target不需要以结点的公共前缀开头
+ */
+int IxNodeHandle::compare_key(const char *target, int key_idx) const {
+    if (file_hdr->normalized_) {
+        int cmp = memcmp(target, get_prefix(), get_prefix_len());
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+    return compare_suffix(target, key_idx);
+}
+
+/**
+ * @brief 比较target与结点中第key_idx个key去掉公共前缀的部分，调用者保证target以结点的公共前缀开头
+ */
+int IxNodeHandle::compare_suffix(const char *target, int key_idx) const {
+    if (file_hdr->normalized_) {
+        return memcmp(target + get_prefix_len(), key_slot(key_idx), key_len());
+    }
+    return ix_compare(target, key_slot(key_idx), file_hdr->col_types_, file_hdr->col_lens_);
+}
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
@@ -25,13 +50,26 @@ int IxNodeHandle::lower_bound(const char *target) const {
 
     // 在当前节点内执行二分查找，找到第一个大于或等于目标键的位置
     // 使用 ix_compare 函数进行键的比较，并返回找到的键的索引，如果目标键大于所有键，则返回 num_key（上界）
+    // 单个INT字段的key使用SIMD查找
+    if (is_int_key()) {
+        int key[IX_INT_RID_WIDTH];
+        memcpy(key, target, int_key_width() * sizeof(int));
+        return ix_int_key_lower_bound(reinterpret_cast<const int *>(key_slot(0)), page_hdr->num_key, key, int_key_width());
+    }
+    // 规范化格式下先比较公共前缀：target不以公共前缀开头时，它在所有key之前或之后；否则只需要比较去掉前缀的部分
+    if (file_hdr->normalized_) {
+        int cmp = memcmp(target, get_prefix(), get_prefix_len());
+        if (cmp != 0) {
+            return cmp < 0 ? 0 : page_hdr->num_key;
+        }
+    }
     const int LOWER = 0;
     const int UPPER = 1;
     int op1 = LOWER;
     int left = 0, mid, right = page_hdr->num_key;
     while (left < right) {
         mid = (left + right) / 2;
-        int compareRes = ix_compare(target, get_key(mid), file_hdr->col_types_, file_hdr->col_lens_);
+        int compareRes = compare_suffix(target, mid);
         if (compareRes >= 0) {
             if (op1 == LOWER && compareRes == 0) {
                 right = mid;
@@ -60,13 +98,24 @@ int IxNodeHandle::upper_bound(const char *target) const {
     // 在当前节点内执行二分查找，找到第一个大于目标键的位置
     // 使用 ix_compare 函数进行键的比较，并返回找到的键的索引，如果目标键大于或等于所有键，则返回 num_key（上界）
 
+    if (is_int_key()) {
+        int key[IX_INT_RID_WIDTH];
+        memcpy(key, target, int_key_width() * sizeof(int));
+        return ix_int_key_upper_bound(reinterpret_cast<const int *>(key_slot(0)), page_hdr->num_key, key, int_key_width());
+    }
+    if (file_hdr->normalized_) {
+        int cmp = memcmp(target, get_prefix(), get_prefix_len());
+        if (cmp != 0) {
+            return cmp < 0 ? 0 : page_hdr->num_key;
+        }
+    }
     const int LOWER = 0;
     const int UPPER = 1;
     int op2 = UPPER;
     int left = 0, mid, right = page_hdr->num_key;
     while (left < right) {
         mid = (left + right) / 2;
-        int compareRes = ix_compare(target, get_key(mid), file_hdr->col_types_, file_hdr->col_lens_);
+        int compareRes = compare_suffix(target, mid);
         if (compareRes >= 0) {
             if (op2 == LOWER && compareRes == 0) {
                 right = mid;
@@ -103,7 +152,7 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
     int index = lower_bound(targetKey);
 
     if (index != get_size()) { 
-        if (!ix_compare(targetKey, get_key(index), file_hdr->col_types_, file_hdr->col_lens_)) {
+        if (!compare_key(targetKey, index)) {
             result=index;
         }
         else{
@@ -133,7 +182,17 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
 
     //在内部节点（非叶子节点）中查找目标键应该位于的孩子节点
     //使用 upper_bound 找到第一个大于目标键的位置，然后返回该位置左侧孩子节点对应的 page_id
-    int index = upper_bound(key); 
+    int index;
+    if (is_int_key()) {
+        // 向第一个孩子插入更小的key时，只持有叶结点latch的插入不会更新祖先结点的第0个key，它可能大于后面的key；
+        // SIMD查找会统计范围内所有的key，因此跳过第0个key，从第1个key开始查找
+        int target[IX_INT_RID_WIDTH];
+        memcpy(target, key, int_key_width() * sizeof(int));
+        index = 1 + ix_int_key_upper_bound(reinterpret_cast<const int *>(key_slot(1)), page_hdr->num_key - 1, target,
+                                           int_key_width());
+    } else {
+        index = upper_bound(key);
+    }
     if (index) 
         --index;
 
@@ -166,22 +225,71 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
 
     // 判断pos的合法性
     if (get_size() >= pos) {
+        assert(get_size() + n <= get_max_size());
         // 获取n个连续键值对的键值和Rid值
-        char *pos_key = get_key(pos);
+        // 结点中每个key占key_len()个字节，规范化格式下只存放去掉公共前缀的部分；传入的key是完整的
+        int key_len = this->key_len();
+        char *pos_key = key_slot(pos);
         Rid *pos_rid = get_rid(pos);
 
         // memmove 函数解决区域重叠的情况，保证数据移动的正确性
         // 数据移动
-        memmove(pos_key + n * (file_hdr->col_tot_len_), pos_key, (get_size() - pos) * (file_hdr->col_tot_len_));
+        memmove(pos_key + n * key_len, pos_key, (get_size() - pos) * key_len);
         memmove(pos_rid + n, pos_rid, (get_size() - pos) * sizeof(Rid));
         // 插入键和值
-        memmove(pos_key, key, n * (file_hdr->col_tot_len_));
+        if (key_len == file_hdr->col_tot_len_) {
+            memmove(pos_key, key, n * key_len);
+        } else {
+            for (int i = 0; i < n; i++) {
+                set_key(pos + i, key + i * file_hdr->col_tot_len_);
+            }
+        }
         memmove(pos_rid, rid, n * sizeof(Rid));
         // 更新当前节点的键数
         page_hdr->num_key += n;
     }
 }
 
+/**
+ * @brief 把src结点中从src_pos开始的n个键值对插入到当前结点的pos位置
+ * 两个结点的公共前缀可能不同，规范化格式下先还原出完整的key再插入，调用者保证这些key都以当前结点的公共前缀开头
+ */
+void IxNodeHandle::insert_pairs_from(int pos, IxNodeHandle *src, int src_pos, int n) {
+    if (!file_hdr->normalized_) {
+        insert_pairs(pos, src->get_key(src_pos), src->get_rid(src_pos), n);
+        return;
+    }
+    int col_tot_len = file_hdr->col_tot_len_;
+    std::vector<char> keys(n * col_tot_len);
+    for (int i = 0; i < n; i++) {
+        memcpy(keys.data() + i * col_tot_len, src->get_key(src_pos + i), col_tot_len);
+    }
+    insert_pairs(pos, keys.data(), src->get_rid(src_pos), n);
+}
+
+/**
+ * @brief 修改规范化格式的结点的公共前缀，按新的前缀重新存放所有键值对
+ * 前缀变长时结点能存放更多的键值对，变短时调用者保证键值对仍然放得下，并且所有key都以新的前缀开头
+ *
+ * @param prefix 新的公共前缀，可以指向当前结点中的数据
+ */
+void IxNodeHandle::set_prefix(const char *prefix, int prefix_len) {
+    assert(file_hdr->normalized_);
+    int size = get_size();
+    assert(size <= max_size_of(file_hdr, prefix_len));
+    int col_tot_len = file_hdr->col_tot_len_;
+    std::vector<char> new_prefix(prefix, prefix + prefix_len);
+    std::vector<char> keys(size * col_tot_len);
+    std::vector<Rid> rids(get_rid(0), get_rid(0) + size);
+    for (int i = 0; i < size; i++) {
+        memcpy(keys.data() + i * col_tot_len, get_key(i), col_tot_len);
+    }
+    page_hdr->prefix_len = prefix_len;
+    memcpy(page->get_data() + sizeof(IxPageHdr), new_prefix.data(), prefix_len);
+    page_hdr->num_key = 0;
+    insert_pairs(0, keys.data(), rids.data(), size);
+}
+
 /**
  * @brief 用于在结点中插入单个键值对。
  * 函数返回插入后的键值对数量
@@ -200,8 +308,8 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
 
     //查找要插入的键值对应该插入到当前节点的哪个位置
     int index = lower_bound(key);
-    // key重复则不插入
-    if (!ix_compare(key, get_key(index), file_hdr->col_types_, file_hdr->col_lens_)) {
+    // key重复则不插入：非唯一索引的key包含rid，只有同一个(key, rid)才会重复
+    if (index < get_size() && !compare_key(key, index)) {
         return get_size();
     } else { // key不重复则插入键值对
         insert_pair(index, key, value);
@@ -224,12 +332,13 @@ void IxNodeHandle::erase_pair(int pos) {
     // 函数用于在结点中的指定位置删除单个键值对
 
     // 获取要删除的键值对的位置pos
-    char *pos_key = get_key(pos);
+    int key_len = this->key_len();
+    char *pos_key = key_slot(pos);
     Rid *pos_rid = get_rid(pos);
     int resSize = get_size() - pos - 1;
 
     // memmove函数将pos之后的所有key和rid向前移动，实现删除
-    memmove(pos_key, pos_key + (file_hdr->col_tot_len_), resSize * (file_hdr->col_tot_len_));
+    memmove(pos_key, pos_key + key_len, resSize * key_len);
     memmove(pos_rid, pos_rid + 1, resSize * sizeof(Rid));
     // 更新结点的键值对数量
     page_hdr->num_key--;
@@ -257,7 +366,7 @@ int IxNodeHandle::remove(const char *key) {
     int index = lower_bound(targetKey);
 
     if (index != get_size()) {  
-        if (!ix_compare(targetKey, get_key(index), file_hdr->col_types_, file_hdr->col_lens_)) {
+        if (!compare_key(targetKey, index)) {
             result=index;
         }
         else{
@@ -274,6 +383,18 @@ int IxNodeHandle::remove(const char *key) {
     return get_size();
 }
 
+/**
+ * @brief 删除键值对(key, value)，函数返回删除后的键值对数量
+ * @note 唯一索引的key不包含rid，key相同的键值对可能属于另一条记录，只有rid也相同时才删除
+ */
+int IxNodeHandle::remove(const char *key, const Rid &value) {
+    int pos = lower_bound(key);
+    if (pos < get_size() && compare_key(key, pos) == 0 && *get_rid(pos) == value) {
+        erase_pair(pos);
+    }
+    return get_size();
+}
+
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
@@ -285,51 +406,145 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_->deserialize(buf);
     
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
+    // 同一个索引文件可能以不同的fd被再次打开，新分配的page_no不能小于文件中已有的页面数
     int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    int file_pages = disk_manager_->get_file_size(disk_manager_->get_file_name(fd)) / PAGE_SIZE;
+    disk_manager_->set_fd2pageno(fd, std::max(now_page_no + 1, file_pages));
 }
 
 /**
  * @brief 用于查找指定键所在的叶子结点
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
- * @param transaction 事务参数，如果不需要则默认传入nullptr
- * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
- * @note need to Unlatch and unpin the leaf node outside!
+ * @param transaction 事务参数，FIND操作不需要则传入nullptr；INSERT/DELETE操作必须传入，加了写latch的页面记录在其index_latch_page_set中
+ * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及root_latch_是否仍被当前操作持有
+ * @note FIND：返回的叶结点加了读latch，需要在外面runlatch并unpin；
+ * INSERT/DELETE：返回的叶结点加了写latch，叶结点及仍需修改的祖先结点都在index_latch_page_set中，用release_latches()统一释放
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * @note 乐观插入只持有叶结点的写latch，插入到叶结点第0个位置时不会更新祖先结点中对应的key，
+ * 因此内部结点的第0个key可能大于它子树中最小的key（过时的下界）。下降时internal_lookup()不使用第0个key：
+ * 小于第1个key的target都进入第一个孩子
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                            Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+                                                            Transaction *transaction) {
+    // 1. 乐观下降：从根结点开始逐层加读latch，拿到孩子结点的latch之后立即释放父结点（latch crabbing）
+    //    写操作对叶结点加写latch：持有父结点读latch时叶结点不会被分裂或合并，因此可以先放读latch再加写latch
+    bool is_write = operation != Operation::FIND;
+    root_latch_.lock_shared();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    bool is_root = true;
+    node->page->rlatch();
+    if (is_write && node->is_leaf_page()) {
+        node->page->runlatch();
+        node->page->wlatch();
+    }
+    root_latch_.unlock_shared();
+
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(node->internal_lookup(key));
+        child->page->rlatch();
+        if (is_write && child->is_leaf_page()) {
+            child->page->runlatch();
+            child->page->wlatch();
+        }
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = child;
+        is_root = false;
+    }
+    if (!is_write) {
+        return std::make_pair(node, false);
+    }
 
-    // 函数用于查找指定键所在的叶子结点
-    
-    //获取根节点并标记为当前节点
-    IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
-	IxNodeHandle *current = root;
-
-    //如果当前节点不是叶节点(调用is_keaf_page())，则向下查找子树
-	while(!current->is_leaf_page()){ 
-        //将当前节点标记为双亲节点并向下查找，直到当前节点为叶节点
-		IxNodeHandle *parent = current;
-		current = fetch_node(current->internal_lookup(key));
-        //unpin page，之前的fetch_node会使parent被pin住
-		buffer_pool_manager_->unpin_page(parent->get_page_id(), false);
-	}
-    //找到包含key的叶子节点，返回叶子节点并修改find_first为true
-    return std::make_pair(current, true);//返回目标叶子结点
+    // 2. 叶结点对本次操作是安全的（不会分裂或合并），只需要叶结点的写latch
+    if (is_safe(node, key, operation, is_root)) {
+        transaction->append_index_latch_page_set(node->page);
+        return std::make_pair(node, false);
+    }
+    node->page->wunlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+
+    // 3. 悲观下降：持有root_latch_从根结点开始逐层加写latch，
+    //    一旦某个结点对本次操作是安全的，就释放它所有祖先结点的latch（以及root_latch_）
+    root_latch_.lock();
+    bool root_is_latched = true;
+    node = fetch_node(file_hdr_->root_page_);
+    node->page->wlatch();
+    if (is_safe(node, key, operation, true)) {
+        release_latches(transaction, &root_is_latched, false);
+    }
+    transaction->append_index_latch_page_set(node->page);
+
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(node->internal_lookup(key));
+        child->page->wlatch();
+        if (is_safe(child, key, operation, false)) {
+            release_latches(transaction, &root_is_latched, false);
+        }
+        transaction->append_index_latch_page_set(child->page);
+        delete node;
+        node = child;
+    }
+    return std::make_pair(node, root_is_latched);
+}
+
+/**
+ * @brief 判断结点对于本次操作是否安全，即操作完成后该结点的祖先结点不需要被修改
+ * INSERT：插入一个键值对后不会分裂
+ * DELETE：删除一个键值对后不会低于最小大小，并且结点的第一个key不会改变（否则需要更新父结点中对应的key）
+ *
+ * @param is_root 结点是否为根结点，由下降的过程决定，不读取结点的parent字段（其他线程分裂父结点时可能正在修改它）
+ * @note INSERT只考虑分裂，不考虑第一个key是否改变：插入到第0个位置时父结点中的key会过时（见find_leaf_page()），
+ * 这只影响内部结点的第0个key，查找不依赖它；DELETE删除第一个key时仍然需要更新父结点
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, const char *key, Operation operation, bool is_root) {
+    if (operation == Operation::FIND) {
+        return true;
+    }
+    if (operation == Operation::INSERT) {
+        return node->get_size() + 1 < node->get_max_size();
+    }
+    // 根结点没有父结点，只需要考虑adjust_root()：内部结点剩下一个孩子；叶结点被删空时仍然保留为根结点
+    if (is_root) {
+        return node->is_leaf_page() || node->get_size() > 2;
+    }
+    if (node->get_size() <= node->get_min_size()) {
+        return false;
+    }
+    int pos = node->is_leaf_page() ? node->lower_bound(key) : node->upper_bound(key) - 1;
+    return pos > 0;
+}
+
+/**
+ * @brief 释放事务在index_latch_page_set中记录的所有页面的写latch并unpin，如果持有root_latch_也一并释放
+ *
+ * @param root_is_latched 传入传出参数：root_latch_是否被当前操作持有
+ * @param is_dirty 页面是否被修改过
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, bool *root_is_latched, bool is_dirty) {
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+    auto latch_page_set = transaction->get_index_latch_page_set();
+    for (Page *page : *latch_page_set) {
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty);
+    }
+    latch_page_set->clear();
 }
 
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
  *
  * @param key 查找的目标key值
- * @param result 用于存放结果的容器
+ * @param result 用于存放结果的容器，key对应的所有rid按从小到大的顺序追加到末尾
  * @param transaction 事务指针
  * @return bool 返回目标键值对是否存在
+ * @note 非唯一索引中同一个key的键值对按rid排列在一起，可能跨越多个叶结点：(key, IX_MIN_RID)和(key, IX_MAX_RID)之间的都是；
+ * 唯一索引忽略rid，范围只包含key本身
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
     // Todo:
@@ -339,21 +554,72 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
 
     // 函数用于查找指定键在叶子结点中的对应的值
+    char lower[IX_MAX_KEY_LEN], upper[IX_MAX_KEY_LEN];
+    to_index_key(key, IX_MIN_RID, lower);
+    to_index_key(key, IX_MAX_RID, upper);
+    size_t num_rids = result->size();
+    IxNodeHandle *leaf = find_leaf_page(lower, Operation::FIND, transaction).first;
+    char last[IX_MAX_KEY_LEN];
+    bool more = read_range(leaf, lower, false, upper, result, last);
+    page_id_t leaf_no = leaf->get_page_no(), next_leaf = leaf->get_next_leaf();
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    if (more) {
+        read_next_leaves(last, upper, leaf_no, next_leaf, result, transaction);
+    }
+    return result->size() > num_rids;
+}
 
-    // 调用 find_leaf_page 函数找到包含key的叶子结点
-    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
-    Rid *rid = nullptr;
-    // 在叶子结点中查找目标键的位置
-    if (leaf->leaf_lookup(key, &rid)) {
-        // 把rid存入result参数中（处理重复键情况，以便返回所有与key关联的记录）
-        result->push_back(*rid);
-        //返回bool值，表示目标键值对是否存在
-        return true;
+/**
+ * @brief 在加了读latch的叶结点中读取key在[lower, upper]范围内的rid（exclusive为true时不包括lower）
+ *
+ * @param last 传出参数：范围延伸到叶结点末尾时，写入叶结点的最后一个key，可以与lower相同
+ * @return bool 范围是否可能在下一个叶结点中继续
+ */
+bool IxIndexHandle::read_range(IxNodeHandle *leaf, const char *lower, bool exclusive, const char *upper,
+                               std::vector<Rid> *result, char *last) const {
+    int begin = exclusive ? leaf->upper_bound(lower) : leaf->lower_bound(lower);
+    int end = leaf->upper_bound(upper);
+    for (int i = begin; i < end; i++) {
+        result->push_back(*leaf->get_rid(i));
+    }
+    if (end < leaf->get_size() || leaf->get_size() == 0 || leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+        return false;
     }
+    memcpy(last, leaf->get_key(leaf->get_size() - 1), file_hdr_->col_tot_len_);
+    return true;
+}
 
-    // 使用buffer_pool_manager_ 的 unpin_page 函数，解除对叶子结点的固定
-    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
-    return false;
+/**
+ * @brief read_range()读到叶结点leaf_no的末尾之后，从它的下一个叶结点next_leaf开始，继续读取key在(last, upper]范围内的rid
+ *
+ * @param last leaf_no的最后一个key
+ * @note 一次只持有一个叶结点的读latch：不能在持有leaf_no的latch时给next_leaf加latch，
+ * 因为合并结点时会在持有右边结点写latch的情况下给左边结点加latch。
+ * 释放leaf_no之后next_leaf可能被合并回收，或者它们之间分裂出了新的叶结点，这时以last从根结点重新下降
+ */
+void IxIndexHandle::read_next_leaves(const char *last, const char *upper, page_id_t leaf_no, page_id_t next_leaf,
+                                     std::vector<Rid> *result, Transaction *transaction) {
+    char lower[IX_MAX_KEY_LEN];
+    memcpy(lower, last, file_hdr_->col_tot_len_);
+    bool more = true;
+    while (more) {
+        IxNodeHandle *leaf = fetch_node(next_leaf);
+        leaf->page->rlatch();
+        if (!leaf->is_leaf_page() || leaf->get_prev_leaf() != leaf_no || leaf->get_size() == 0) {
+            leaf->page->runlatch();
+            buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+            delete leaf;
+            leaf = find_leaf_page(lower, Operation::FIND, transaction).first;
+        }
+        more = read_range(leaf, lower, true, upper, result, lower);
+        leaf_no = leaf->get_page_no();
+        next_leaf = leaf->get_next_leaf();
+        leaf->page->runlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
 }
 
 /**
@@ -378,6 +644,11 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
 	new_node->page_hdr->is_leaf = node->page_hdr->is_leaf;
 	new_node->page_hdr->parent = node->get_parent_page_no();
 	new_node->page_hdr->next_free_page_no = node->page_hdr->next_free_page_no;
+    new_node->page_hdr->prefix_len = 0;
+    // new_node的key都来自node，可以沿用node的公共前缀
+    if (file_hdr_->normalized_) {
+        new_node->set_prefix(node->get_prefix(), node->get_prefix_len());
+    }
     
     //2.1如果是叶节点，则将新旧结点的指针由node->next_node更新为node->new_node->next_node
 	if(new_node->is_leaf_page()) { 
@@ -386,16 +657,20 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
         node->page_hdr->next_leaf = new_node->get_page_no();//设置旧node的next_leaf指向new_node
 		
 		IxNodeHandle* next_node = fetch_node(new_node->page_hdr->next_leaf);//获取next_node
+        //next_node可能在别的父结点下，没有被当前操作latch；向右加latch不会与其他操作形成环路等待
+        next_node->page->wlatch();
         next_node->page_hdr->prev_leaf = new_node->get_page_no();//将next_node的prev_leaf指向new_node
+        next_node->page->wunlatch();
         
         //unpin
 		buffer_pool_manager_->unpin_page(next_node->get_page_id(), true);
+		delete next_node;
 	}
 
 	//1.2、2.2将原结点的键值对平均分配，为新节点分配键值对并更新旧结点的键值对数记录
 	int pos = node->page_hdr->num_key / 2;//已经插入的键值对数量/2即为平均分配的位置pos
     int n = node->get_size() - pos;
-	new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), n);//将后半部分连续键值对插入new_node
+	new_node->insert_pairs_from(0, node, pos, n);//将后半部分连续键值对插入new_node
 	node->page_hdr->num_key = pos;
     //3.如果新的右兄弟结点不是叶子结点，用maintain_child()更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
     for(int i = 0; i < n; ++i) maintain_child(new_node, i);
@@ -435,6 +710,7 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
 		new_root->page_hdr->is_leaf = 0;
 		new_root->page_hdr->parent = INVALID_PAGE_ID;
 		new_root->page_hdr->next_free_page_no = IX_NO_PAGE;
+		new_root->page_hdr->prefix_len = 0;
         
         //2、3.获取old_node并将(key,rid)插入父亲节点
 		new_root->insert_pair(0, old_node->get_key(0), (Rid){old_node->get_page_no(), -1});
@@ -444,19 +720,29 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
 		file_hdr_->root_page_ = new_root_page;
 		new_node->page_hdr->parent = new_root_page;
 		old_node->page_hdr->parent = new_root_page;
+		buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
+		delete new_root;
 	}
 	else{//4.非根节点情况，需向上递归判断父节点是否需要split
+		//old_node需要分裂，下降时不安全，因此父结点的写latch仍被当前操作持有
 		IxNodeHandle* parent_node = fetch_node(old_node->get_parent_page_no());
 		int rid_idx = parent_node->find_child(old_node);
 		parent_node->insert_pair(rid_idx + 1, key, (Rid){new_node->get_page_id().page_no, -1});
+		//规范化格式下，分裂得到的两个结点的key范围变窄，它们的公共前缀可能变长
+		if (file_hdr_->normalized_) {
+			grow_prefix(parent_node, rid_idx, old_node);
+			grow_prefix(parent_node, rid_idx + 1, new_node);
+		}
 
 		if(parent_node->get_size() == parent_node->get_max_size()){
 			IxNodeHandle* new_parent = split(parent_node);
 			insert_into_parent(parent_node, new_parent->get_key(0), new_parent, transaction);
 			buffer_pool_manager_->unpin_page(new_parent->get_page_id(), true);
+			delete new_parent;
 		}
         //unpin
 		buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
+		delete parent_node;
 	}
 }
 
@@ -475,15 +761,32 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
 
     // 函数用于将指定的键值对插入到B+树中
 
-    // 上锁，确保同一时刻只有一个线程能够对树根节点执行相关操作
-    std::scoped_lock lock{root_latch_};
+    // 没有事务的调用者使用临时事务记录加了latch的页面
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    char key_buf[IX_MAX_KEY_LEN];
+    key = to_index_key(key, value, key_buf);
+
+    //1.查找key值要插入的叶子节点，叶子节点以及可能被修改的祖先节点都加了写latch
+	auto [leaf, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+	return insert_into_leaf(leaf, key, value, transaction, &root_is_latched);
+}
 
-    //1.查找key值要插入的叶子节点
-	IxNodeHandle *leaf = find_leaf_page(key, Operation::INSERT, transaction).first;
+/**
+ * @brief 把键值对插入find_leaf_page()找到的叶结点，必要时分裂，最后释放所有latch
+ *
+ * @param key 索引中存储格式的key
+ * @return bool 是否插入成功（唯一索引中key已经存在、非唯一索引中同一个(key, rid)已经存在时不插入）
+ */
+bool IxIndexHandle::insert_into_leaf(IxNodeHandle *leaf, const char *key, const Rid &value, Transaction *transaction,
+                                     bool *root_is_latched) {
     //2.调用insert()插入键值对，若插入后如果与叶子节点未插入前的键值对数量一致，则未成功插入，直接返回false
 	int cur_size = leaf->get_size();   
 	if(leaf->insert(key,value) == cur_size){
-		buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+		release_latches(transaction, root_is_latched, false);
+		delete leaf;
 		return false;
 	}
     //3.如果结点已满，则调用split()分裂节点
@@ -496,18 +799,21 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
 		insert_into_parent(leaf, new_node->get_key(0), new_node, transaction);
         //unpin page，注意被unpin的该页应该被标记为脏页
 		buffer_pool_manager_->unpin_page(new_node->get_page_id(), true);
+		delete new_node;
 	}
-    //unpin page
-	buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    //释放latch并unpin page
+	release_latches(transaction, root_is_latched, true);
+	delete leaf;
 	return true;
 }
 
 /**
- * @brief 用于删除B+树中含有指定key的键值对
+ * @brief 用于删除B+树中的键值对(key, value)
  * @param key 要删除的key值
+ * @param value 要删除的rid，同一个key的其他rid不受影响
  * @param transaction 事务指针
  */
-bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+bool IxIndexHandle::delete_entry(const char *key, const Rid &value, Transaction *transaction) {
     // Todo:
     // 1. 获取该键值对所在的叶子结点
     // 2. 在该叶子结点中删除键值对
@@ -520,27 +826,221 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     调用coalesce_or_redistribute来处理叶节点可能出现的不足情况
     */
 
-    // 上锁，确保同一时刻只有一个线程能够对树根节点执行相关操作
-    std::scoped_lock lock{root_latch_};
-    // 使用find_leaf_page找到包含键的叶节点
-    IxNodeHandle *leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
-    // 使用remove从叶节点中删除键
+    // 没有事务的调用者使用临时事务记录加了latch的页面
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    char key_buf[IX_MAX_KEY_LEN];
+    key = to_index_key(key, value, key_buf);
+
+    // 使用find_leaf_page找到包含键的叶节点，叶节点以及可能被修改的祖先节点都加了写latch
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    return delete_from_leaf(leaf, key, value, transaction, &root_is_latched);
+}
+
+/**
+ * @brief 用于删除B+树中含有指定key的所有键值对
+ * @return bool 是否删除了键值对
+ */
+bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    std::vector<Rid> rids;
+    get_value(key, &rids, transaction);
+    bool deleted = false;
+    for (auto &rid : rids) {
+        deleted |= delete_entry(key, rid, transaction);
+    }
+    return deleted;
+}
+
+/**
+ * @brief 从find_leaf_page()找到的叶结点中删除键值对(key, value)，必要时合并或重分配，最后释放所有latch
+ *
+ * @param key 索引中存储格式的key
+ * @return bool 是否删除成功（键值对不存在时返回false）
+ */
+bool IxIndexHandle::delete_from_leaf(IxNodeHandle *leaf, const char *key, const Rid &value, Transaction *transaction,
+                                     bool *root_is_latched) {
+    // 使用remove从叶节点中删除键值对
     int originSize = leaf->get_size();
-    int nowSize = leaf->remove(key);
-    bool *isLatched = new bool(true);
-    // 检查删除是否导致叶节点的键数少于所需的数量
-    // 删除成功，调用coalesce_or_redistribute并更新事务的删除页面集
-    if (originSize > nowSize) {
-        if (coalesce_or_redistribute(leaf, transaction, isLatched)) {
-            // 需要删除叶子结点，将叶子结点的页面ID（leaf->page）添加到事务的delete_page_set中
-            transaction->append_index_deleted_page(leaf->page);
-        }
-        buffer_pool_manager_->unpin_page(leaf->get_page_id(), true);
+    int nowSize = leaf->remove(key, value);
+    // 只有叶节点在下降时不安全（仍持有父节点或root_latch_）才可能需要合并、重分配或更新父节点的key
+    if (originSize > nowSize && (*root_is_latched || transaction->get_index_latch_page_set()->size() > 1)) {
+        coalesce_or_redistribute(leaf, transaction, root_is_latched);
+    }
+    release_latches(transaction, root_is_latched, originSize > nowSize);
+    // 被删除的结点在释放latch之后不会再被访问，回收到空闲页面链表中
+    auto deleted_page_set = transaction->get_index_deleted_page_set();
+    for (page_id_t page_no : *deleted_page_set) {
+        release_node_handle(page_no);
+    }
+    deleted_page_set->clear();
+    delete leaf;
+    return originSize > nowSize;
+}
+
+/**
+ * @brief 把一批key和rid转换为索引中存储的格式，并按key排序
+ *
+ * @param values 与keys一一对应的rid；为nullptr时使用IX_MIN_RID，得到每个key的第一个键值对的下界
+ * @param index_keys 传出参数：与keys一一对应的存储格式的key，指向buf
+ * @param buf 存放转换后的key
+ * @return std::vector<size_t> 按key从小到大排列的下标
+ */
+std::vector<size_t> IxIndexHandle::sort_batch(const std::vector<const char *> &keys, const std::vector<Rid> *values,
+                                              std::vector<const char *> *index_keys, std::vector<char> *buf) const {
+    int key_len = file_hdr_->col_tot_len_;
+    buf->resize(keys.size() * key_len);
+    index_keys->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        const Rid &rid = values == nullptr ? IX_MIN_RID : (*values)[i];
+        (*index_keys)[i] = to_index_key(keys[i], rid, buf->data() + i * key_len);
+    }
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return ix_compare((*index_keys)[a], (*index_keys)[b], file_hdr_) < 0;
+    });
+    return order;
+}
+
+/**
+ * @brief 比上一个key大的key是否仍然落在这个叶结点的范围内：不超过叶结点的最后一个key，或者是最右边的叶结点
+ * @note 大于最后一个key、小于下一个叶结点第一个key的key可能属于下一个叶结点（规范化格式下父结点中的key只是下界），
+ * 这时需要重新从根结点下降
+ */
+bool IxIndexHandle::in_leaf(IxNodeHandle *leaf, const char *key) const {
+    if (leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
         return true;
     }
+    return leaf->get_size() > 0 && ix_compare(key, leaf->get_key(leaf->get_size() - 1), file_hdr_) <= 0;
+}
 
-    // 删除失败
-    return false;
+/**
+ * @brief 批量查找，结果与对每个key调用get_value()相同
+ *
+ * @param result 传出参数：与keys一一对应，每个key的所有rid，key不存在时为空
+ * @return size_t 存在的key的数量
+ * @note 按key的顺序访问叶结点，一次只持有一个叶结点的读latch
+ */
+size_t IxIndexHandle::get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *result,
+                                 Transaction *transaction) {
+    std::vector<const char *> index_keys;
+    std::vector<char> buf;
+    std::vector<size_t> order = sort_batch(keys, nullptr, &index_keys, &buf);
+    result->assign(keys.size(), std::vector<Rid>());
+
+    size_t num_found = 0;
+    char upper[IX_MAX_KEY_LEN], last[IX_MAX_KEY_LEN];
+    for (size_t i = 0; i < order.size();) {
+        IxNodeHandle *leaf = find_leaf_page(index_keys[order[i]], Operation::FIND, transaction).first;
+        // 同一个叶结点范围内的key不再从根结点下降
+        bool more = false;
+        page_id_t leaf_no = leaf->get_page_no(), next_leaf = leaf->get_next_leaf();
+        do {
+            std::vector<Rid> &rids = (*result)[order[i]];
+            to_index_key(keys[order[i]], IX_MAX_RID, upper);
+            more = read_range(leaf, index_keys[order[i]], false, upper, &rids, last);
+            if (!more) {
+                num_found += !rids.empty();
+                i++;
+            }
+        } while (!more && i < order.size() && in_leaf(leaf, index_keys[order[i]]));
+        leaf->page->runlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+        // key的键值对延续到之后的叶结点，读完这个key之后再从下一个key所在的叶结点开始
+        if (more) {
+            std::vector<Rid> &rids = (*result)[order[i]];
+            read_next_leaves(last, upper, leaf_no, next_leaf, &rids, transaction);
+            num_found += !rids.empty();
+            i++;
+        }
+    }
+    return num_found;
+}
+
+/**
+ * @brief 批量插入，结果与按key的顺序逐个调用insert_entry()相同
+ *
+ * @param values 与keys一一对应的rid
+ * @return size_t 插入成功的键值对数量
+ * @note 下降到的叶结点对第一个key安全（只持有叶结点的写latch）时，继续在这个叶结点上插入后面落在它范围内的key，
+ * 直到叶结点再插入一个就需要分裂；不安全时按单个key的方式插入（分裂并修改祖先结点）
+ */
+size_t IxIndexHandle::insert_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values,
+                                     Transaction *transaction) {
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    std::vector<const char *> index_keys;
+    std::vector<char> buf;
+    std::vector<size_t> order = sort_batch(keys, &values, &index_keys, &buf);
+
+    size_t num_inserted = 0;
+    for (size_t i = 0; i < order.size();) {
+        auto [leaf, root_is_latched] = find_leaf_page(index_keys[order[i]], Operation::INSERT, transaction);
+        if (root_is_latched || transaction->get_index_latch_page_set()->size() > 1) {
+            num_inserted += insert_into_leaf(leaf, index_keys[order[i]], values[order[i]], transaction, &root_is_latched);
+            i++;
+            continue;
+        }
+        bool is_dirty = false;
+        do {
+            int cur_size = leaf->get_size();
+            if (leaf->insert(index_keys[order[i]], values[order[i]]) > cur_size) {
+                num_inserted++;
+                is_dirty = true;
+            }
+            i++;
+        } while (i < order.size() && leaf->get_size() + 1 < leaf->get_max_size() && in_leaf(leaf, index_keys[order[i]]));
+        release_latches(transaction, &root_is_latched, is_dirty);
+        delete leaf;
+    }
+    return num_inserted;
+}
+
+/**
+ * @brief 批量删除，结果与按key的顺序逐个调用delete_entry()相同
+ *
+ * @param values 与keys一一对应的rid
+ * @return size_t 删除成功的键值对数量
+ * @note 与insert_entries()相同，叶结点上继续删除的key需要对叶结点安全（删除后不会低于最小大小，也不是第一个key）
+ */
+size_t IxIndexHandle::delete_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values,
+                                     Transaction *transaction) {
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    std::vector<const char *> index_keys;
+    std::vector<char> buf;
+    std::vector<size_t> order = sort_batch(keys, &values, &index_keys, &buf);
+
+    size_t num_deleted = 0;
+    for (size_t i = 0; i < order.size();) {
+        auto [leaf, root_is_latched] = find_leaf_page(index_keys[order[i]], Operation::DELETE, transaction);
+        if (root_is_latched || transaction->get_index_latch_page_set()->size() > 1) {
+            num_deleted += delete_from_leaf(leaf, index_keys[order[i]], values[order[i]], transaction, &root_is_latched);
+            i++;
+            continue;
+        }
+        bool is_dirty = false;
+        do {
+            int cur_size = leaf->get_size();
+            if (leaf->remove(index_keys[order[i]], values[order[i]]) < cur_size) {
+                num_deleted++;
+                is_dirty = true;
+            }
+            i++;
+            // 叶结点是否为根结点未知时按非根结点判断，只会更早地回到从根结点下降
+        } while (i < order.size() && in_leaf(leaf, index_keys[order[i]]) &&
+                 is_safe(leaf, index_keys[order[i]], Operation::DELETE, false));
+        release_latches(transaction, &root_is_latched, is_dirty);
+        delete leaf;
+    }
+    return num_deleted;
 }
 
 /**
@@ -572,40 +1072,53 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
     */
 
     // 判断node节点是否为根节点
-    if(node->is_root_page())
-        //1.1如果是root，调用adjust_root()
-		return adjust_root(node);
-    //1.2如果不是root，则维持原判！(返回false)
+    if(node->is_root_page()) {
+        //1.1如果是root，调用adjust_root()，根节点被删除时记录到事务的delete_page_set中
+		if(adjust_root(node)) {
+			transaction->append_index_deleted_page(node->get_page_no());
+			return true;
+		}
+		return false;
+	}
+    //1.2如果不是root，先更新祖先结点的key：node是第一个孩子时，删除第一个key后redistribute和coalesce都不会更新parent的第0个key
+    //规范化格式下parent中的key只是孩子结点key的下界，不需要更新；提高下界会扩大左兄弟的key范围，使它的公共前缀失效
+	if (!file_hdr_->normalized_) {
+		maintain_parent(node, transaction);
+	}
 	if(node->get_size() >= node->get_min_size()) {
-		maintain_parent(node);
 		return false;
 	}
     //2、3.1获取node的父亲节点和兄弟节点，调用fetch_node()，但是先初始化指向兄弟节点指针为空
+    //node不安全，父节点的写latch仍被当前操作持有；兄弟节点需要加写latch
 	IxNodeHandle *parent_node = fetch_node(node->get_parent_page_no()); 		
 	IxNodeHandle *brother_node = nullptr;
     //3.2调用find_child()找到兄弟节点(优先前驱节点)
 	int pos = parent_node->find_child(node);
 	if(pos){
-		brother_node = fetch_node(node->get_prev_leaf());
+		brother_node = fetch_node(parent_node->value_at(pos - 1));
 	}
 	else{
-		brother_node = fetch_node(node->get_next_leaf());
+		brother_node = fetch_node(parent_node->value_at(pos + 1));
 	}
+	Page *brother_page = brother_node->page;
+	brother_page->wlatch();
     //4.如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >= NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-	//记得unpin
+	//记得unpin；coalesce会交换两个结点指针，因此按页面释放兄弟节点
+	bool node_deleted = false;
 	if(node->get_size() + brother_node->get_size() >= node->get_min_size() * 2){
 		redistribute(brother_node, node, parent_node, pos);
-		buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
-    	buffer_pool_manager_->unpin_page(brother_node->get_page_id(), true);
-		return false;
 	}
 	else{//5.上述条件都不满足，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
-    //依然要记得unpin
-	    coalesce(&brother_node, &node, &parent_node, pos, transaction, root_is_latched);
-		buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
-    	buffer_pool_manager_->unpin_page(brother_node->get_page_id(), true);
-        return true;
+		IxNodeHandle *left = brother_node, *right = node;
+	    coalesce(&left, &right, &parent_node, pos, transaction, root_is_latched);
+		node_deleted = true;
 	}
+	brother_page->wunlatch();
+	buffer_pool_manager_->unpin_page(brother_page->get_page_id(), true);
+	buffer_pool_manager_->unpin_page(parent_node->get_page_id(), true);
+	delete brother_node;
+	delete parent_node;
+	return node_deleted;
 }
 
 /**
@@ -626,22 +1139,20 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
     */
 
     // 如果old_root_node是具有一个子节点的内部节点，则更新根节点
+    // 根节点不安全，root_latch_和唯一的孩子节点（合并后剩下的节点）的写latch都被当前操作持有
     if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
         IxNodeHandle *child = fetch_node(old_root_node->get_rid(0)->page_no);
+        // 剩下的孩子是最左边的结点，key没有下界，不会有公共前缀
+        assert(child->get_prefix_len() == 0);
         child->set_parent_page_no(INVALID_PAGE_ID);
         update_root_page_no(child->get_page_no());
-        // 删除node时，更新file_handle的num_pages
-        release_node_handle(*child);
-        return true;
-    }
-    // 如果old_root_node是一个没有键的叶节点，则将根节点更新为INVALID_PAGE_ID
-    else if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {
-        update_root_page_no(INVALID_PAGE_ID);
-        // 删除node时，更新file_handle的num_pages
-        release_node_handle(*fetch_node(old_root_node->get_page_no()));
-       // 如果删除了根节点，则返回true
+        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
+        // 原根结点由coalesce_or_redistribute()记录到事务的delete_page_set中，释放latch之后再回收
         return true;
     }
+    // 如果old_root_node是一个没有键的叶节点，仍然保留它作为根结点（与新建索引时的状态相同），
+    // 这样之后的查找和插入不需要处理没有根结点的情况
     return false;
 }
 
@@ -671,6 +1182,8 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
     根据节点和键的位置处理各种情况
     */
 
+    // node的key范围扩大到包含移入的键值对，先缩短它的公共前缀
+    shrink_prefix(node, neighbor_node);
     // 确定neighbor_node是node的前驱还是后继
     if (index) { // node不是第一个节点，neighbor是node的前驱节点
         // neighbor是node的前驱，移动neighbor的最后一个节点到node中
@@ -728,7 +1241,8 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
 	}
 	int before_num = (*neighbor_node)->get_size();//neighbor的键值对数量
     //2.将所有node节点的键值对移动到neighbor，然后调用maintain_child更新parent信息
-    (*neighbor_node)->insert_pairs(before_num, (*node)->get_key(0), (*node)->get_rid(0), (*node)->get_size());
+    shrink_prefix(*neighbor_node, *node);
+    (*neighbor_node)->insert_pairs_from(before_num, *node, 0, (*node)->get_size());
     int after_num = (*neighbor_node)->get_size();//插入完成之后的键值对数量
     for(int i = before_num; i < after_num; ++i)
         maintain_child(*neighbor_node, i);
@@ -737,14 +1251,16 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
         file_hdr_->last_leaf_ = (*neighbor_node)->get_page_no();
 
     //删除叶节点
-    erase_leaf(*node);
-    release_node_handle(**node);
+    if((*node)->is_leaf_page())
+        erase_leaf(*node);
+    // node仍被当前操作持有写latch，释放latch之后再回收到空闲页面链表中
+    transaction->append_index_deleted_page((*node)->get_page_no());
 
     //删除node节点在parent中的键值对信息
     (*parent)->erase_pair(index);
 
     //返回值调用c_o_r确定parent是否需要被删除
-    return coalesce_or_redistribute(*parent, transaction);
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
 }
 
 /**
@@ -758,11 +1274,50 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->rlatch();
     if (iid.slot_no >= node->get_size()) {
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
         throw IndexEntryNotFoundError();
     }
+    Rid rid = *node->get_rid(iid.slot_no);
+    node->page->runlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    delete node;
+    return rid;
+}
+
+/**
+ * @brief 读取iid位置的键值对，key还原为上层使用的原始格式写入key
+ *
+ * @param iid
+ * @param key 长度为rid_offset()（索引字段的总长度）的缓冲区
+ * @return Rid
+ * @note 与get_rid()只访问一次叶结点，用于只读索引就能得到结果的扫描
+ */
+Rid IxIndexHandle::get_entry(const Iid &iid, char *key) const {
+    IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->rlatch();
+    if (iid.slot_no >= node->get_size()) {
+        node->page->runlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        throw IndexEntryNotFoundError();
+    }
+    // 只返回索引字段，不包括key末尾的rid
+    if (file_hdr_->normalized_) {
+        char key_buf[IX_MAX_KEY_LEN];
+        ix_denormalize_key(node->get_key(iid.slot_no), key_buf, file_hdr_->col_types_, file_hdr_->col_lens_);
+        memcpy(key, key_buf, file_hdr_->rid_offset());
+    } else {
+        memcpy(key, node->get_key(iid.slot_no), file_hdr_->rid_offset());
+    }
+    Rid rid = *node->get_rid(iid.slot_no);
+    node->page->runlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+    return rid;
 }
 
 /**
@@ -774,17 +1329,25 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    std::scoped_lock lock{root_latch_};
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
+    // key的第一个键值对不小于(key, IX_MIN_RID)
+    char key_buf[IX_MAX_KEY_LEN];
+    key = to_index_key(key, IX_MIN_RID, key_buf);
+    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr).first;
     int key_idx = node->lower_bound(key);
-    Iid iid;
-    if (key_idx == node->get_size()) {
-        iid = leaf_end();
-    } else {
-        iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
+    // key大于叶结点中所有的key：不是最后一个叶结点时，结果是下一个叶结点的第一个键值对
+    bool past_end = key_idx == node->get_size();
+    if (past_end && node->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = node->get_next_leaf(), .slot_no = 0};
+        past_end = false;
     }
+    node->page->runlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+    // leaf_end()会给最后一个叶结点加读latch，需要先释放当前叶结点
+    if (past_end) {
+        iid = leaf_end();
+    }
     return iid;
 }
 
@@ -795,17 +1358,25 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    std::scoped_lock lock{root_latch_};
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr, true).first;
+    // key的最后一个键值对不大于(key, IX_MAX_RID)
+    char key_buf[IX_MAX_KEY_LEN];
+    key = to_index_key(key, IX_MAX_RID, key_buf);
+    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, nullptr).first;
     int key_idx = node->upper_bound(key);
-    Iid iid;
-    if (key_idx == node->get_size()) {
-        iid = leaf_end();
-    } else {
-        iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = key_idx};
+    // key大于叶结点中所有的key：不是最后一个叶结点时，结果是下一个叶结点的第一个键值对
+    bool past_end = key_idx == node->get_size();
+    if (past_end && node->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = node->get_next_leaf(), .slot_no = 0};
+        past_end = false;
     }
+    node->page->runlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+    // leaf_end()会给最后一个叶结点加读latch，需要先释放当前叶结点
+    if (past_end) {
+        iid = leaf_end();
+    }
     return iid;
 }
 
@@ -817,8 +1388,11 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  */
 Iid IxIndexHandle::leaf_end() const {
     IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
+    node->page->rlatch();
+    Iid iid = {.page_no = node->get_page_no(), .slot_no = node->get_size()};
+    node->page->runlatch();
     buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    delete node;
     return iid;
 }
 
@@ -853,42 +1427,64 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  * @return IxNodeHandle*
  * @note pin the page, remember to unpin it outside!
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
- * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
- * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
+ * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE，各个空闲页面通过next_free_page_no串成链表
+ * 空闲页面链表不为空时优先复用链表头的页面，否则在文件末尾分配新页面
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
 IxNodeHandle *IxIndexHandle::create_node() {
-    IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    Page *page = nullptr;
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+            page = buffer_pool_manager_->fetch_page(PageId{fd_, file_hdr_->first_free_page_no_});
+            file_hdr_->first_free_page_no_ = reinterpret_cast<IxPageHdr *>(page->get_data())->next_free_page_no;
+        } else {
+            file_hdr_->num_pages_++;
+        }
+    }
 
-    PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
-    // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
-    Page *page = buffer_pool_manager_->new_page(&new_page_id);
-    node = new IxNodeHandle(file_hdr_, page);
-    return node;
+    if (page != nullptr) {
+        // 与new_page()返回的页面一样清空内容；页面一定会被调用者修改，unpin时标记为脏页
+        memset(page->get_data(), 0, PAGE_SIZE);
+    } else {
+        PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+        // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
+        page = buffer_pool_manager_->new_page(&new_page_id);
+    }
+    return new IxNodeHandle(file_hdr_, page);
 }
 
 /**
  * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
+ * 只会更新仍被当前操作加了写latch的祖先节点：没有被latch的祖先节点说明下降时它的孩子节点是安全的，第一个key不会变化
  *
  * @param node
+ * @param transaction 事务指针，index_latch_page_set的第一个页面是当前操作持有写latch的最上层节点
  */
-void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
+void IxIndexHandle::maintain_parent(IxNodeHandle *node, Transaction *transaction) {
+    Page *top_page = transaction->get_index_latch_page_set()->front();
     IxNodeHandle *curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
+    while (curr->page != top_page && curr->get_parent_page_no() != IX_NO_PAGE) {
         // Load its parent
         IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
         int rank = parent->find_child(curr);
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
+        bool unchanged = memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0;
+        if (!unchanged) {
+            memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
+        }
+        if (curr != node) {
+            delete curr;
         }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
         curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        buffer_pool_manager_->unpin_page(parent->get_page_id(), !unchanged);
+        if (unchanged) {
+            break;
+        }
+    }
+    if (curr != node) {
+        delete curr;
     }
 }
 
@@ -896,6 +1492,7 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
  *
  * @param leaf 要删除的leaf
+ * @note 前驱结点是合并的目标结点，已被当前操作latch；后继结点可能在别的父结点下，需要加写latch
  */
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
@@ -903,19 +1500,30 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    next->page->wlatch();
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next->page->wunlatch();
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 把被删除的结点放到空闲页面链表的头部，之后create_node()时复用
  *
- * @param node
+ * @param page_no 被删除结点的页号
+ * @note 调用时不能再持有该结点的latch，也不能再有其他结点指向它；file_hdr_.num_pages不变，仍是文件中页面的数量
  */
-void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    file_hdr_->num_pages_--;
+void IxIndexHandle::release_node_handle(page_id_t page_no) {
+    std::scoped_lock lock{file_hdr_latch_};
+    IxNodeHandle *node = fetch_node(page_no);
+    node->page_hdr->next_free_page_no = file_hdr_->first_free_page_no_;
+    node->page_hdr->num_key = 0;
+    file_hdr_->first_free_page_no_ = page_no;
+    buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+    delete node;
 }
 
 /**
@@ -925,8 +1533,42 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
     if (!node->is_leaf_page()) {
         //  Current node is inner node, load its child and set its parent to current node
         int child_page_no = node->value_at(child_idx);
+        // 孩子结点可能被其他安全的操作latch住，但它们不会读写孩子结点的parent字段，因此这里不加latch
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
+    }
+}
+
+/**
+ * @brief 规范化格式下，孩子结点的key都在parent中它对应的key和下一个key之间，这两个key的公共前缀也是孩子结点所有key的公共前缀
+ * 第一个孩子的key没有可靠的下界，最后一个孩子的key没有上界，它们的公共前缀不变
+ *
+ * @param rank child在parent中的rid_idx
+ */
+void IxIndexHandle::grow_prefix(IxNodeHandle *parent, int rank, IxNodeHandle *child) {
+    if (rank == 0 || rank + 1 >= parent->get_size()) {
+        return;
+    }
+    char lower[IX_MAX_KEY_LEN];
+    memcpy(lower, parent->get_key(rank), file_hdr_->col_tot_len_);
+    int prefix_len = ix_common_prefix(lower, parent->get_key(rank + 1), file_hdr_->col_tot_len_);
+    if (prefix_len > child->get_prefix_len()) {
+        child->set_prefix(lower, prefix_len);
+    }
+}
+
+/**
+ * @brief node要接收相邻结点neighbor_node的键值对之前调用，把node的公共前缀缩短为两个结点公共前缀中较短的一个
+ * @note 两个结点key范围的并集的公共前缀不会短于其中较短的一个；结点的大小低于最小大小，缩短前缀后一定放得下
+ */
+void IxIndexHandle::shrink_prefix(IxNodeHandle *node, IxNodeHandle *neighbor_node) {
+    if (!file_hdr_->normalized_) {
+        return;
+    }
+    int prefix_len = std::min(node->get_prefix_len(), neighbor_node->get_prefix_len());
+    if (prefix_len < node->get_prefix_len()) {
+        node->set_prefix(node->get_prefix(), prefix_len);
     }
 }
@@ -10,13 +10,14 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "ix_defs.h"
+#include "ix_node_search.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
-static const bool binary_search = false;
-
 inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
     switch (type) {
         case TYPE_INT: {
@@ -46,36 +47,137 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
+/**
+ * @description: 把key转换为规范化的格式，规范化的key之间直接用memcmp比较，结果与ix_compare()一致
+ * INT：大端序，并翻转符号位；FLOAT：正数翻转符号位，负数翻转所有位，再按大端序存放；STRING：保持不变
+ * @param {char*} dest 规范化的key，长度与原key相同
+ */
+inline void ix_normalize_key(const char *key, char *dest, const std::vector<ColType> &col_types,
+                             const std::vector<int> &col_lens) {
+    int offset = 0;
+    for (size_t i = 0; i < col_types.size(); ++i) {
+        if (col_types[i] == TYPE_STRING) {
+            memcpy(dest + offset, key + offset, col_lens[i]);
+        } else {
+            uint32_t bits;
+            if (col_types[i] == TYPE_INT) {
+                memcpy(&bits, key + offset, sizeof(uint32_t));
+                bits ^= 0x80000000u;
+            } else {
+                float f;
+                memcpy(&f, key + offset, sizeof(float));
+                f = f == 0.0f ? 0.0f : f;  // -0.0与0.0相等，规范化之后也要相等
+                memcpy(&bits, &f, sizeof(uint32_t));
+                bits = (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+            }
+            for (int j = 0; j < 4; ++j) {
+                dest[offset + j] = static_cast<char>(bits >> (24 - 8 * j));
+            }
+        }
+        offset += col_lens[i];
+    }
+}
+
+/**
+ * @description: ix_normalize_key()的逆变换，把规范化的key还原为原始格式
+ */
+inline void ix_denormalize_key(const char *key, char *dest, const std::vector<ColType> &col_types,
+                               const std::vector<int> &col_lens) {
+    int offset = 0;
+    for (size_t i = 0; i < col_types.size(); ++i) {
+        if (col_types[i] == TYPE_STRING) {
+            memcpy(dest + offset, key + offset, col_lens[i]);
+        } else {
+            uint32_t bits = 0;
+            for (int j = 0; j < 4; ++j) {
+                bits = (bits << 8) | static_cast<unsigned char>(key[offset + j]);
+            }
+            if (col_types[i] == TYPE_INT) {
+                bits ^= 0x80000000u;
+            } else {
+                bits = (bits & 0x80000000u) ? (bits ^ 0x80000000u) : ~bits;
+            }
+            memcpy(dest + offset, &bits, sizeof(uint32_t));
+        }
+        offset += col_lens[i];
+    }
+}
+
+// 比较两个以索引中存储的格式表示的key
+inline int ix_compare(const char *a, const char *b, const IxFileHdr *file_hdr) {
+    if (file_hdr->normalized_) {
+        return memcmp(a, b, file_hdr->col_tot_len_);
+    }
+    return ix_compare(a, b, file_hdr->col_types_, file_hdr->col_lens_);
+}
+
+// 两个key的公共前缀长度
+inline int ix_common_prefix(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
 /* 管理B+树中的每个节点 */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
+    friend class IxBulkLoader;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+    // page->data的其余部分：
+    // 原始格式：keys（长度为file_hdr->keys_size，每个key的长度为file_hdr->col_tot_len）、rids
+    // 规范化格式：公共前缀（长度为page_hdr->prefix_len）、去掉前缀的keys、rids（从页尾向前存放）
+    // 公共前缀会在结点分裂、合并时改变，因此keys和rids的位置每次访问时根据页头计算，不在构造时缓存
+    mutable char key_buf_[IX_MAX_KEY_LEN];  // 规范化格式下get_key()拼接出的完整key
 
    public:
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+    }
+
+    /**
+     * @description: 结点最多能存放的键值对数量（包括插入后等待分裂的一个空位）
+     * 规范化格式下key只存放去掉公共前缀的部分，公共前缀越长，结点能存放的键值对越多
+     */
+    static int max_size_of(const IxFileHdr *file_hdr, int prefix_len) {
+        if (!file_hdr->normalized_) {
+            return file_hdr->btree_order_ + 1;
+        }
+        int page_space = PAGE_SIZE - static_cast<int>(sizeof(IxPageHdr)) - prefix_len;
+        return page_space / (file_hdr->col_tot_len_ - prefix_len + static_cast<int>(sizeof(Rid)));
     }
 
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    int get_max_size() const { return max_size_of(file_hdr, get_prefix_len()); }
+
+    // 最小大小与公共前缀无关，保证合并后的结点在任何前缀下都放得下
+    int get_min_size() const { return (file_hdr->btree_order_ + 1) / 2; }
+
+    int key_at(int i) {
+        if (file_hdr->normalized_) {
+            char key[IX_MAX_KEY_LEN];
+            ix_denormalize_key(get_key(i), key, file_hdr->col_types_, file_hdr->col_lens_);
+            return *(int *)key;
+        }
+        return *(int *)get_key(i);
+    }
 
-    int get_min_size() { return get_max_size() / 2; }
+    int get_prefix_len() const { return file_hdr->normalized_ ? page_hdr->prefix_len : 0; }
 
-    int key_at(int i) { return *(int *)get_key(i); }
+    const char *get_prefix() const { return page->get_data() + sizeof(IxPageHdr); }
+
+    void set_prefix(const char *prefix, int prefix_len);
 
     /* 得到第i个孩子结点的page_no */
     page_id_t value_at(int i) { return get_rid(i)->page_no; }
@@ -100,13 +202,32 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /**
+     * @description: 第key_idx个key的完整值
+     * @note 规范化格式下返回的是内部缓冲区，只在下一次调用本结点的get_key()之前有效，不能通过它修改key
+     */
+    char *get_key(int key_idx) const {
+        if (!file_hdr->normalized_) {
+            return key_slot(key_idx);
+        }
+        int prefix_len = get_prefix_len();
+        memcpy(key_buf_, get_prefix(), prefix_len);
+        memcpy(key_buf_ + prefix_len, key_slot(key_idx), key_len());
+        return key_buf_;
+    }
+
+    Rid *get_rid(int rid_idx) const { return &rids()[rid_idx]; }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    // 规范化格式下key必须以结点的公共前缀开头
+    void set_key(int key_idx, const char *key) {
+        int prefix_len = get_prefix_len();
+        assert(memcmp(key, get_prefix(), prefix_len) == 0);
+        memcpy(key_slot(key_idx), key + prefix_len, key_len());
+    }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    void set_rid(int rid_idx, const Rid &rid) { rids()[rid_idx] = rid; }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    int compare_key(const char *target, int key_idx) const;
 
     int lower_bound(const char *target) const;
 
@@ -114,6 +235,8 @@ class IxNodeHandle {
 
     void insert_pairs(int pos, const char *key, const Rid *rid, int n);
 
+    void insert_pairs_from(int pos, IxNodeHandle *src, int src_pos, int n);
+
     page_id_t internal_lookup(const char *key);
 
     bool leaf_lookup(const char *key, Rid **value);
@@ -127,6 +250,8 @@ class IxNodeHandle {
 
     int remove(const char *key);
 
+    int remove(const char *key, const Rid &value);
+
     /**
      * @brief used in internal node to remove the last key in root node, and return the last child
      *
@@ -155,28 +280,54 @@ class IxNodeHandle {
         assert(rid_idx < page_hdr->num_key);
         return rid_idx;
     }
+
+   private:
+    int compare_suffix(const char *target, int key_idx) const;
+
+    // 单个INT字段的原始格式：结点中的key是连续的int_key_width()个int，结点内查找使用ix_int_key_lower_bound()/ix_int_key_upper_bound()
+    bool is_int_key() const {
+        return !file_hdr->normalized_ && file_hdr->col_num_ == int_key_width() && file_hdr->col_types_[0] == TYPE_INT;
+    }
+
+    // 唯一索引的key只有一个int，非唯一索引是(key, page_no, slot_no)三个int
+    int int_key_width() const { return file_hdr->unique_ ? 1 : IX_INT_RID_WIDTH; }
+
+    // 结点中存放的每个key的长度，规范化格式下不包括公共前缀
+    int key_len() const { return file_hdr->col_tot_len_ - get_prefix_len(); }
+
+    char *key_slot(int key_idx) const {
+        return page->get_data() + sizeof(IxPageHdr) + get_prefix_len() + key_idx * key_len();
+    }
+
+    Rid *rids() const {
+        if (!file_hdr->normalized_) {
+            return reinterpret_cast<Rid *>(page->get_data() + sizeof(IxPageHdr) + file_hdr->keys_size_);
+        }
+        return reinterpret_cast<Rid *>(page->get_data() + PAGE_SIZE) - get_max_size();
+    }
 };
 
 /* B+树 */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
+    friend class IxBulkLoader;
 
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::shared_mutex root_latch_;              // 保护file_hdr_->root_page_，修改根结点的操作持有写锁直到根结点不再变化
+    std::mutex file_hdr_latch_;                 // 保护file_hdr_->num_pages_和空闲页面链表
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
-    // for search
+    // for search：非唯一索引中一个key可能对应多个rid，按rid从小到大全部返回
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                 bool find_first = false);
+    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
@@ -186,8 +337,18 @@ class IxIndexHandle {
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
     // for delete
+    bool delete_entry(const char *key, const Rid &value, Transaction *transaction);
+
     bool delete_entry(const char *key, Transaction *transaction);
 
+    // for batch：keys先排序，落在同一个叶结点范围内的一串连续的key只从根结点下降一次
+    size_t get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *result,
+                      Transaction *transaction);
+
+    size_t insert_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values, Transaction *transaction);
+
+    size_t delete_entries(const std::vector<const char *> &keys, const std::vector<Rid> &values, Transaction *transaction);
+
     bool coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction = nullptr,
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle *old_root_node);
@@ -206,25 +367,72 @@ class IxIndexHandle {
     Iid leaf_begin() const;
 
    private:
+    // for latch crabbing
+    bool is_safe(IxNodeHandle *node, const char *key, Operation operation, bool is_root);
+
+    void release_latches(Transaction *transaction, bool *root_is_latched, bool is_dirty);
+
     // 辅助函数
     void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
 
+    // 把上层传入的key和rid拼接为索引中存储的格式写入buf（长度为col_tot_len_），返回buf；唯一索引忽略rid
+    const char *to_index_key(const char *key, const Rid &rid, char *buf) const {
+        char raw[IX_MAX_KEY_LEN];
+        char *dest = file_hdr_->normalized_ ? raw : buf;
+        memcpy(dest, key, file_hdr_->rid_offset());
+        if (!file_hdr_->unique_) {
+            memcpy(dest + file_hdr_->rid_offset(), &rid, sizeof(Rid));
+        }
+        if (file_hdr_->normalized_) {
+            ix_normalize_key(raw, buf, file_hdr_->col_types_, file_hdr_->col_lens_);
+        }
+        return buf;
+    }
+
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    // 在find_leaf_page()返回的叶结点上完成单个key的插入/删除，并释放latch
+    bool insert_into_leaf(IxNodeHandle *leaf, const char *key, const Rid &value, Transaction *transaction,
+                          bool *root_is_latched);
+
+    bool delete_from_leaf(IxNodeHandle *leaf, const char *key, const Rid &value, Transaction *transaction,
+                          bool *root_is_latched);
+
+    // for search
+    bool read_range(IxNodeHandle *leaf, const char *lower, bool exclusive, const char *upper, std::vector<Rid> *result,
+                    char *last) const;
+
+    void read_next_leaves(const char *last, const char *upper, page_id_t leaf_no, page_id_t next_leaf,
+                          std::vector<Rid> *result, Transaction *transaction);
+
+    // for batch
+    std::vector<size_t> sort_batch(const std::vector<const char *> &keys, const std::vector<Rid> *values,
+                                   std::vector<const char *> *index_keys, std::vector<char> *buf) const;
+
+    bool in_leaf(IxNodeHandle *leaf, const char *key) const;
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
     IxNodeHandle *create_node();
 
     // for maintain data structure
-    void maintain_parent(IxNodeHandle *node);
+    void maintain_parent(IxNodeHandle *node, Transaction *transaction);
 
     void erase_leaf(IxNodeHandle *leaf);
 
-    void release_node_handle(IxNodeHandle &node);
+    void release_node_handle(page_id_t page_no);
 
     void maintain_child(IxNodeHandle *node, int child_idx);
 
+    // for prefix compression
+    void grow_prefix(IxNodeHandle *parent, int rank, IxNodeHandle *child);
+
+    void shrink_prefix(IxNodeHandle *node, IxNodeHandle *neighbor_node);
+
     // for index test
     Rid get_rid(const Iid &iid) const;
+
+    // for index-only scan
+    Rid get_entry(const Iid &iid, char *key) const;
 };
\ No newline at end of file
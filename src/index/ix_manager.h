@@ -10,11 +10,13 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
 #include "system/sm_meta.h"
 #include "ix_defs.h"
+#include "ix_hash_handle.h"
 #include "ix_index_handle.h"
 
 class IxManager {
@@ -54,8 +56,171 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    // 字符串或者多个字段的key较长，使用规范化的key和前缀压缩；单个INT/FLOAT字段的key保持原始格式
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool unique = false) {
+        bool normalized = index_cols.size() > 1 ||
+                          std::any_of(index_cols.begin(), index_cols.end(),
+                                      [](const ColMeta &col) { return col.type == TYPE_STRING; });
+        create_index(filename, index_cols, normalized, unique);
+    }
+
+    /**
+     * @param normalized 结点中是否存放规范化的key并压缩公共前缀，规范化的key之间直接用memcmp比较
+     * @param unique 是否为唯一索引：唯一索引的key不附加rid，一个key只能插入一次
+     */
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool normalized,
+                      bool unique) {
+        create_index_file(get_index_name(filename, index_cols), index_cols, normalized, unique);
+    }
+
+    void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        disk_manager_->destroy_file(ix_name);
+    }
+
+    void destroy_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        disk_manager_->destroy_file(ix_name);
+    }
+
+    /**
+     * @description: 读出B+树索引文件头中的版本号；没有版本号的旧格式文件在这个位置存放文件头的长度，与IX_FILE_VERSION不同
+     */
+    int get_file_version(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        int fd = disk_manager_->open_file(get_index_name(filename, index_cols));
+        int version;
+        disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, reinterpret_cast<char *>(&version), sizeof(int));
+        disk_manager_->close_file(fd);
+        return version;
+    }
+
+    // 注意这里打开文件，创建并返回了index file handle的指针
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    void close_index(const IxIndexHandle *ih) {
+        char* data = new char[ih->file_hdr_->tot_len_];
+        ih->file_hdr_->serialize(data);
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
+        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+        // fd可能被之后打开的文件复用，从缓冲池中删除这个文件的页面
+        for (page_id_t page_no = 0; page_no < disk_manager_->get_fd2pageno(ih->fd_); page_no++) {
+            buffer_pool_manager_->delete_page({.fd = ih->fd_, .page_no = page_no});
+        }
+        disk_manager_->close_file(ih->fd_);
+    }
+
+    /**
+     * @description: REINDEX：在临时文件中创建并打开一个与ih格式相同的空索引，用于批量构建新的B+树，
+     * 调用者需要保证从构建到replace_index()期间没有其他线程读写原索引
+     * @param ih 原索引
+     */
+    std::unique_ptr<IxIndexHandle> create_rebuild_index(const std::string &filename,
+                                                        const std::vector<ColMeta>& index_cols,
+                                                        const IxIndexHandle *ih) {
+        std::string rebuild_name = get_index_name(filename, index_cols) + IX_REBUILD_SUFFIX;
+        // 上一次REINDEX中途失败可能留下了临时文件
+        if (disk_manager_->is_file(rebuild_name)) {
+            disk_manager_->destroy_file(rebuild_name);
+        }
+        create_index_file(rebuild_name, index_cols, ih->file_hdr_->normalized_, ih->file_hdr_->unique_);
+        int fd = disk_manager_->open_file(rebuild_name);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    /**
+     * @description: REINDEX：关闭原索引和create_rebuild_index()构建好的新索引，用新索引文件替换原索引文件后重新打开
+     * @return 替换后的索引
+     */
+    std::unique_ptr<IxIndexHandle> replace_index(const std::string &filename, const std::vector<ColMeta>& index_cols,
+                                                 const IxIndexHandle *ih, const IxIndexHandle *rebuilt) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        close_index(ih);
+        close_index(rebuilt);
+        disk_manager_->rename_file(ix_name + IX_REBUILD_SUFFIX, ix_name);
+        return open_index(filename, index_cols);
+    }
+
+    /**
+     * @description: 创建可扩展哈希索引文件，文件名与同样字段上的B+树索引相同（一组字段上只能建一个索引）
+     * 写入文件头、一个空桶和指向它的目录页
+     */
+    void create_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        IxHashFileHdr fhdr;
+        fhdr.col_tot_len_ = 0;
+        for (auto &col : index_cols) {
+            fhdr.col_types_.push_back(col.type);
+            fhdr.col_lens_.push_back(col.len);
+            fhdr.col_tot_len_ += col.len;
+        }
+        if (fhdr.col_tot_len_ > IX_MAX_COL_LEN) {
+            throw InvalidColLengthError(fhdr.col_tot_len_);
+        }
+        fhdr.col_num_ = index_cols.size();
+        fhdr.first_free_page_no_ = IX_NO_PAGE;
+        fhdr.num_pages_ = IX_HASH_INIT_NUM_PAGES;
+        fhdr.global_depth_ = 0;
+        fhdr.bucket_capacity_ = static_cast<int>((PAGE_SIZE - sizeof(IxHashBucketHdr)) / (fhdr.col_tot_len_ + sizeof(Rid)));
+        fhdr.dir_page_nos_ = {IX_HASH_INIT_DIR_PAGE};
+        fhdr.update_tot_len();
+
+        disk_manager_->create_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name);
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        fhdr.serialize(page_buf);
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+        // 初始的桶：局部深度为0，所有key都在这个桶中
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<IxHashBucketHdr *>(page_buf) = {
+            .next_free_page_no = IX_NO_PAGE,
+            .next_overflow = IX_NO_PAGE,
+            .local_depth = 0,
+            .num_entries = 0,
+        };
+        disk_manager_->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+        // 全局深度为0的目录只有一个槽位
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<page_id_t *>(page_buf) = IX_HASH_INIT_BUCKET_PAGE;
+        disk_manager_->write_page(fd, IX_HASH_INIT_DIR_PAGE, page_buf, PAGE_SIZE);
+        disk_manager_->close_file(fd);
+    }
+
+    std::unique_ptr<IxHashHandle> open_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxHashHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    // 目录写回目录页之后再写文件头，其余与close_index()相同
+    void close_hash_index(IxHashHandle *hh) {
+        hh->flush_dir();
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        hh->file_hdr_->serialize(page_buf);
+        disk_manager_->write_page(hh->fd_, IX_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+        buffer_pool_manager_->flush_all_pages(hh->fd_);
+        for (page_id_t page_no = 0; page_no < disk_manager_->get_fd2pageno(hh->fd_); page_no++) {
+            buffer_pool_manager_->delete_page({.fd = hh->fd_, .page_no = page_no});
+        }
+        disk_manager_->close_file(hh->fd_);
+    }
+
+   private:
+    // 创建名为ix_name的索引文件，写入文件头、叶子链表头结点和空的根结点
+    void create_index_file(const std::string &ix_name, const std::vector<ColMeta>& index_cols, bool normalized,
+                           bool unique) {
         // Create index file
         disk_manager_->create_file(ix_name);
         // Open index file
@@ -73,6 +238,11 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
+        // 非唯一索引的key最后附加记录的rid，使相同的索引字段也能按rid区分：同一个key的所有rid按顺序相邻存放
+        if (!unique) {
+            col_num += IX_RID_COL_NUM;
+            col_tot_len += sizeof(Rid);
+        }
         // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
         int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
@@ -82,10 +252,16 @@ class IxManager {
         IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
                                 col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
                                 IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
-        for(int i = 0; i < col_num; ++i) {
-            fhdr->col_types_.push_back(index_cols[i].type);
-            fhdr->col_lens_.push_back(index_cols[i].len);
+        for(auto& col: index_cols) {
+            fhdr->col_types_.push_back(col.type);
+            fhdr->col_lens_.push_back(col.len);
+        }
+        for(int i = 0; i < col_num - static_cast<int>(index_cols.size()); ++i) {
+            fhdr->col_types_.push_back(TYPE_INT);
+            fhdr->col_lens_.push_back(sizeof(int));
         }
+        fhdr->normalized_ = normalized;
+        fhdr->unique_ = unique;
         fhdr->update_tot_len();
         
         char* data = new char[fhdr->tot_len_];
@@ -132,36 +308,4 @@ class IxManager {
         // Close index file
         disk_manager_->close_file(fd);
     }
-
-    void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        disk_manager_->destroy_file(ix_name);
-    }
-
-    void destroy_index(const std::string &filename, const std::vector<std::string>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        disk_manager_->destroy_file(ix_name);
-    }
-
-    // 注意这里打开文件，创建并返回了index file handle的指针
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
-    }
-
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
-    }
-
-    void close_index(const IxIndexHandle *ih) {
-        char* data = new char[ih->file_hdr_->tot_len_];
-        ih->file_hdr_->serialize(data);
-        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
-        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
-        buffer_pool_manager_->flush_all_pages(ih->fd_);
-        disk_manager_->close_file(ih->fd_);
-    }
 };
\ No newline at end of file
@@ -0,0 +1,210 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_node_search.h"
+
+#include "errors.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IX_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+bool ix_int_search_supported(IxSearchImpl impl) {
+#ifdef IX_SEARCH_X86
+    __builtin_cpu_init();  // 可能在其他全局变量初始化时被调用
+    switch (impl) {
+        case IxSearchImpl::AVX2: return __builtin_cpu_supports("avx2");
+        case IxSearchImpl::SSE2: return __builtin_cpu_supports("sse2");
+        default: return true;
+    }
+#else
+    return impl == IxSearchImpl::SCALAR;
+#endif
+}
+
+namespace {
+
+// 统计keys[0,n)中小于target（upper为true时不大于target）的key的数量，每个key是width个int
+using CountFn = int (*)(const int *keys, int n, const int *target, bool upper);
+
+// 按字典序比较两个由W个int组成的key
+template <int W>
+inline int compare_int_key(const int *a, const int *b) {
+    for (int j = 0; j < W; j++) {
+        if (a[j] != b[j]) {
+            return a[j] < b[j] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+template <int W>
+int count_scalar(const int *keys, int n, const int *target, bool upper) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        int cmp = compare_int_key<W>(keys + i * W, target);
+        count += upper ? cmp <= 0 : cmp < 0;
+    }
+    return count;
+}
+
+#ifdef IX_SEARCH_X86
+// 按字典序比较：a > b当且仅当第一个不相等的字段a更大，例如(key, page_no, slot_no)从最后一个字段向前合并
+// lower统计target > key的数量，upper统计key > target的数量，再用n减去
+template <int W>
+__attribute__((target("sse2"))) inline __m128i lex_gt_sse2(const __m128i *a, const __m128i *b) {
+    __m128i gt = _mm_cmpgt_epi32(a[W - 1], b[W - 1]);
+    for (int j = W - 2; j >= 0; j--) {
+        gt = _mm_or_si128(_mm_cmpgt_epi32(a[j], b[j]), _mm_and_si128(_mm_cmpeq_epi32(a[j], b[j]), gt));
+    }
+    return gt;
+}
+
+template <int W>
+__attribute__((target("sse2"))) int count_sse2(const int *keys, int n, const int *target, bool upper) {
+    __m128i t[W];
+    for (int j = 0; j < W; j++) {
+        t[j] = _mm_set1_epi32(target[j]);
+    }
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const int *k = keys + i * W;
+        __m128i v[W];
+        if constexpr (W == 1) {
+            v[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(k));
+        } else {
+            // SSE2没有gather，逐个取出4个key的同一个字段
+            for (int j = 0; j < W; j++) {
+                v[j] = _mm_setr_epi32(k[j], k[j + W], k[j + 2 * W], k[j + 3 * W]);
+            }
+        }
+        __m128i gt = upper ? lex_gt_sse2<W>(v, t) : lex_gt_sse2<W>(t, v);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+    }
+    if (upper) {
+        count = i - count;
+    }
+    return count + count_scalar<W>(keys + i * W, n - i, target, upper);
+}
+
+template <int W>
+__attribute__((target("avx2"))) inline __m256i lex_gt_avx2(const __m256i *a, const __m256i *b) {
+    __m256i gt = _mm256_cmpgt_epi32(a[W - 1], b[W - 1]);
+    for (int j = W - 2; j >= 0; j--) {
+        gt = _mm256_or_si256(_mm256_cmpgt_epi32(a[j], b[j]), _mm256_and_si256(_mm256_cmpeq_epi32(a[j], b[j]), gt));
+    }
+    return gt;
+}
+
+template <int W>
+__attribute__((target("avx2"))) int count_avx2(const int *keys, int n, const int *target, bool upper) {
+    __m256i t[W];
+    for (int j = 0; j < W; j++) {
+        t[j] = _mm256_set1_epi32(target[j]);
+    }
+    // 8个key的同一个字段间隔W个int
+    const __m256i index = _mm256_setr_epi32(0, W, 2 * W, 3 * W, 4 * W, 5 * W, 6 * W, 7 * W);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const int *k = keys + i * W;
+        __m256i v[W];
+        if constexpr (W == 1) {
+            v[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(k));
+        } else {
+            for (int j = 0; j < W; j++) {
+                v[j] = _mm256_i32gather_epi32(k + j, index, sizeof(int));
+            }
+        }
+        __m256i gt = upper ? lex_gt_avx2<W>(v, t) : lex_gt_avx2<W>(t, v);
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+    }
+    if (upper) {
+        count = i - count;
+    }
+    return count + count_scalar<W>(keys + i * W, n - i, target, upper);
+}
+#endif
+
+template <int W>
+CountFn count_fn(IxSearchImpl impl) {
+    switch (impl) {
+#ifdef IX_SEARCH_X86
+        case IxSearchImpl::AVX2: return count_avx2<W>;
+        case IxSearchImpl::SSE2: return count_sse2<W>;
+#endif
+        default: return count_scalar<W>;
+    }
+}
+
+// 只有唯一索引的单个int和非唯一索引的(key, page_no, slot_no)两种宽度
+CountFn count_fn(IxSearchImpl impl, int width) {
+    return width == 1 ? count_fn<1>(impl) : count_fn<IX_INT_RID_WIDTH>(impl);
+}
+
+IxSearchImpl select_impl() {
+    for (auto impl : {IxSearchImpl::AVX2, IxSearchImpl::SSE2}) {
+        if (ix_int_search_supported(impl)) {
+            return impl;
+        }
+    }
+    return IxSearchImpl::SCALAR;
+}
+
+const IxSearchImpl selected_impl = select_impl();
+const CountFn selected_count[] = {count_fn(selected_impl, 1), count_fn(selected_impl, IX_INT_RID_WIDTH)};
+
+inline int compare_int_key(const int *a, const int *b, int width) {
+    return width == 1 ? compare_int_key<1>(a, b) : compare_int_key<IX_INT_RID_WIDTH>(a, b);
+}
+
+// 二分查找把范围缩小到IX_SIMD_WINDOW以内，然后由count统计范围内在target之前的key
+inline int search(CountFn count, const int *keys, int n, const int *target, int width, bool upper) {
+    int left = 0, right = n;
+    while (right - left > IX_SIMD_WINDOW) {
+        int mid = (left + right) / 2;
+        int cmp = compare_int_key(keys + mid * width, target, width);
+        if (upper ? cmp <= 0 : cmp < 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left + count(keys + left * width, right - left, target, upper);
+}
+
+}  // namespace
+
+int ix_int_key_lower_bound(const int *keys, int n, const int *target, int width) {
+    return search(selected_count[width != 1], keys, n, target, width, false);
+}
+
+int ix_int_key_upper_bound(const int *keys, int n, const int *target, int width) {
+    return search(selected_count[width != 1], keys, n, target, width, true);
+}
+
+int ix_int_key_search(IxSearchImpl impl, const int *keys, int n, const int *target, int width, bool upper) {
+    if (!ix_int_search_supported(impl)) {
+        throw InternalError(std::string("ix_int_key_search: ") + ix_search_impl_name(impl) + " is not supported");
+    }
+    return search(count_fn(impl, width), keys, n, target, width, upper);
+}
+
+IxSearchImpl ix_int_search_impl() { return selected_impl; }
+
+const char *ix_search_impl_name(IxSearchImpl impl) {
+    switch (impl) {
+        case IxSearchImpl::AVX2: return "avx2";
+        case IxSearchImpl::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
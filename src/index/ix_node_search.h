@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+/**
+ * @description: 单个INT字段的索引结点内查找。结点中的key是连续存放的有序int数组：唯一索引每个key是一个int，
+ * 非唯一索引的key附加了rid，每个key是(key, page_no, slot_no)三个int，按字典序比较。
+ * 先用二分查找把范围缩小到IX_SIMD_WINDOW个key以内，再用SIMD比较统计范围内小于（或不大于）target的key的数量。
+ * 启动时按CPU支持的指令集选择AVX2、SSE2或者标量实现
+ */
+
+static constexpr int IX_SIMD_WINDOW = 32;
+static constexpr int IX_INT_RID_WIDTH = 3;
+
+enum class IxSearchImpl { SCALAR = 0, SSE2, AVX2 };
+
+/**
+ * @description: 在keys[0,n)中查找第一个>=target的位置，不存在时返回n
+ * @param width 每个key的int数量，1或IX_INT_RID_WIDTH；target同样是width个int
+ */
+int ix_int_key_lower_bound(const int *keys, int n, const int *target, int width);
+
+/**
+ * @description: 同ix_int_key_lower_bound()，查找第一个>target的位置
+ */
+int ix_int_key_upper_bound(const int *keys, int n, const int *target, int width);
+
+/**
+ * @description: 使用指定的实现查找，upper为false时同ix_int_key_lower_bound()，为true时同ix_int_key_upper_bound()
+ * @note 用于测试和性能对比；当前CPU不支持impl时 throw InternalError
+ */
+int ix_int_key_search(IxSearchImpl impl, const int *keys, int n, const int *target, int width, bool upper);
+
+// 当前CPU是否支持impl
+bool ix_int_search_supported(IxSearchImpl impl);
+
+// 启动时选择的实现
+IxSearchImpl ix_int_search_impl();
+
+const char *ix_search_impl_name(IxSearchImpl impl);
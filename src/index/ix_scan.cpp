@@ -16,7 +16,9 @@ See the Mulan PSL v2 for more details. */
  */
 void IxScan::next() {
     assert(!is_end());
+    // 每次只对当前叶结点加读latch，不与其他结点的latch同时持有
     IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+    node->page->rlatch();
     assert(node->is_leaf_page());
     assert(iid_.slot_no < node->get_size());
     // increment slot no
@@ -26,8 +28,15 @@ void IxScan::next() {
         iid_.slot_no = 0;
         iid_.page_no = node->get_next_leaf();
     }
+    node->page->runlatch();
+    bpm_->unpin_page(node->get_page_id(), false);
+    delete node;
 }
 
 Rid IxScan::rid() const {
     return ih_->get_rid(iid_);
-}
\ No newline at end of file
+}
+
+Rid IxScan::entry(char *key) const {
+    return ih_->get_entry(iid_, key);
+}
@@ -17,7 +17,7 @@ See the Mulan PSL v2 for more details. */
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 对page遍历时，只对当前叶结点加读latch
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
@@ -34,5 +34,8 @@ class IxScan : public RecScan {
 
     Rid rid() const override;
 
+    // 当前位置的rid，同时把原始格式的key写入key
+    Rid entry(char *key) const;
+
     const Iid &iid() const { return iid_; }
 };
\ No newline at end of file
@@ -28,6 +28,7 @@ typedef enum PlanTag{
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
+    T_Reindex,
     T_Insert,
     T_Update,
     T_Delete,
@@ -38,7 +39,11 @@ typedef enum PlanTag{
     T_Transaction_rollback,
     T_SeqScan,
     T_IndexScan,
+    T_IndexOnlyScan,
     T_NestLoop,
+    T_HashJoin,
+    T_MergeJoin,
+    T_IndexNestLoop,
     T_Sort,
     T_Projection
 } PlanTag;
@@ -118,17 +123,17 @@ class ProjectionPlan : public Plan
 class SortPlan : public Plan
 {
     public:
-        SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, TabCol sel_col, bool is_desc)
+        SortPlan(PlanTag tag, std::shared_ptr<Plan> subplan, std::vector<TabCol> sel_cols, std::vector<bool> is_descs)
         {
             Plan::tag = tag;
             subplan_ = std::move(subplan);
-            sel_col_ = sel_col;
-            is_desc_ = is_desc;
+            sel_cols_ = std::move(sel_cols);
+            is_descs_ = std::move(is_descs);
         }
         ~SortPlan(){}
         std::shared_ptr<Plan> subplan_;
-        TabCol sel_col_;
-        bool is_desc_;
+        std::vector<TabCol> sel_cols_;  // 排序键，按优先级从高到低
+        std::vector<bool> is_descs_;    // 每个排序键是否降序
         
 };
 
@@ -159,17 +164,22 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                IndexType index_type = INDEX_BTREE, bool unique = false)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            index_type_ = index_type;
+            unique_ = unique;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        IndexType index_type_;      // create index时索引的类型
+        bool unique_;               // create unique index
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "planner.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "execution/executor_delete.h"
@@ -22,16 +23,92 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
-bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
+// 索引包含的字段是否覆盖了查询用到的所有字段；哈希索引不能按顺序读出key，不作为覆盖索引
+static bool is_covering_index(const IndexMeta& index, const std::vector<std::string>& used_cols) {
+    return index.type == INDEX_BTREE && std::all_of(used_cols.begin(), used_cols.end(), [&](const std::string& col_name) {
+        return std::any_of(index.cols.begin(), index.cols.end(), [&](const ColMeta& col) { return col.name == col_name; });
+    });
+}
+
+// 索引匹配规则：索引字段的最长前缀上都有等值条件，紧接着的一个字段上可以再有范围条件（<、<=、>、>=），
+// 条件在where子句中的顺序不影响匹配。选择能匹配的字段最多的索引，字段数相同时优先选择等值条件多的索引，
+// 再相同时优先选择包含了used_cols中所有字段的索引（可以只读索引），最后优先选择哈希索引。
+// 哈希索引只能用于所有索引字段上都有等值条件的查询
+bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names,
+                             const std::vector<std::string> *used_cols) {
     index_col_names.clear();
-    for(auto& cond: curr_conds) {
-        if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
-            index_col_names.push_back(cond.lhs_col.col_name);
-    }
     TabMeta& tab = sm_manager_->db_.get_table(tab_name);
-    if(tab.is_index(index_col_names)) return true;
-    return false;
+    // 字段上是否有可以用于索引的等值条件（is_eq为true）或者范围条件
+    auto has_cond = [&](const ColMeta& col, bool is_eq) {
+        for (auto& cond : curr_conds) {
+            if (!cond.is_rhs_val || cond.lhs_col.tab_name != tab_name || cond.lhs_col.col_name != col.name ||
+                cond.rhs_val.type != col.type) {
+                continue;
+            }
+            if (is_eq ? cond.op == OP_EQ : (cond.op != OP_EQ && cond.op != OP_NE)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    int best_matched = 0, best_eq = 0;
+    bool best_covering = false, best_hash = false;
+    for (auto& index : tab.indexes) {
+        int num_eq = 0;
+        while (num_eq < index.col_num && has_cond(index.cols[num_eq], true)) {
+            num_eq++;
+        }
+        if (index.type == INDEX_HASH && num_eq < index.col_num) {
+            continue;
+        }
+        int matched = num_eq;
+        if (num_eq < index.col_num && has_cond(index.cols[num_eq], false)) {
+            matched++;
+        }
+        bool covering = used_cols != nullptr && is_covering_index(index, *used_cols);
+        bool hash = index.type == INDEX_HASH;
+        if (matched == 0) {
+            continue;
+        }
+        if (matched > best_matched || (matched == best_matched && num_eq > best_eq) ||
+            (matched == best_matched && num_eq == best_eq && covering && !best_covering) ||
+            (matched == best_matched && num_eq == best_eq && covering == best_covering && hash && !best_hash)) {
+            best_matched = matched;
+            best_eq = num_eq;
+            best_covering = covering;
+            best_hash = hash;
+            index_col_names.clear();
+            for (auto& col : index.cols) {
+                index_col_names.push_back(col.name);
+            }
+        }
+    }
+    return !index_col_names.empty();
+}
+
+/**
+ * @brief 查询中用到的tab_name表的字段：选择的字段、where子句（包括连接条件）中的字段和order by的字段
+ */
+std::vector<std::string> Planner::get_used_cols(std::shared_ptr<Query> query, const std::string &tab_name) {
+    std::vector<std::string> used_cols;
+    auto add_col = [&](const TabCol &col) {
+        if (col.tab_name == tab_name && std::find(used_cols.begin(), used_cols.end(), col.col_name) == used_cols.end()) {
+            used_cols.push_back(col.col_name);
+        }
+    };
+    for (auto &col : query->cols) {
+        add_col(col);
+    }
+    for (auto &cond : query->conds) {
+        add_col(cond.lhs_col);
+        if (!cond.is_rhs_val) {
+            add_col(cond.rhs_col);
+        }
+    }
+    for (auto &col : query->order_cols) {
+        add_col(col);
+    }
+    return used_cols;
 }
 
 /**
@@ -145,18 +222,26 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
     std::vector<std::string> tables = query->tables;
     // // Scan table , 生成表算子列表tab_nodes
     std::vector<std::shared_ptr<Plan>> table_scan_executors(tables.size());
+    // 在pop_conds()取走条件之前统计每个表用到的字段
+    std::vector<std::vector<std::string>> used_cols(tables.size());
+    for (size_t i = 0; i < tables.size(); i++) {
+        used_cols[i] = get_used_cols(query, tables[i]);
+    }
     for (size_t i = 0; i < tables.size(); i++) {
         auto curr_conds = pop_conds(query->conds, tables[i]);
         // int index_no = get_indexNo(tables[i], curr_conds);
         std::vector<std::string> index_col_names;
-        bool index_exist = get_index_cols(tables[i], curr_conds, index_col_names);
+        bool index_exist = get_index_cols(tables[i], curr_conds, index_col_names, &used_cols[i]);
         if (index_exist == false) {  // 该表没有索引
             index_col_names.clear();
             table_scan_executors[i] = 
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
         } else {  // 存在索引
+            // 索引包含了查询用到的所有字段时，只读索引，不再读取表的记录
+            TabMeta &tab = sm_manager_->db_.get_table(tables[i]);
+            PlanTag tag = is_covering_index(*tab.get_index_meta(index_col_names), used_cols[i]) ? T_IndexOnlyScan : T_IndexScan;
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(tag, sm_manager_, tables[i], curr_conds, index_col_names);
         }
     }
     // 只有一个表，不需要join。
@@ -244,31 +329,220 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
         }
     }
 
+    std::map<std::string, std::vector<std::string>> tab_used_cols;
+    for (size_t i = 0; i < tables.size(); i++) {
+        tab_used_cols[tables[i]] = used_cols[i];
+    }
+    choose_join_method(table_join_executors, tab_used_cols);
+
     return table_join_executors;
 
 }
 
 
-std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan)
+/**
+ * @description: 为计划树中的每个join选择连接算法，make_one_rel()生成的都是T_NestLoop，在所有条件下推完成之后调用。
+ * 连接条件中两侧字段类型和长度都相同的等值条件可以作为连接键：两侧都能按连接键有序输出时用T_MergeJoin，
+ * 并把这个条件移到conds_的最前面；否则有一侧是表扫描、表上有与连接条件匹配的索引时用T_IndexNestLoop，
+ * 这一侧作为内表交换到右边；否则用T_HashJoin；没有这样的条件时仍然是T_NestLoop
+ * @param used_cols 每个表在查询中用到的字段，用来判断改为索引扫描时能否只读索引
+ */
+void Planner::choose_join_method(const std::shared_ptr<Plan> &plan,
+                                 const std::map<std::string, std::vector<std::string>> &used_cols)
 {
-    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
-    if(!x->has_sort) {
-        return plan;
+    auto x = std::dynamic_pointer_cast<JoinPlan>(plan);
+    if (x == nullptr) {
+        return;
     }
-    std::vector<std::string> tables = query->tables;
-    std::vector<ColMeta> all_cols;
-    for (auto &sel_tab_name : tables) {
-        // 这里db_不能写成get_db(), 注意要传指针
-        const auto &sel_tab_cols = sm_manager_->db_.get_table(sel_tab_name).cols;
-        all_cols.insert(all_cols.end(), sel_tab_cols.begin(), sel_tab_cols.end());
+    choose_join_method(x->left_, used_cols);
+    choose_join_method(x->right_, used_cols);
+    auto is_equi_join = [&](const Condition &cond) {
+        if (cond.is_rhs_val || cond.op != OP_EQ) {
+            return false;
+        }
+        auto lhs = sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+        auto rhs = sm_manager_->db_.get_table(cond.rhs_col.tab_name).get_col(cond.rhs_col.col_name);
+        return lhs->type == rhs->type && lhs->len == rhs->len;
+    };
+    for (auto it = x->conds_.begin(); it != x->conds_.end(); ++it) {
+        if (!is_equi_join(*it)) {
+            continue;
+        }
+        // 下推的连接条件左边的字段属于左子树，右边的字段属于右子树
+        if (ordered_on(x->left_, it->lhs_col, used_cols, false) && ordered_on(x->right_, it->rhs_col, used_cols, false)) {
+            ordered_on(x->left_, it->lhs_col, used_cols, true);
+            ordered_on(x->right_, it->rhs_col, used_cols, true);
+            std::iter_swap(x->conds_.begin(), it);
+            x->tag = T_MergeJoin;
+            return;
+        }
+    }
+    // 两侧都可以作为内表时，以数据文件较大的表为内表
+    std::vector<std::string> index_cols[2];
+    bool left_inner = get_join_index_cols(x->left_, x->right_, x->conds_, index_cols[0]);
+    bool right_inner = get_join_index_cols(x->right_, x->left_, x->conds_, index_cols[1]);
+    if (left_inner && right_inner) {
+        auto num_pages = [&](const std::shared_ptr<Plan> &scan) {
+            return sm_manager_->fhs_.at(std::dynamic_pointer_cast<ScanPlan>(scan)->tab_name_)->get_file_hdr().num_pages;
+        };
+        right_inner = num_pages(x->right_) >= num_pages(x->left_);
+    }
+    if (left_inner || right_inner) {
+        if (!right_inner) {
+            std::swap(x->left_, x->right_);
+        }
+        std::dynamic_pointer_cast<ScanPlan>(x->right_)->index_col_names_ = index_cols[right_inner ? 1 : 0];
+        x->tag = T_IndexNestLoop;
+        return;
+    }
+    if (std::any_of(x->conds_.begin(), x->conds_.end(), is_equi_join)) {
+        x->tag = T_HashJoin;
+    }
+}
+
+/**
+ * @description: plan能否按col从小到大输出记录
+ * B+树索引扫描中，col是索引字段并且它之前的索引字段上都有等值条件；merge join的连接键（conds_[0]的两个字段）就是col；
+ * 索引嵌套循环连接按外表的顺序输出；没有条件的顺序扫描（总是要读整个表）的表上有以col开头、覆盖查询所用字段的B+树索引时，
+ * 可以改为只读这个索引的全索引扫描。不能只读索引时不改：回表要按索引的顺序逐条随机读记录，不如两次顺序扫描加哈希连接
+ * @param apply 是否把顺序扫描改为索引扫描
+ */
+bool Planner::ordered_on(const std::shared_ptr<Plan> &plan, const TabCol &col,
+                         const std::map<std::string, std::vector<std::string>> &used_cols, bool apply)
+{
+    auto same_col = [](const TabCol &a, const TabCol &b) {
+        return a.tab_name == b.tab_name && a.col_name == b.col_name;
+    };
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        if (x->tag == T_IndexNestLoop) {
+            return ordered_on(x->left_, col, used_cols, apply);
+        }
+        return x->tag == T_MergeJoin && (same_col(x->conds_[0].lhs_col, col) || same_col(x->conds_[0].rhs_col, col));
+    }
+    auto x = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (x == nullptr || x->tab_name_ != col.tab_name) {
+        return false;
+    }
+    TabMeta &tab = sm_manager_->db_.get_table(x->tab_name_);
+    if (x->tag == T_SeqScan) {
+        if (!x->conds_.empty()) {
+            return false;
+        }
+        for (auto &index : tab.indexes) {
+            if (index.type != INDEX_BTREE || index.cols[0].name != col.col_name ||
+                !is_covering_index(index, used_cols.at(x->tab_name_))) {
+                continue;
+            }
+            if (apply) {
+                x->tag = T_IndexOnlyScan;
+                x->index_col_names_.clear();
+                for (auto &index_col : index.cols) {
+                    x->index_col_names_.push_back(index_col.name);
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+    const IndexMeta &index = *tab.get_index_meta(x->index_col_names_);
+    if (index.type != INDEX_BTREE) {
+        return false;
+    }
+    for (auto &index_col : index.cols) {
+        if (index_col.name == col.col_name) {
+            return true;
+        }
+        bool has_eq = std::any_of(x->conds_.begin(), x->conds_.end(), [&](const Condition &cond) {
+            return cond.is_rhs_val && cond.op == OP_EQ && same_col(cond.lhs_col, {x->tab_name_, index_col.name}) &&
+                   cond.rhs_val.type == index_col.type;
+        });
+        if (!has_eq) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// plan中是否包含表tab_name
+static bool contains_table(const std::shared_ptr<Plan> &plan, const std::string &tab_name)
+{
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        return x->tab_name_ == tab_name;
+    }
+    if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        return contains_table(x->left_, tab_name) || contains_table(x->right_, tab_name);
     }
-    TabCol sel_col;
-    for (auto &col : all_cols) {
-        if(col.name.compare(x->order->cols->col_name) == 0 )
-        sel_col = {.tab_name = col.tab_name, .col_name = col.name};
+    return false;
+}
+
+/**
+ * @description: inner作为索引嵌套循环连接的内表时使用的索引。inner必须是表扫描；索引字段的最长前缀上，
+ * 每个字段与outer中类型和长度相同的字段有等值连接条件，或者在inner的扫描条件中有等值条件，并且至少有一个字段来自连接条件；
+ * 哈希索引要求前缀包含所有字段。选择前缀最长的索引，与IndexNestedLoopJoinExecutor中拼key的规则一致
+ * @return 是否有这样的索引
+ */
+bool Planner::get_join_index_cols(const std::shared_ptr<Plan> &inner, const std::shared_ptr<Plan> &outer,
+                                  const std::vector<Condition> &conds, std::vector<std::string> &index_col_names)
+{
+    index_col_names.clear();
+    auto x = std::dynamic_pointer_cast<ScanPlan>(inner);
+    if (x == nullptr) {
+        return false;
+    }
+    TabMeta &tab = sm_manager_->db_.get_table(x->tab_name_);
+    // 索引字段col与outer中的字段有等值连接条件
+    auto has_join_cond = [&](const ColMeta &col) {
+        return std::any_of(conds.begin(), conds.end(), [&](const Condition &cond) {
+            if (cond.is_rhs_val || cond.op != OP_EQ) {
+                return false;
+            }
+            TabCol inner_col = cond.lhs_col, outer_col = cond.rhs_col;
+            if (inner_col.tab_name != x->tab_name_) {
+                std::swap(inner_col, outer_col);
+            }
+            if (inner_col.tab_name != x->tab_name_ || inner_col.col_name != col.name ||
+                !contains_table(outer, outer_col.tab_name)) {
+                return false;
+            }
+            auto outer_meta = sm_manager_->db_.get_table(outer_col.tab_name).get_col(outer_col.col_name);
+            return outer_meta->type == col.type && outer_meta->len == col.len;
+        });
+    };
+    auto has_eq_val = [&](const ColMeta &col) {
+        return std::any_of(x->conds_.begin(), x->conds_.end(), [&](const Condition &cond) {
+            return cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == col.name && cond.rhs_val.type == col.type;
+        });
+    };
+    int best_prefix = 0;
+    for (auto &index : tab.indexes) {
+        int prefix = 0;
+        bool has_join = false;
+        for (; prefix < index.col_num; prefix++) {
+            bool join = has_join_cond(index.cols[prefix]);
+            if (!join && !has_eq_val(index.cols[prefix])) {
+                break;
+            }
+            has_join = has_join || join;
+        }
+        if (!has_join || (index.type == INDEX_HASH && prefix < index.col_num) || prefix <= best_prefix) {
+            continue;
+        }
+        best_prefix = prefix;
+        index_col_names.clear();
+        for (auto &col : index.cols) {
+            index_col_names.push_back(col.name);
+        }
+    }
+    return !index_col_names.empty();
+}
+
+std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan)
+{
+    // order by的字段已经在Analyze中补全了表名
+    if(query->order_cols.empty()) {
+        return plan;
     }
-    return std::make_shared<SortPlan>(T_Sort, std::move(plan), sel_col, 
-                                    x->order->orderby_dir == ast::OrderBy_DESC);
+    return std::make_shared<SortPlan>(T_Sort, std::move(plan), query->order_cols, query->order_descs);
 }
 
 
@@ -315,10 +589,15 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        IndexType index_type = x->method == ast::IndexMethod_HASH ? INDEX_HASH : INDEX_BTREE;
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                index_type, x->unique);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::Reindex>(query->parse)) {
+        // reindex
+        plannerRoot = std::make_shared<DDLPlan>(T_Reindex, x->tab_name, x->col_names, std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse)) {
         // insert;
         plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(),  x->tab_name,  
@@ -42,13 +42,25 @@ class Planner {
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
+    void choose_join_method(const std::shared_ptr<Plan> &plan,
+                            const std::map<std::string, std::vector<std::string>> &used_cols);
+
+    bool get_join_index_cols(const std::shared_ptr<Plan> &inner, const std::shared_ptr<Plan> &outer,
+                             const std::vector<Condition> &conds, std::vector<std::string> &index_col_names);
+
+    bool ordered_on(const std::shared_ptr<Plan> &plan, const TabCol &col,
+                    const std::map<std::string, std::vector<std::string>> &used_cols, bool apply);
+
     std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
 
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
-    bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
+    bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names,
+                        const std::vector<std::string> *used_cols = nullptr);
+
+    std::vector<std::string> get_used_cols(std::shared_ptr<Query> query, const std::string &tab_name);
 
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
@@ -32,6 +32,12 @@ enum OrderByDir {
     OrderBy_DESC
 };
 
+// CREATE INDEX ... USING {BTREE | HASH}，默认为B+树
+enum IndexMethod {
+    IndexMethod_BTREE,
+    IndexMethod_HASH
+};
+
 // Base class for tree nodes
 struct TreeNode {
     virtual ~TreeNode() = default;  // enable polymorphism
@@ -96,9 +102,12 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    IndexMethod method;
+    bool unique;    // CREATE UNIQUE INDEX
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, IndexMethod method_ = IndexMethod_BTREE,
+                bool unique_ = false) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), method(method_), unique(unique_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -109,6 +118,15 @@ struct DropIndex : public TreeNode {
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
 };
 
+// col_names为空时重建表上的所有索引
+struct Reindex : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+
+    Reindex(std::string tab_name_, std::vector<std::string> col_names_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+};
+
 struct Expr : public TreeNode {
 };
 
@@ -158,12 +176,18 @@ struct BinaryExpr : public TreeNode {
             lhs(std::move(lhs_)), op(op_), rhs(std::move(rhs_)) {}
 };
 
+// order by的字段按优先级从高到低排列，每个字段有自己的排序方向
 struct OrderBy : public TreeNode
 {
-    std::shared_ptr<Col> cols;
-    OrderByDir orderby_dir;
-    OrderBy( std::shared_ptr<Col> cols_, OrderByDir orderby_dir_) :
-       cols(std::move(cols_)), orderby_dir(std::move(orderby_dir_)) {}
+    std::vector<std::shared_ptr<Col>> cols;
+    std::vector<OrderByDir> orderby_dirs;
+    OrderBy( std::shared_ptr<Col> col_, OrderByDir orderby_dir_) {
+        add(std::move(col_), orderby_dir_);
+    }
+    void add(std::shared_ptr<Col> col_, OrderByDir orderby_dir_) {
+        cols.push_back(std::move(col_));
+        orderby_dirs.push_back(orderby_dir_);
+    }
 };
 
 struct InsertStmt : public TreeNode {
@@ -231,6 +255,7 @@ struct SemValue {
     float sv_float;
     std::string sv_str;
     OrderByDir sv_orderby_dir;
+    IndexMethod sv_index_method;
     std::vector<std::string> sv_strs;
 
     std::shared_ptr<TreeNode> sv_node;
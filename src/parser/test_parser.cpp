@@ -23,6 +23,8 @@ int main() {
         "create index tb(a, b, c);",
         "drop index tb(a, b, c);",
         "drop index tb(b);",
+        "reindex tb;",
+        "reindex tb(a, b);",
         "insert into tb values (1, 3.14, 'pi');",
         "delete from tb where a = 1;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
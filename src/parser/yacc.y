@@ -23,6 +23,7 @@ using namespace ast;
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
 WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY
+REINDEX USING HASH BTREE UNIQUE
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -50,6 +51,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_conds> whereClause optWhereClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_index_method> opt_index_method
 
 %%
 start:
@@ -121,14 +123,26 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   CREATE INDEX tbName '(' colNameList ')' opt_index_method
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<CreateIndex>($3, $5, $7);
+    }
+    |   CREATE UNIQUE INDEX tbName '(' colNameList ')' opt_index_method
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, $8, true);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
     }
+    |   REINDEX tbName '(' colNameList ')'
+    {
+        $$ = std::make_shared<Reindex>($2, $4);
+    }
+    |   REINDEX tbName
+    {
+        $$ = std::make_shared<Reindex>($2, std::vector<std::string>());
+    }
     ;
 
 dml:
@@ -360,6 +374,11 @@ order_clause:
     { 
         $$ = std::make_shared<OrderBy>($1, $2);
     }
+    |   order_clause ',' col opt_asc_desc
+    {
+        $$ = $1;
+        $$->add($3, $4);
+    }
     ;   
 
 opt_asc_desc:
@@ -368,6 +387,12 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+opt_index_method:
+    USING BTREE     { $$ = IndexMethod_BTREE; }
+    |  USING HASH   { $$ = IndexMethod_HASH;  }
+    |               { $$ = IndexMethod_BTREE; }
+    ;
+
 tbName: IDENTIFIER;
 
 colName: IDENTIFIER;
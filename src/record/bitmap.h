@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <cinttypes>
+#include <cstdint>
 #include <cstring>
 
 static constexpr int BITMAP_WIDTH = 8;
@@ -32,6 +33,7 @@ class Bitmap {
 
     /**
      * @brief 找下一个为0 or 1的位
+     * 每次读取64位（按字节序转换为最高位在前，与磁盘上的位序一致），用clz直接定位字中第一个符合要求的位
      * @param bit false表示要找下一个为0的位，true表示要找下一个为1的位
      * @param bm 要找的起始地址为bm
      * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
@@ -39,22 +41,70 @@ class Bitmap {
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int pos = curr + 1;
+        if (pos >= max_n) {
+            return max_n;
+        }
+        if (is_set(bm, pos) == bit) {  // 位密集时紧接着的一位往往就符合要求，不必读取整个字
+            return pos;
+        }
+        int word = pos / WORD_BITS;
+        uint64_t flip = bit ? 0 : ~static_cast<uint64_t>(0);  // 找0时将字取反，统一为找1
+        uint64_t w = (load_word(bm, word, max_n) ^ flip) & (~static_cast<uint64_t>(0) >> (pos % WORD_BITS));
+        while (w == 0) {
+            if (++word * WORD_BITS >= max_n) {
+                return max_n;
             }
+            w = load_word(bm, word, max_n) ^ flip;
         }
-        return max_n;
+        int i = word * WORD_BITS + __builtin_clzll(w);
+        return i < max_n ? i : max_n;  // 最后一个字中超出max_n的位补0，找0时可能命中
     }
 
     // 找第一个为0 or 1的位
     static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
 
+    // 统计[0,max_n)中为1的位的个数，可用于校验页头中的num_records
+    static int count(const char *bm, int max_n) {
+        int cnt = 0;
+        int num_words = (max_n + WORD_BITS - 1) / WORD_BITS;
+        for (int word = 0; word < num_words; word++) {
+            uint64_t w = load_word(bm, word, max_n);
+            int tail = max_n - word * WORD_BITS;
+            if (tail < WORD_BITS) {
+                w &= ~(~static_cast<uint64_t>(0) >> tail);  // 只保留前tail位
+            }
+            cnt += __builtin_popcountll(w);
+        }
+        return cnt;
+    }
+
     // for example:
     // rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
    private:
+    static constexpr int WORD_BITS = 64;
+
+    /**
+     * @brief 读取第word个64位字，第一个字节位于最高8位，即字中的第i位（从最高位数起）对应bitmap中的第word*64+i位
+     * 只读取前(max_n+7)/8个字节，不越过bitmap的末尾，不足8字节的部分补0
+     */
+    static uint64_t load_word(const char *bm, int word, int max_n) {
+        int begin = word * (WORD_BITS / BITMAP_WIDTH);
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH - begin;
+        uint64_t w = 0;
+        if (num_bytes >= static_cast<int>(sizeof(w))) {
+            memcpy(&w, bm + begin, sizeof(w));
+        } else {
+            memcpy(&w, bm + begin, num_bytes);
+        }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        w = __builtin_bswap64(w);
+#endif
+        return w;
+    }
+
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <algorithm>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -20,15 +22,55 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
-    context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);//lab4
+    lock_shared_on_record(rid, context); //lab4
     RmPageHandle page_handle = fetch_page_handle(rid.page_no); // 1
     std::unique_ptr<RmRecord> recordptr{new RmRecord(file_hdr_.record_size, page_handle.get_slot(rid.slot_no))}; // 2
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    return recordptr;
+}
+
+/**
+ * @description: 把rids所在的数据页一起读入缓冲池，缺页合并为批量I/O，之后按rid逐条读取记录时命中缓冲池。
+ * 每批最多读入预读窗口大小的页面，预读关闭时不读入
+ * @param {vector<Rid>&} rids 之后要读取的记录号
+ */
+void RmFileHandle::load_pages(const std::vector<Rid>& rids) const {
+    int window = buffer_pool_manager_->get_read_ahead_window();
+    if (window <= 0) {
+        return;
+    }
+    std::vector<int> page_nos;
+    for (auto& rid : rids) {
+        if (rid.page_no >= RM_FIRST_RECORD_PAGE && rid.page_no < file_hdr_.num_pages) {
+            page_nos.push_back(rid.page_no);
+        }
+    }
+    std::sort(page_nos.begin(), page_nos.end());
+    page_nos.erase(std::unique(page_nos.begin(), page_nos.end()), page_nos.end());
+    for (size_t start = 0; start < page_nos.size(); start += window) {
+        std::vector<PageId> page_ids;
+        for (size_t i = start; i < std::min(page_nos.size(), start + window); i++) {
+            page_ids.push_back({fd_, page_nos[i]});
+        }
+        for (Page* page : buffer_pool_manager_->fetch_pages(page_ids)) {
+            if (page != nullptr) {
+                buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+            }
+        }
+    }
+}
+
+/**
+ * @description: 对记录号为rid的记录加共享锁，并放入事务的锁集
+ * @param {Rid&} rid 记录号
+ * @param {Context*} context
+ */
+void RmFileHandle::lock_shared_on_record(const Rid& rid, Context* context) const {
+    context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);//lab4
 
     //lab4:放入锁集
     LockDataId lock_data_id =  LockDataId{fd_,rid,LockDataType::RECORD};
     context->txn_->get_lock_set()->insert(lock_data_id);
-    
-    return recordptr;
 }
 
 /**
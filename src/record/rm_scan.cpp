@@ -11,6 +11,8 @@ See the Mulan PSL v2 for more details. */
 #include "rm_scan.h"
 #include "rm_file_handle.h"
 
+#include <algorithm>
+
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
@@ -18,27 +20,68 @@ See the Mulan PSL v2 for more details. */
 RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
-    rid_ = Rid{RM_FIRST_RECORD_PAGE, -1};
-    next();
+    rid_ = Rid{RM_FIRST_RECORD_PAGE - 1, -1};
+    // 顺序扫描，提示缓冲池预读第一个窗口的数据页，之后的窗口由缓冲池的顺序访问检测接着预读
+    BufferPoolManager *bpm = file_handle_->buffer_pool_manager_;
+    int num_data_pages = file_handle_->file_hdr_.num_pages - RM_FIRST_RECORD_PAGE;
+    bpm->prefetch_pages(file_handle_->fd_, RM_FIRST_RECORD_PAGE, std::min(bpm->get_read_ahead_window(), num_data_pages));
+    next_page();
 }
 
+RmScan::~RmScan() { release_page(); }
+
 /**
  * @brief 找到文件中下一个存放了记录的位置
  */
 void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-    while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
+    assert(!is_end());
+    if (++pos_ < slot_nos_.size()) {
+        rid_.slot_no = slot_nos_[pos_];
+        return;
+    }
+    next_page();
+}
+
+/**
+ * @brief 释放当前页面，找到下一个存放了记录的页面，固定该页面并收集其中所有记录的位置
+ */
+void RmScan::next_page() {
+    // 1. 释放当前页面的固定
+    // 2. 依次固定后续页面，根据bitmap收集存放了记录的slot；页面中没有记录则释放后继续查找
+    release_page(); // 1
+    int num_records_per_page = file_handle_->file_hdr_.num_records_per_page;
+    for (rid_.page_no++; rid_.page_no < file_handle_->file_hdr_.num_pages; rid_.page_no++) { // 2
         RmPageHandle ph = file_handle_->fetch_page_handle(rid_.page_no);
-        rid_.slot_no = Bitmap::next_bit(true, ph.bitmap, file_handle_->file_hdr_.num_records_per_page, rid_.slot_no);
-        if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
+        page_ = ph.page;
+        for (int slot_no = Bitmap::first_bit(true, ph.bitmap, num_records_per_page); slot_no < num_records_per_page;
+             slot_no = Bitmap::next_bit(true, ph.bitmap, num_records_per_page, slot_no)) {
+            slot_nos_.push_back(slot_no);
+            records_.push_back(ph.get_slot(slot_no));
+        }
+        if (!slot_nos_.empty()) {
+            pos_ = 0;
+            rid_.slot_no = slot_nos_[0];
             return;
-    	}
-        rid_.slot_no = -1;
-        rid_.page_no++;
+        }
+        release_page();
     }
     // next record not found
-    rid_.page_no = RM_NO_PAGE;
+    rid_ = Rid{RM_NO_PAGE, -1};
+}
+
+/**
+ * @brief 释放当前页面的固定，清空当前页面的记录位置
+ */
+void RmScan::release_page() {
+    if (page_ != nullptr) {
+        file_handle_->buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+        page_ = nullptr;
+    }
+    slot_nos_.clear();
+    records_.clear();
+    pos_ = 0;
 }
 
 /**
@@ -54,4 +97,4 @@ bool RmScan::is_end() const {
  */
 Rid RmScan::rid() const {
     return rid_;
-}
\ No newline at end of file
+}
@@ -10,19 +10,50 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "rm_defs.h"
 
 class RmFileHandle;
 
+/**
+ * @description: 按页扫描表数据文件。扫描期间当前页面保持固定，每个页面只fetch/unpin一次；
+ * 进入页面时根据bitmap收集所有存放了记录的slot，上层可以直接通过record()/page_records()访问页面中的记录数据而无需复制
+ * @note record()/page_records()返回的指针只在扫描停留在该页面期间有效
+ */
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    Page *page_ = nullptr;              // 当前页面，扫描停留在该页面期间保持固定
+    std::vector<int> slot_nos_;         // 当前页面中存放了记录的slot号
+    std::vector<char *> records_;       // 与slot_nos_一一对应，记录在页面中的地址
+    size_t pos_ = 0;                    // rid_在slot_nos_中的下标
 public:
     RmScan(const RmFileHandle *file_handle);
 
+    ~RmScan();
+
+    RmScan(const RmScan &) = delete;
+    RmScan &operator=(const RmScan &) = delete;
+
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    // 当前记录在页面中的地址
+    char *record() const { return records_[pos_]; }
+
+    // 跳过当前页面中剩余的记录，移动到下一个存放了记录的页面的第一条记录
+    void next_page();
+
+    // 当前页面中存放了记录的slot号，按slot号递增
+    const std::vector<int> &page_slot_nos() const { return slot_nos_; }
+
+    // 当前页面中所有记录的地址，与page_slot_nos()一一对应
+    const std::vector<char *> &page_records() const { return records_; }
+
+private:
+    void release_page();
 };
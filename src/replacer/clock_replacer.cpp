@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : evictable_((num_pages + WORD_BITS - 1) / WORD_BITS, 0),
+      referenced_((num_pages + WORD_BITS - 1) / WORD_BITS, 0),
+      max_size_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回INVALID_FRAME_ID
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+    if (size_ == 0) {
+        *frame_id = INVALID_FRAME_ID;
+        return false;
+    }
+    // 时钟指针依次扫过各帧：跳过不可淘汰的帧，清除引用位给予第二次机会，淘汰第一个引用位为0的帧
+    // 最多转两圈：第一圈清除所有引用位后，第二圈一定能找到victim
+    while (true) {
+        if (hand_ % WORD_BITS == 0 && evictable_[hand_ / WORD_BITS] == 0) {
+            hand_ = hand_ + WORD_BITS >= max_size_ ? 0 : hand_ + WORD_BITS;  // 整个字中都没有可淘汰的帧
+            continue;
+        }
+        size_t pos = hand_;
+        hand_ = (hand_ + 1) % max_size_;
+        if (!test(evictable_, pos)) continue;
+        if (test(referenced_, pos)) {
+            reset(referenced_, pos);
+            continue;
+        }
+        reset(evictable_, pos);
+        size_--;
+        *frame_id = static_cast<frame_id_t>(pos);
+        return true;
+    }
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (test(evictable_, frame_id)) {
+        reset(evictable_, frame_id);
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时设置引用位；frame已经可以被淘汰时不做任何操作
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (!test(evictable_, frame_id)) {
+        set(evictable_, frame_id);
+        set(referenced_, frame_id);
+        size_++;
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK（二次机会）替换策略
+每个帧用两个bit表示：是否可被淘汰、引用位。两个bit数组在构造时一次性分配，pin/unpin不申请内存
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    static constexpr size_t WORD_BITS = 64;
+
+    bool test(const std::vector<uint64_t> &bits, size_t pos) const { return bits[pos / WORD_BITS] >> (pos % WORD_BITS) & 1; }
+    void set(std::vector<uint64_t> &bits, size_t pos) { bits[pos / WORD_BITS] |= uint64_t(1) << (pos % WORD_BITS); }
+    void reset(std::vector<uint64_t> &bits, size_t pos) { bits[pos / WORD_BITS] &= ~(uint64_t(1) << (pos % WORD_BITS)); }
+
+    std::mutex latch_;                  // 互斥锁
+    std::vector<uint64_t> evictable_;   // 第i位为1表示帧i已unpin，可以被淘汰
+    std::vector<uint64_t> referenced_;  // 第i位为1表示帧i在时钟指针上次经过后被访问过
+    size_t hand_ = 0;                   // 时钟指针
+    size_t size_ = 0;                   // 可被淘汰的帧数
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
@@ -0,0 +1,110 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k),
+      history_(num_pages * k, 0),
+      history_size_(num_pages, 0),
+      history_head_(num_pages, 0),
+      evictable_(num_pages, false),
+      max_size_(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 计算帧在evict_set_中的排序键
+ * 访问不足k_次的帧排在前面，按最近一次访问时间排序；其余帧按倒数第k_次访问时间排序
+ */
+LRUKReplacer::EvictKey LRUKReplacer::make_key(frame_id_t frame_id) const {
+    size_t size = history_size_[frame_id];
+    size_t head = history_head_[frame_id];
+    if (size < k_) {
+        size_t last = (head + size - 1) % k_;
+        return {false, history_[frame_id * k_ + last], frame_id};
+    }
+    return {true, history_[frame_id * k_ + head], frame_id};
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回INVALID_FRAME_ID
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evict_set_.empty()) {
+        *frame_id = INVALID_FRAME_ID;
+        return false;
+    }
+    *frame_id = std::get<2>(*evict_set_.begin());
+    evict_set_.erase(evict_set_.begin());
+    evictable_[*frame_id] = false;
+    // 访问历史保留到缓冲池调用remove()装入新页面时才清空：缓冲池可能发现该帧已被无锁固定而放弃淘汰
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，访问历史保留
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        evict_set_.erase(make_key(frame_id));
+        evictable_[frame_id] = false;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，并记录一次访问
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        return;
+    }
+    size_t &size = history_size_[frame_id];
+    size_t &head = history_head_[frame_id];
+    if (size < k_) {
+        history_[frame_id * k_ + (head + size) % k_] = ++current_timestamp_;
+        size++;
+    } else {
+        // 覆盖最早的一次访问
+        history_[frame_id * k_ + head] = ++current_timestamp_;
+        head = (head + 1) % k_;
+    }
+    evictable_[frame_id] = true;
+    evict_set_.insert(make_key(frame_id));
+}
+
+/**
+ * @description: 移除帧并清空其访问历史，用于帧上的页面被替换或删除的情况
+ * @param {frame_id_t} frame_id 移除的frame的id
+ */
+void LRUKReplacer::remove(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_[frame_id]) {
+        evict_set_.erase(make_key(frame_id));
+        evictable_[frame_id] = false;
+    }
+    history_size_[frame_id] = 0;
+    history_head_[frame_id] = 0;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return evict_set_.size();
+}
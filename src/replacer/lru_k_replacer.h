@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略
+每次unpin记为帧上的一次访问，淘汰时选择倒数第K次访问最早（backward K-distance最大）的帧；
+访问次数不足K次的帧K-distance视为无穷大，优先按最近一次访问的先后淘汰。
+顺序扫描的页面通常只被访问一次，因此扫描不会把被反复访问的热点页面挤出缓冲池
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量
+     * @param {size_t} k 计算backward K-distance时使用的访问次数
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = 2);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    // 淘汰顺序：{访问次数是否已达K次, 排序时间戳, 帧号}，按字典序从小到大淘汰
+    using EvictKey = std::tuple<bool, uint64_t, frame_id_t>;
+
+    EvictKey make_key(frame_id_t frame_id) const;
+
+    std::mutex latch_;                  // 互斥锁
+    size_t k_;
+    uint64_t current_timestamp_ = 0;    // 逻辑时钟，每次访问加一
+    std::vector<uint64_t> history_;     // 每帧最近k_次访问的时间戳，按环形缓冲区存放，大小为num_pages * k_
+    std::vector<size_t> history_size_;  // 每帧已记录的访问次数（不超过k_）
+    std::vector<size_t> history_head_;  // 每帧环形缓冲区中最早一次访问的位置
+    std::vector<bool> evictable_;       // 帧是否已unpin，可以被淘汰
+    std::set<EvictKey> evict_set_;      // 可被淘汰的帧，按淘汰顺序排列
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
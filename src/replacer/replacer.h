@@ -39,6 +39,14 @@ class Replacer {
      */
     virtual void unpin(frame_id_t frame_id) = 0;
 
+    /**
+     * Removes a frame whose page is leaving the buffer pool (replaced by another page or deleted), together with
+     * any access history. Policies that remember past accesses should forget them, since the frame will hold an
+     * unrelated page from now on.
+     * @param frame_id the id of the frame to remove
+     */
+    virtual void remove(frame_id_t frame_id) { pin(frame_id); }
+
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
 };
@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include <signal.h>
 #include <unistd.h>
 #include <atomic>
+#include <mutex>
+#include <shared_mutex>
 
 #include "errors.h"
 #include "optimizer/optimizer.h"
@@ -31,7 +33,7 @@ static bool should_exit = false;
 
 // 构建全局所需的管理器对象
 auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get(), BUFFER_POOL_PARTITIONS);
 auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
 auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
 auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
@@ -55,6 +57,13 @@ void sigint_handler(int signo) {
     longjmp(jmpbuf, 1);
 }
 
+// 修改元数据、创建或关闭文件的DDL语句，执行时需要独占SmManager::ddl_latch_
+static bool is_ddl(const std::shared_ptr<ast::TreeNode> &tree) {
+    return std::dynamic_pointer_cast<ast::CreateTable>(tree) || std::dynamic_pointer_cast<ast::DropTable>(tree) ||
+           std::dynamic_pointer_cast<ast::CreateIndex>(tree) || std::dynamic_pointer_cast<ast::DropIndex>(tree) ||
+           std::dynamic_pointer_cast<ast::Reindex>(tree);
+}
+
 // 判断当前正在执行的是显式事务还是单条SQL语句的事务，并更新事务ID
 void SetTransaction(txn_id_t *txn_id, Context *context) {
     context->txn_ = txn_manager->get_transaction(*txn_id);
@@ -126,6 +135,14 @@ void *client_handler(void *sock_fd) {
         YY_BUFFER_STATE buf = yy_scan_string(data_recv);
         if (yyparse() == 0) {
             if (ast::parse_tree != nullptr) {
+                // 从语义分析到事务回滚都要读元数据和索引，DDL语句执行期间其他语句都要等待
+                std::shared_lock<std::shared_mutex> ddl_shared(sm_manager->ddl_latch_, std::defer_lock);
+                std::unique_lock<std::shared_mutex> ddl_exclusive(sm_manager->ddl_latch_, std::defer_lock);
+                if (is_ddl(ast::parse_tree)) {
+                    ddl_exclusive.lock();
+                } else {
+                    ddl_shared.lock();
+                }
                 try {
                     // analyze and rewrite
                     std::shared_ptr<Query> query = analyze->do_analyze(ast::parse_tree);
@@ -296,6 +313,10 @@ int main(int argc, char **argv) {
         recovery->analyze();
         recovery->redo();
         recovery->undo();
+
+        // 启动缓冲池后台清理线程
+        buffer_pool_manager->start_page_cleaner(BUFFER_POOL_CLEAN_FRAMES,
+                                                std::chrono::milliseconds(PAGE_CLEANER_INTERVAL_MS));
         
         // 开启服务端，开始接受客户端连接
         start_server();
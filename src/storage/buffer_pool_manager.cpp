@@ -10,56 +10,175 @@ See the Mulan PSL v2 for more details. */
 
 #include "buffer_pool_manager.h"
 
+#include <algorithm>
+#include <exception>
+
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @description: 从分区的free_list或replacer中得到可淘汰帧页的 *frame_id，调用前需持有分区latch
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
- * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @param {Partition&} part 目标页面所在的分区
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id（分区内帧号）
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
-    // Todo:
-    // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
+bool BufferPoolManager::find_victim_page(Partition &part, frame_id_t* frame_id) {
+    // 1 使用free_list_判断分区是否已满需要淘汰页面
     // 1.1 未满获得frame
-    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
+    // 1.2 已满使用replacer中的方法选择淘汰页面
 
-    if( !free_list_.empty() ) { // 1.1
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
-        return true;
+    // 帧需要先通过claim_frame独占：无锁命中的线程可能刚刚固定了该帧
+    for (size_t n = part.free_list_.size(); n > 0; --n) { // 1.1
+        *frame_id = part.free_list_.front();
+        part.free_list_.pop_front();
+        if (claim_frame(part, *frame_id))
+            return true;
+        part.free_list_.push_back(*frame_id); // 持有者发现页面号不符后会释放该帧
+    }
+    while (part.replacer_->victim(frame_id)) { // 1.2
+        if (claim_frame(part, *frame_id))
+            return true;
+        // 该帧被无锁固定，已从replacer中移除，pin_count_归零时由release_frame重新加入
     }
-    return replacer_->victim(frame_id); // 1.2
+    return false;
+}
 
+/**
+ * @description: 独占一个pin_count_为0的帧（置为-1），之后无锁路径无法再固定该帧，调用前需持有分区latch
+ * @return {bool} 成功返回true，帧已被固定则返回false
+ */
+bool BufferPoolManager::claim_frame(Partition &part, frame_id_t frame_id) {
+    int expected = 0;
+    return part.pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1);
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
+ * @description: 释放对帧的一次固定，调用前需持有分区latch。pin_count_归零且帧仍映射着页面时将其交给replacer
+ * @param {Partition&} part 帧所在的分区
+ * @param {frame_id_t} frame_id 分区内帧号
+ */
+void BufferPoolManager::release_frame(Partition &part, frame_id_t frame_id) {
+    Page *page = part.pages_ + frame_id;
+    if (page->pin_count_.fetch_sub(1) != 1)
+        return;
+    PageId page_id = page->id_;
+    frame_id_t mapped;
+    if (page_id.page_no != INVALID_PAGE_ID && part.page_table_->find(page_id, &mapped) && mapped == frame_id) {
+        // 无锁固定时帧仍留在replacer中，先移除再插入，使其成为最近使用的帧
+        part.replacer_->pin(frame_id);
+        part.replacer_->unpin(frame_id);
+    }
+}
+
+/**
+ * @description: 等待帧上正在进行的磁盘I/O完成，调用前需持有分区latch
+ * @param {Partition&} part 帧所在的分区
+ * @param {unique_lock&} lock 分区latch，等待期间会被释放
+ * @param {Page*} page 目标帧
+ */
+void BufferPoolManager::wait_for_io(Partition &part, std::unique_lock<std::mutex> &lock, Page *page) {
+    part.io_cv_.wait(lock, [page] { return !page->io_pending_; });
+}
+
+/**
+ * @description: 替换帧上页面的第一步：在latch下更新page table和page元数据，并将帧标记为正在I/O，调用前需持有分区latch
+ * @return {FrameIO} 本次替换的信息，之后的磁盘读写和finish_frame_io/abort_frame_io都需要它
+ * @param {Partition&} part 帧所在的分区
+ * @param {Page*} page 帧，需已由find_victim_page独占
  * @param {PageId} new_page_id 新的page_id
- * @param {frame_id_t} new_frame_id 新的帧frame_id
- */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
-    if ( page->is_dirty() ){ // 1 不可flush
-        PageId temp = page->get_page_id();
-        int fd_ = temp.fd;
-        disk_manager_->write_page(fd_, temp.page_no, page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
-        page->pin_count_ = 0;
+ * @param {frame_id_t} new_frame_id 新的帧frame_id（分区内帧号）
+ */
+BufferPoolManager::FrameIO BufferPoolManager::begin_frame_io(Partition &part, Page *page, PageId new_page_id,
+                                                             frame_id_t new_frame_id) {
+    FrameIO io{&part, page, new_frame_id, page->id_, new_page_id, page->is_dirty_};
+    if (io.old_page_id.page_no != INVALID_PAGE_ID)
+        evictions_++;
+    if (page->prefetched_.exchange(false))
+        prefetch_unused_++;
+    if (io.write_back) {
+        eviction_writes_++;
+        cleaner_cv_.notify_one(); // 前台线程不得不写回脏页，提前唤醒后台清理线程
     }
 
+    if (io.old_page_id.page_no != INVALID_PAGE_ID)
+        part.page_table_->erase(io.old_page_id);
+    part.page_table_->insert(new_page_id, new_frame_id);
+    if (io.write_back)
+        part.writing_back_.insert(io.old_page_id); // 写回完成前，其他线程不能从磁盘读入旧页面
+
+    page->id_ = new_page_id;
+    page->is_dirty_ = false;
+    page->io_pending_ = true;
+    page->pin_count_ = 1; // 帧由find_victim_page独占（-1），此后无锁路径才能固定它
+    part.replacer_->remove(new_frame_id); // 帧上换成了新页面，清除旧页面的访问历史
+    return io;
+}
+
+/**
+ * @description: 替换帧上页面的最后一步：磁盘读写成功后清除I/O标记并唤醒等待该帧的线程，调用前需持有分区latch
+ */
+void BufferPoolManager::finish_frame_io(FrameIO &io) {
+    if (io.write_back)
+        io.part->writing_back_.erase(io.old_page_id);
+    io.page->io_pending_ = false;
+    io.part->io_cv_.notify_all();
+}
+
+/**
+ * @description: 磁盘读写失败时撤销本次替换，调用前需持有分区latch：
+ * 旧页面写回失败则恢复为旧页面（仍为脏页），否则归还空闲帧。等待该帧的线程被唤醒后会发现页面号不符，自行释放固定
+ * @param {FrameIO&} io 本次替换的信息
+ * @param {bool} written 旧页面是否已经写回
+ */
+void BufferPoolManager::abort_frame_io(FrameIO &io, bool written) {
+    Partition &part = *io.part;
+    Page *page = io.page;
+    part.page_table_->erase(io.new_page_id);
+    part.writing_back_.erase(io.old_page_id);
+    page->io_pending_ = false;
+    if (!written) {
+        page->id_ = io.old_page_id;
+        page->is_dirty_ = true;
+        part.page_table_->insert(io.old_page_id, io.frame_id);
+    } else {
+        page->id_ = {io.new_page_id.fd, INVALID_PAGE_ID};
+        part.free_list_.push_back(io.frame_id);
+    }
+    release_frame(part, io.frame_id);
+    part.io_cv_.notify_all();
+}
 
-    page_table_.erase(page->id_);
-    page_table_[new_page_id] = new_frame_id; // 2
+/**
+ * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ *               调用前需持有分区latch；元数据在latch下更新，磁盘读写在释放latch后进行，返回时重新持有latch
+ * @param {Partition&} part 帧所在的分区
+ * @param {unique_lock&} lock 分区latch
+ * @param {Page*} page 写回页指针
+ * @param {PageId} new_page_id 新的page_id
+ * @param {frame_id_t} new_frame_id 新的帧frame_id（分区内帧号）
+ * @param {bool} read_from_disk 是否需要从磁盘读入新页面的内容，为false时将页面内容清零（new_page）
+ */
+void BufferPoolManager::update_page(Partition &part, std::unique_lock<std::mutex> &lock, Page *page,
+                                    PageId new_page_id, frame_id_t new_frame_id, bool read_from_disk) {
+    // 1 在latch下更新page table和page元数据，并将帧标记为正在I/O
+    // 2 释放latch，如果是脏页，写回磁盘；再读入新页面
+    // 3 重新获得latch，清除I/O标记并唤醒等待该帧的线程
+    FrameIO io = begin_frame_io(part, page, new_page_id, new_frame_id); // 1
 
-    page->reset_memory(); // 3
-    Page *newpage = pages_ + new_frame_id;
-    newpage->id_ = new_page_id;
-    newpage->pin_count_ = 1;
-    disk_manager_->read_page(new_page_id.fd, new_page_id.page_no, page->get_data(), PAGE_SIZE);
-    replacer_->pin(new_frame_id);
+    lock.unlock(); // 2
+    bool written = !io.write_back;
+    try {
+        if (io.write_back)
+            disk_manager_->write_page(io.old_page_id.fd, io.old_page_id.page_no, page->get_data(), PAGE_SIZE);
+        written = true;
+        page->reset_memory();
+        if (read_from_disk)
+            disk_manager_->read_page(new_page_id.fd, new_page_id.page_no, page->get_data(), PAGE_SIZE);
+    } catch (...) {
+        lock.lock();
+        abort_frame_io(io, written);
+        throw;
+    }
 
+    lock.lock(); // 3
+    finish_frame_io(io);
 }
 
 /**
@@ -70,30 +189,271 @@ void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t n
  * @param {PageId} page_id 需要获取的页的PageId
  */
 Page* BufferPoolManager::fetch_page(PageId page_id) {
-    //Todo:
-    // 1.     从page_table_中搜寻目标页
-    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
-    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // 2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
-    // 3.     调用disk_manager_的read_page读取目标页到frame
-    // 4.     固定目标页，更新pin_count_
-    // 5.     返回目标页
-    std::scoped_lock lock{latch_};
-
-    if ( page_table_.find(page_id) != page_table_.end() ){ // 1.1
-        Page *page = pages_ + page_table_[page_id];
-        if( page->pin_count_== 0 )
-            replacer_->pin( page_table_[page_id] );
-        page->pin_count_++;
-        return page;
-    }
+    // 0.     无锁查找page_table_，若目标页所在帧可以固定且不在I/O中，直接返回
+    // 1.     加锁后从page_table_中搜寻目标页
+    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，等待其I/O完成后返回目标页。
+    // 1.2    若目标页刚被淘汰且尚未写回，则等待写回完成后重新查找
+    // 1.3    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
+    // 2.     调用update_page将可能的脏页写回磁盘，并读取目标页到frame
+    // 3.     返回目标页
+    Partition &part = get_partition(page_id);
     frame_id_t frameid;
-    if( !find_victim_page(&frameid) ) // 1.2
+    if (part.page_table_->find(page_id, &frameid)) { // 0
+        Page *page = part.pages_ + frameid;
+        int pin_count = page->pin_count_.load();
+        while (pin_count >= 0 && !page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+        }
+        if (pin_count >= 0) {
+            // 固定后帧不会再被替换，此时检查查找到的帧是否仍是目标页
+            if (page->id_.load() == page_id && !page->io_pending_) {
+                if (page->prefetched_ && page->prefetched_.exchange(false)) {
+                    {
+                        std::scoped_lock lock{part.latch_};
+                        part.replacer_->remove(frameid); // 预读装入不算作访问
+                    }
+                    on_read_ahead_access(page_id, true);
+                }
+                return page;
+            }
+            std::scoped_lock lock{part.latch_};
+            release_frame(part, frameid);
+        }
+    }
+
+    std::unique_lock lock{part.latch_};
+    while (true) {
+        if (part.page_table_->find(page_id, &frameid)) { // 1.1
+            Page *page = part.pages_ + frameid;
+            if (page->pin_count_.fetch_add(1) == 0)
+                part.replacer_->pin(frameid);
+            wait_for_io(part, lock, page);
+            if (!(page->id_.load() == page_id)) { // 读入失败，帧已被归还，重新查找
+                release_frame(part, frameid);
+                continue;
+            }
+            if (page->prefetched_.exchange(false)) {
+                part.replacer_->remove(frameid); // 预读装入不算作访问
+                lock.unlock();
+                on_read_ahead_access(page_id, true);
+            }
+            return page;
+        }
+        if (!part.writing_back_.count(page_id)) // 1.2
+            break;
+        part.io_cv_.wait(lock);
+    }
+    if( !find_victim_page(part, &frameid) ) // 1.3
         return nullptr;
-    Page *page = pages_ + frameid;
-    update_page(page, page_id, frameid); // 2&3&4
+    Page *page = part.pages_ + frameid;
+    update_page(part, lock, page, page_id, frameid, true); // 2
+    lock.unlock();
+    on_read_ahead_access(page_id, false);
     return page;
-    
+}
+
+/**
+ * @description: 将一批帧替换中被替换的脏页合并为一批I/O写回，调用时不持有分区latch
+ * @return {vector<bool>} 每个帧上原来的页面是否已经写回（不需要写回的视为已写回）
+ */
+std::vector<bool> BufferPoolManager::write_back_frames(std::vector<FrameIO> &batch) {
+    std::vector<PageIORequest> writes;
+    for (auto &io : batch) {
+        if (io.write_back)
+            writes.push_back({io.old_page_id.fd, io.old_page_id.page_no, io.page->get_data(), PAGE_SIZE, true});
+    }
+    try {
+        disk_manager_->submit_pages(writes);
+    } catch (InternalError &) {
+        // 每个请求的结果在下面分别判断
+    }
+    std::vector<bool> written(batch.size());
+    for (size_t j = 0, w = 0; j < batch.size(); j++) {
+        written[j] = !batch[j].write_back || writes[w++].result == PAGE_SIZE;
+    }
+    return written;
+}
+
+/**
+ * @description: 将文件中[start_page_no, start_page_no + num_pages)范围内不在缓冲池中的页面预读进缓冲池。
+ * 页面号连续的页面合并为一次preadv读入，读入后不固定，并标记为prefetched_；预读尽力而为，失败时不抛出异常
+ * @return {size_t} 预读进缓冲池的页面数
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 第一个页面号
+ * @param {int} num_pages 页面个数
+ */
+size_t BufferPoolManager::prefetch_pages(int fd, page_id_t start_page_no, int num_pages) {
+    // 1. 逐页加锁：已在缓冲池中、正在写回、或所在分区没有可用帧的页面跳过，否则独占帧并更新元数据
+    // 2. 写回被替换的脏页，再将页面号连续的页面合并读入
+    // 3. 逐页加锁结束I/O，成功读入的页面标记为预读并交给replacer，失败的撤销替换
+    page_id_t file_pages = disk_manager_->get_fd2pageno(fd);
+    if (file_pages > 0) // 不预读文件末尾之后的页面
+        num_pages = std::min(num_pages, file_pages - start_page_no);
+    if (num_pages <= 0)
+        return 0;
+    {
+        std::scoped_lock lock{read_ahead_latch_};
+        read_ahead_states_[fd].next_prefetch = start_page_no + num_pages;
+    }
+    std::vector<FrameIO> batch;
+    for (page_id_t page_no = start_page_no; page_no < start_page_no + num_pages; page_no++) { // 1
+        PageId page_id = {fd, page_no};
+        Partition &part = get_partition(page_id);
+        std::scoped_lock lock{part.latch_};
+        frame_id_t frameid;
+        if (part.page_table_->find(page_id, &frameid) || part.writing_back_.count(page_id))
+            continue;
+        if (!find_victim_page(part, &frameid))
+            continue;
+        batch.push_back(begin_frame_io(part, part.pages_ + frameid, page_id, frameid));
+    }
+    if (batch.empty())
+        return 0;
+
+    std::vector<bool> written = write_back_frames(batch); // 2
+    std::vector<bool> read_ok(batch.size(), false);
+    for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+        if (!written[begin]) {
+            end = begin + 1;
+            continue;
+        }
+        std::vector<char *> bufs = {batch[begin].page->get_data()};
+        for (end = begin + 1; end < batch.size() && written[end]; end++) {
+            if (batch[end].new_page_id.page_no != batch[begin].new_page_id.page_no + static_cast<page_id_t>(end - begin))
+                break;
+            bufs.push_back(batch[end].page->get_data());
+        }
+        int pages_read = 0;
+        try {
+            pages_read = disk_manager_->read_pages_contiguous(fd, batch[begin].new_page_id.page_no, bufs);
+        } catch (RMDBError &) {
+        }
+        std::fill(read_ok.begin() + begin, read_ok.begin() + begin + pages_read, true);
+    }
+
+    size_t prefetched = 0; // 3
+    for (size_t j = 0; j < batch.size(); j++) {
+        FrameIO &io = batch[j];
+        std::scoped_lock lock{io.part->latch_};
+        if (read_ok[j]) {
+            io.page->prefetched_ = true;
+            finish_frame_io(io);
+            release_frame(*io.part, io.frame_id);
+            prefetched++;
+        } else {
+            abort_frame_io(io, written[j]);
+        }
+    }
+    prefetch_pages_ += prefetched;
+    return prefetched;
+}
+
+/**
+ * @description: 记录一次缺页或对预读页面的首次访问，检测到顺序访问时预读后续页面，调用时不持有分区latch
+ * 连续READ_AHEAD_TRIGGER次按页面号顺序缺页时，预读之后的一个窗口；
+ * 访问预读页面时，若已预读的范围不足半个窗口，继续预读下一个窗口
+ * @param {PageId} page_id 访问的页面
+ * @param {bool} prefetched_hit 是否为对预读页面的首次访问
+ */
+void BufferPoolManager::on_read_ahead_access(PageId page_id, bool prefetched_hit) {
+    if (prefetched_hit)
+        prefetch_hits_++;
+    int window = read_ahead_window_;
+    if (window <= 0)
+        return;
+    page_id_t start = INVALID_PAGE_ID;
+    {
+        std::scoped_lock lock{read_ahead_latch_};
+        ReadAheadState &state = read_ahead_states_[page_id.fd];
+        if (prefetched_hit) {
+            if (page_id.page_no + window / 2 >= state.next_prefetch)
+                start = std::max(state.next_prefetch, page_id.page_no + 1);
+        } else {
+            state.sequential_misses = page_id.page_no == state.last_miss + 1 ? state.sequential_misses + 1 : 0;
+            state.last_miss = page_id.page_no;
+            if (state.sequential_misses >= READ_AHEAD_TRIGGER)
+                start = page_id.page_no + 1;
+        }
+    }
+    if (start != INVALID_PAGE_ID)
+        prefetch_pages(page_id.fd, start, window);
+}
+
+/**
+ * @description: 批量获取页面，效果与对每个页面调用fetch_page相同，但所有缺页的脏页写回和页面读入分别合并为一批I/O同时提交
+ * @return {vector<Page*>} 与page_ids一一对应的页面，均已固定；无法获得可用帧的页面为nullptr
+ * @param {vector<PageId>&} page_ids 需要获取的页面
+ */
+std::vector<Page*> BufferPoolManager::fetch_pages(const std::vector<PageId> &page_ids) {
+    // 1. 逐个加锁查找页面：命中则固定；缺页则独占一个帧并更新元数据，将I/O记录到batch中
+    //    页面正在由其他线程（或本批次中先前的请求）读写时，留到批量I/O完成后再用fetch_page获取，避免等待自己
+    // 2. 释放所有latch，批量写回被淘汰的脏页，再批量读入缺页
+    // 3. 逐个加锁结束I/O；失败时撤销替换，并释放本批次固定的所有页面后抛出异常
+    std::vector<Page*> pages(page_ids.size(), nullptr);
+    std::vector<FrameIO> batch;
+    std::vector<size_t> batch_index;    // batch中每个I/O对应的page_ids下标
+    std::vector<size_t> deferred;       // 需要在批量I/O之后单独获取的page_ids下标
+
+    for (size_t i = 0; i < page_ids.size(); i++) { // 1
+        const PageId &page_id = page_ids[i];
+        Partition &part = get_partition(page_id);
+        std::unique_lock lock{part.latch_};
+        frame_id_t frameid;
+        if (part.page_table_->find(page_id, &frameid)) {
+            Page *page = part.pages_ + frameid;
+            if (page->io_pending_) {
+                deferred.push_back(i);
+                continue;
+            }
+            if (page->pin_count_.fetch_add(1) == 0)
+                part.replacer_->pin(frameid);
+            pages[i] = page;
+        } else if (part.writing_back_.count(page_id)) {
+            deferred.push_back(i);
+        } else if (find_victim_page(part, &frameid)) {
+            batch.push_back(begin_frame_io(part, part.pages_ + frameid, page_id, frameid));
+            batch_index.push_back(i);
+        }
+    }
+
+    std::vector<bool> written = write_back_frames(batch); // 2
+    bool failed = std::find(written.begin(), written.end(), false) != written.end();
+    std::vector<PageIORequest> reads;
+    for (size_t j = 0; j < batch.size(); j++) {
+        if (written[j]) {
+            batch[j].page->reset_memory();
+            reads.push_back({batch[j].new_page_id.fd, batch[j].new_page_id.page_no, batch[j].page->get_data(),
+                             PAGE_SIZE, false});
+        }
+    }
+    try {
+        disk_manager_->submit_pages(reads);
+    } catch (InternalError &) {
+        failed = true;
+    }
+
+    for (size_t j = 0, r = 0; j < batch.size(); j++) { // 3
+        FrameIO &io = batch[j];
+        bool read_ok = written[j] && reads[r++].result == PAGE_SIZE;
+        std::scoped_lock lock{io.part->latch_};
+        if (read_ok) {
+            finish_frame_io(io);
+            pages[batch_index[j]] = io.page;
+        } else {
+            abort_frame_io(io, written[j]);
+        }
+    }
+    if (failed) {
+        for (size_t i = 0; i < page_ids.size(); i++) {
+            if (pages[i] != nullptr)
+                unpin_page(page_ids[i], false);
+        }
+        throw InternalError("BufferPoolManager::fetch_pages Error");
+    }
+
+    for (size_t i : deferred) {
+        pages[i] = fetch_page(page_ids[i]);
+    }
+    return pages;
 }
 
 /**
@@ -103,7 +463,6 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    // Todo:
     // 0. lock latch
     // 1. 尝试在page_table_中搜寻page_id对应的页P
     // 1.1 P在页表中不存在 return false
@@ -112,18 +471,32 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     // 2.2 若pin_count_大于0，则pin_count_自减一
     // 2.2.1 若自减后等于0，则调用replacer_的unpin
     // 3 根据参数is_dirty，更改P的is_dirty_
-    std::scoped_lock lock{latch_};
-    if( page_table_.find(page_id) == page_table_.end() ) // 1.1
+    // pin_count_自减后仍大于0时不需要操作replacer，无锁完成
+    Partition &part = get_partition(page_id);
+    frame_id_t frameid;
+    if (part.page_table_->find(page_id, &frameid)) {
+        Page *page = part.pages_ + frameid;
+        if (page->id_.load() == page_id) {
+            if (is_dirty) // 调用者持有固定，帧不会被替换，可以先标记脏页
+                page->is_dirty_ = true;
+            int pin_count = page->pin_count_.load();
+            while (pin_count > 1 && !page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+            }
+            if (pin_count > 1)
+                return true;
+        }
+    }
+
+    std::scoped_lock lock{part.latch_};
+    if( !part.page_table_->find(page_id, &frameid) ) // 1.1
         return false;
 
-    Page *page = pages_ + page_table_[page_id];
+    Page *page = part.pages_ + frameid;
     if( page->pin_count_ <= 0 ) // 1.2
         return false;
-    page->pin_count_--;
-    if( !page->pin_count_ )
-        replacer_->unpin( page_table_[page_id] );
-
-    page->is_dirty_ = is_dirty; // 2
+    if( is_dirty ) // 3 已经是脏页的页面不会因为一次不修改的访问而变干净
+        page->is_dirty_ = true;
+    release_frame(part, frameid); // 2.2
     return true;
 }
 
@@ -133,21 +506,38 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
 bool BufferPoolManager::flush_page(PageId page_id) {
-    // Todo:
     // 0. lock latch
     // 1. 查找页表,尝试获取目标页P
     // 1.1 目标页P没有被page_table_记录 ，返回false
-    // 2. 无论P是否为脏都将其写回磁盘。
-    // 3. 更新P的is_dirty_
-   
-    std::scoped_lock lock{latch_};
-    if( page_table_.find(page_id) == page_table_.end() ) // 1
+    // 2. 固定P，使其在写回期间不会被淘汰，并先清除P的is_dirty_，写回期间的修改会在unpin时重新标记
+    // 3. 释放latch，无论P是否为脏都将其写回磁盘
+    // 4. 取消固定P
+    Partition &part = get_partition(page_id);
+    std::unique_lock lock{part.latch_};
+    frame_id_t frameid;
+    if( !part.page_table_->find(page_id, &frameid) ) // 1
         return false;
 
-    Page *page = pages_ + page_table_[page_id];
-    disk_manager_->write_page( page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE ); // 2
+    Page *page = part.pages_ + frameid;
+    if( page->pin_count_.fetch_add(1) == 0 ) // 2
+        part.replacer_->pin(frameid);
+    wait_for_io(part, lock, page);
+    bool was_dirty = page->is_dirty_;
+    page->is_dirty_ = false;
+
+    lock.unlock(); // 3
+    try {
+        disk_manager_->write_page( page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE );
+    } catch (...) {
+        lock.lock();
+        if (was_dirty)
+            page->is_dirty_ = true;
+        release_frame(part, frameid);
+        throw;
+    }
+    lock.lock();
 
-    page->is_dirty_ = false; // 3
+    release_frame(part, frameid); // 4
     return true;
 }
 
@@ -155,37 +545,34 @@ bool BufferPoolManager::flush_page(PageId page_id) {
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @note 分区模式下需要先分配页面号才能确定所在分区，若该分区没有可用帧，已分配的页面号不会被回收
  */
 Page* BufferPoolManager::new_page(PageId* page_id) {
-    // 1.   获得一个可用的frame，若无法获得则返回nullptr
-    // 2.   在fd对应的文件分配一个新的page_id
-    // 3.   将frame的数据写回磁盘
-    // 4.   固定frame，更新pin_count_
-    // 5.   返回获得的page
-    std::scoped_lock lock{latch_}; // 0
-
-    frame_id_t frameid;
-    if( !find_victim_page(&frameid) ) // 2
-        return nullptr;
-    Page *page = pages_ + frameid;
-
-    if( page->is_dirty_ ) {
-        disk_manager_->write_page( page->id_.fd, page->id_.page_no, page->get_data(), PAGE_SIZE );
-        page->pin_count_ = 0;
-        page->is_dirty_ = false;
+    // 1.   在fd对应的文件分配一个新的page_id，并确定其所在分区
+    // 2.   获得一个可用的frame，若无法获得则返回nullptr
+    // 3.   调用update_page将frame的数据写回磁盘，更新页表，固定frame
+    // 4.   返回获得的page
+    if (num_partitions_ == 1) {
+        // 单分区时先确认有可用帧再分配页面号，避免浪费页面号
+        std::unique_lock lock{partitions_[0].latch_};
+        frame_id_t frameid;
+        if( !find_victim_page(partitions_[0], &frameid) )
+            return nullptr;
+        page_id->page_no = disk_manager_->allocate_page(page_id->fd);
+        Page *page = partitions_[0].pages_ + frameid;
+        update_page(partitions_[0], lock, page, *page_id, frameid, false);
+        return page;
     }
-    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
 
-    page->reset_memory(); // 4.2
-
-    page_table_.erase( page->get_page_id() ); // 4.3
-    page_table_[*page_id] = frameid;
-
-    page->pin_count_ = 1; // 4.4
-
-    page->id_ = *page_id; // 5
-    replacer_->pin(frameid);
+    page_id->page_no = disk_manager_->allocate_page(page_id->fd); // 1
+    Partition &part = get_partition(*page_id);
+    std::unique_lock lock{part.latch_};
 
+    frame_id_t frameid;
+    if( !find_victim_page(part, &frameid) ) // 2
+        return nullptr;
+    Page *page = part.pages_ + frameid;
+    update_page(part, lock, page, *page_id, frameid, false); // 3
     return page;
 }
 
@@ -197,38 +584,215 @@ Page* BufferPoolManager::new_page(PageId* page_id) {
 bool BufferPoolManager::delete_page(PageId page_id) {
     // 1.   在page_table_中查找目标页，若不存在返回true
     // 2.   若目标页的pin_count不为0，则返回false
-    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-    
-    std::scoped_lock lock{latch_}; // 0
+    // 3.   从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
+    Partition &part = get_partition(page_id);
+    std::scoped_lock lock{part.latch_}; // 0
 
-    if( page_table_.find(page_id) == page_table_.end() ) // 2.1
+    frame_id_t frameid;
+    if( !part.page_table_->find(page_id, &frameid) ) // 1
         return true;
-    Page *page = pages_ + page_table_[page_id];
-    if( page->pin_count_ > 0 ) // 2.2
+    Page *page = part.pages_ + frameid;
+    if( !claim_frame(part, frameid) ) // 2
         return false;
     disk_manager_->deallocate_page(page_id.page_no);
 
-    free_list_.push_back( page_table_[page_id] ); // 3.1 remove
-    page_table_.erase(page_id);
+    part.replacer_->remove(frameid); // 3.1 remove
+    part.free_list_.push_back(frameid);
+    part.page_table_->erase(page_id);
 
     page->is_dirty_ = false; // 3.2 reset
+    page->prefetched_ = false;
+    page->id_ = {page_id.fd, INVALID_PAGE_ID};
     page->pin_count_ = 0;
-    page->id_.page_no = INVALID_PAGE_ID;
 
     return true;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中该文件的所有脏页写回到磁盘，每个分区中该文件的脏页合并为一批I/O同时提交
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    std::scoped_lock lock{latch_};
-    for (size_t i = 0; i < pool_size_; i++) {
-        Page *page = &pages_[i];
-        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
+    // 1. 加锁收集该文件的脏页：固定页面使其不会被替换，标记为正在I/O使其他线程获取页面时等待写回完成，并清除脏页标记
+    // 2. 释放latch后提交写回
+    // 3. 加锁清除I/O标记并释放固定，写回失败的页面重新标记为脏页
+    for (size_t i = 0; i < num_partitions_; i++) {
+        Partition &part = partitions_[i];
+        std::unique_lock lock{part.latch_};
+        part.io_cv_.wait(lock, [&part] { return !part.cleaning_; }); // 等待后台清理线程的写回完成，之后文件才能被关闭
+        std::vector<PageIORequest> requests; // 1
+        std::vector<Page *> flushed;
+        for (size_t j = 0; j < part.size_; j++) {
+            Page *page = &part.pages_[j];
+            if (page->get_page_id().fd != fd || page->get_page_id().page_no == INVALID_PAGE_ID)
+                continue;
+            wait_for_io(part, lock, page);
+            if (page->get_page_id().fd != fd || page->get_page_id().page_no == INVALID_PAGE_ID || !page->is_dirty_)
+                continue;
+            // 不通知replacer：写回不算作对页面的访问，帧在replacer中的位置保持不变
+            page->pin_count_.fetch_add(1);
+            page->io_pending_ = true;
+            // unpin_page无锁地标记脏页，写回期间的修改会重新标记，不会丢失
             page->is_dirty_ = false;
+            requests.push_back({fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE, true});
+            flushed.push_back(page);
+        }
+        if (flushed.empty())
+            continue;
+        lock.unlock(); // 2
+        std::exception_ptr error;
+        try {
+            disk_manager_->submit_pages(requests);
+        } catch (InternalError &) {
+            error = std::current_exception();
+        }
+
+        lock.lock(); // 3
+        for (size_t j = 0; j < flushed.size(); j++) {
+            Page *page = flushed[j];
+            frame_id_t frameid = static_cast<frame_id_t>(page - part.pages_);
+            if (requests[j].result != PAGE_SIZE)
+                page->is_dirty_ = true;
+            page->io_pending_ = false;
+            frame_id_t mapped;
+            if (page->pin_count_.fetch_sub(1) == 1 && part.page_table_->find(page->id_.load(), &mapped) && mapped == frameid)
+                part.replacer_->unpin(frameid);
+        }
+        part.io_cv_.notify_all();
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @description: 写回一个分区中未被固定的脏页，使分区中干净的帧（空闲帧和未被固定的干净页面）达到clean_target个
+ * @return {size_t} 写回的页面数
+ * @param {Partition&} part 分区
+ * @param {size_t} clean_target 分区中希望保持的干净帧个数
+ */
+size_t BufferPoolManager::clean_partition(Partition &part, size_t clean_target) {
+    // 1. 加锁统计干净帧个数，收集未被固定的脏页，按(fd, page_no)排序后选出需要写回的页面
+    // 2. 固定选出的页面并清除脏页标记，释放latch后按文件合并页面号连续的页面写回
+    // 3. 加锁释放固定，写回失败的页面重新标记为脏页
+    std::unique_lock lock{part.latch_};
+    if (part.cleaning_)
+        return 0;
+    size_t clean = part.free_list_.size(); // 1
+    std::vector<Page *> dirty;
+    for (size_t j = 0; j < part.size_; j++) {
+        Page *page = &part.pages_[j];
+        if (page->get_page_id().page_no == INVALID_PAGE_ID || page->pin_count_ != 0 || page->io_pending_)
+            continue;
+        if (page->is_dirty_)
+            dirty.push_back(page);
+        else
+            clean++;
+    }
+    if (clean >= clean_target || dirty.empty())
+        return 0;
+    std::sort(dirty.begin(), dirty.end(), [](Page *a, Page *b) {
+        PageId x = a->get_page_id(), y = b->get_page_id();
+        return x.fd != y.fd ? x.fd < y.fd : x.page_no < y.page_no;
+    });
+
+    std::vector<Page *> pages; // 2
+    for (Page *page : dirty) {
+        if (pages.size() >= clean_target - clean)
+            break;
+        // 不通知replacer：清理不算作对页面的访问，帧在replacer中的位置保持不变
+        int expected = 0;
+        if (!page->pin_count_.compare_exchange_strong(expected, 1))
+            continue;
+        page->is_dirty_ = false;
+        pages.push_back(page);
+    }
+    part.cleaning_ = true;
+    lock.unlock();
+
+    std::vector<bool> failed(pages.size(), false);
+    for (size_t begin = 0, end; begin < pages.size(); begin = end) {
+        PageId first = pages[begin]->get_page_id();
+        std::vector<char *> bufs = {pages[begin]->get_data()};
+        for (end = begin + 1; end < pages.size(); end++) {
+            PageId id = pages[end]->get_page_id();
+            if (id.fd != first.fd || id.page_no != first.page_no + static_cast<page_id_t>(end - begin))
+                break;
+            bufs.push_back(pages[end]->get_data());
+        }
+        try {
+            disk_manager_->write_pages_contiguous(first.fd, first.page_no, bufs);
+        } catch (RMDBError &) {
+            std::fill(failed.begin() + begin, failed.begin() + end, true);
         }
     }
-}
\ No newline at end of file
+
+    lock.lock(); // 3
+    size_t written = 0;
+    for (size_t i = 0; i < pages.size(); i++) {
+        Page *page = pages[i];
+        frame_id_t frameid = static_cast<frame_id_t>(page - part.pages_);
+        if (failed[i])
+            page->is_dirty_ = true;
+        else
+            written++;
+        frame_id_t mapped;
+        if (page->pin_count_.fetch_sub(1) == 1 && part.page_table_->find(page->id_.load(), &mapped) && mapped == frameid)
+            part.replacer_->unpin(frameid); // 若清理期间帧被选为victim而移出了replacer，重新加入
+    }
+    part.cleaning_ = false;
+    part.io_cv_.notify_all();
+    cleaner_writes_ += written;
+    return written;
+}
+
+/**
+ * @description: 对所有分区执行一轮清理，clean_target按各分区帧数比例分配
+ * @return {size_t} 写回的页面数
+ * @param {size_t} clean_target 整个缓冲池希望保持的干净帧个数
+ */
+size_t BufferPoolManager::clean_pages(size_t clean_target) {
+    size_t written = 0;
+    for (size_t i = 0; i < num_partitions_; i++) {
+        size_t target = (clean_target * partitions_[i].size_ + pool_size_ - 1) / pool_size_;
+        written += clean_partition(partitions_[i], target);
+    }
+    return written;
+}
+
+/**
+ * @description: 启动后台清理线程，每隔interval（或前台线程淘汰脏页时）执行一轮clean_pages
+ * @param {size_t} clean_target 整个缓冲池希望保持的干净帧个数
+ * @param {milliseconds} interval 两轮清理之间的间隔
+ */
+void BufferPoolManager::start_page_cleaner(size_t clean_target, std::chrono::milliseconds interval) {
+    stop_page_cleaner();
+    clean_target_ = clean_target;
+    cleaner_stop_ = false;
+    cleaner_thread_ = std::thread([this, interval]() {
+        std::unique_lock lock{cleaner_latch_};
+        while (!cleaner_stop_) {
+            lock.unlock();
+            try {
+                clean_pages(clean_target_);
+            } catch (RMDBError &) {
+                // 写回失败的页面仍为脏页，由下一轮清理或前台淘汰重试
+            }
+            lock.lock();
+            cleaner_cv_.wait_for(lock, interval);
+        }
+    });
+}
+
+/**
+ * @description: 停止后台清理线程，等待正在进行的一轮清理结束
+ */
+void BufferPoolManager::stop_page_cleaner() {
+    if (!cleaner_thread_.joinable())
+        return;
+    {
+        std::scoped_lock lock{cleaner_latch_};
+        cleaner_stop_ = true;
+    }
+    cleaner_cv_.notify_all();
+    cleaner_thread_.join();
+}
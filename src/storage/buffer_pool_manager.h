@@ -13,48 +13,144 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "disk_manager.h"
 #include "errors.h"
 #include "page.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
 
+/**
+ * @description: 缓冲池的统计计数
+ */
+struct BufferPoolStats {
+    uint64_t evictions;         // 替换掉缓冲池中已有页面的次数
+    uint64_t eviction_writes;   // 替换时被替换的页面是脏页、需要由前台线程同步写回的次数
+    uint64_t cleaner_writes;    // 后台清理线程写回的页面数
+    uint64_t prefetch_pages;    // 预读进缓冲池的页面数
+    uint64_t prefetch_hits;     // 预读的页面在被替换前被访问的次数
+    uint64_t prefetch_unused;   // 预读的页面直到被替换都没有被访问的次数
+};
+
 class BufferPoolManager {
    private:
+    /**
+     * @description: 缓冲池分区。每个分区独占一段连续的帧，拥有独立的latch、页表、空闲链表和替换器，
+     * 页面按照PageIdHash映射到固定的分区，不同分区上的操作互不阻塞
+     */
+    struct Partition {
+        Page *pages_;           // 分区内第0帧在pages_数组中的位置，分区内的帧号从0开始编号
+        size_t size_;           // 分区内帧的个数
+        PageTable *page_table_; // 页面号到分区内帧号的映射，命中时无锁查找，修改需持有latch_
+        std::list<frame_id_t> free_list_;   // 分区内空闲帧编号的链表
+        Replacer *replacer_;    // 分区内的置换策略
+        std::unordered_set<PageId, PageIdHash> writing_back_;   // 已被淘汰、但脏数据尚未写回磁盘的页面
+        std::mutex latch_;      // 用于分区内共享数据结构的并发控制，磁盘I/O不在latch保护下进行
+        std::condition_variable io_cv_;     // 用于等待分区内正在进行的磁盘I/O完成
+        bool cleaning_ = false;             // 后台清理线程正在写回分区内的页面
+    };
+
+    /**
+     * @description: 一次帧替换的信息：在latch下更新元数据之后、磁盘读写完成之前使用
+     */
+    struct FrameIO {
+        Partition *part;        // 帧所在的分区
+        Page *page;             // 帧
+        frame_id_t frame_id;    // 分区内帧号
+        PageId old_page_id;     // 帧上原来的页面
+        PageId new_page_id;     // 要读入的页面
+        bool write_back;        // 原来的页面是否为脏页，需要先写回
+    };
+
     size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
     Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    size_t num_partitions_; // 分区个数，为1时即为单latch的缓冲池
+    Partition *partitions_; // 分区数组，大小为num_partitions_
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+
+    std::atomic<uint64_t> evictions_ = 0;
+    std::atomic<uint64_t> eviction_writes_ = 0;
+    std::atomic<uint64_t> cleaner_writes_ = 0;
+    std::atomic<uint64_t> prefetch_pages_ = 0;
+    std::atomic<uint64_t> prefetch_hits_ = 0;
+    std::atomic<uint64_t> prefetch_unused_ = 0;
+
+    /**
+     * @description: 每个文件的顺序访问检测状态
+     */
+    struct ReadAheadState {
+        page_id_t last_miss = INVALID_PAGE_ID - 1;  // 上一次缺页的页面号
+        int sequential_misses = 0;                  // 按页面号顺序连续缺页的次数
+        page_id_t next_prefetch = 0;                // 已预读范围之后的第一个页面号
+    };
+    std::atomic<int> read_ahead_window_ = READ_AHEAD_WINDOW;    // 每次预读的页面数，为0时关闭自动预读
+    std::mutex read_ahead_latch_;                               // 保护read_ahead_states_
+    std::unordered_map<int, ReadAheadState> read_ahead_states_; // fd到顺序访问检测状态的映射
+
+    std::thread cleaner_thread_;            // 后台清理线程，写回未被固定的脏页，使缓冲池中保持一定数量的干净帧
+    std::mutex cleaner_latch_;              // 保护cleaner_stop_
+    std::condition_variable cleaner_cv_;    // 用于唤醒或停止后台清理线程
+    bool cleaner_stop_ = false;
+    size_t clean_target_ = 0;               // 整个缓冲池希望保持的干净帧（空闲或未被固定的干净页面）个数
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
+    /**
+     * @description: 创建缓冲池
+     * @param {size_t} pool_size 帧的个数
+     * @param {DiskManager*} disk_manager
+     * @param {size_t} num_partitions 分区个数，默认为1，即所有页面共享一个latch；大于1时帧被平均分配到各个分区
+     * @param {string} replacer_type 置换策略，可选"LRU"、"CLOCK"、"LRU-K"，默认为config.h中的REPLACER_TYPE
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_partitions = 1,
+                      const std::string &replacer_type = REPLACER_TYPE)
+        : pool_size_(pool_size), num_partitions_(num_partitions), disk_manager_(disk_manager) {
+        assert(num_partitions_ >= 1 && num_partitions_ <= pool_size_);
+        if (replacer_type != "LRU" && replacer_type != "CLOCK" && replacer_type != "LRU-K")
+            throw InternalError("BufferPoolManager: unknown replacer type " + replacer_type);
         // 为buffer pool分配一块连续的内存空间
         pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
-        }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        partitions_ = new Partition[num_partitions_];
+        size_t base = 0;
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            Partition &part = partitions_[i];
+            // 帧数不能整除分区数时，前pool_size_ % num_partitions_个分区各多分配一帧
+            part.size_ = pool_size_ / num_partitions_ + (i < pool_size_ % num_partitions_ ? 1 : 0);
+            part.pages_ = pages_ + base;
+            part.page_table_ = new PageTable(part.size_);
+            base += part.size_;
+            // 可以被Replacer改变
+            if (replacer_type == "LRU")
+                part.replacer_ = new LRUReplacer(part.size_);
+            else if (replacer_type == "CLOCK")
+                part.replacer_ = new ClockReplacer(part.size_);
+            else
+                part.replacer_ = new LRUKReplacer(part.size_);
+            // 初始化时，所有的page都在free_list_中
+            for (size_t j = 0; j < part.size_; ++j) {
+                part.free_list_.emplace_back(static_cast<frame_id_t>(j));  // static_cast转换数据类型
+            }
         }
     }
 
     ~BufferPoolManager() {
+        stop_page_cleaner();
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            delete partitions_[i].replacer_;
+            delete partitions_[i].page_table_;
+        }
+        delete[] partitions_;
         delete[] pages_;
-        delete replacer_;
     }
 
     /**
@@ -63,9 +159,26 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    size_t get_num_partitions() const { return num_partitions_; }
+
+    BufferPoolStats get_stats() const {
+        return {evictions_, eviction_writes_, cleaner_writes_, prefetch_pages_, prefetch_hits_, prefetch_unused_};
+    }
+
+    /**
+     * @description: 设置预读窗口，即每次预读的页面数，为0时关闭自动预读
+     */
+    void set_read_ahead_window(int window) { read_ahead_window_ = window; }
+
+    int get_read_ahead_window() const { return read_ahead_window_; }
+
    public: 
     Page* fetch_page(PageId page_id);
 
+    std::vector<Page*> fetch_pages(const std::vector<PageId> &page_ids);
+
+    size_t prefetch_pages(int fd, page_id_t start_page_no, int num_pages);
+
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
@@ -76,8 +189,35 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void start_page_cleaner(size_t clean_target, std::chrono::milliseconds interval);
+
+    void stop_page_cleaner();
+
+    size_t clean_pages(size_t clean_target);
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    Partition &get_partition(const PageId &page_id) { return partitions_[PageIdHash()(page_id) % num_partitions_]; }
+
+    bool find_victim_page(Partition &part, frame_id_t* frame_id);
+
+    void update_page(Partition &part, std::unique_lock<std::mutex> &lock, Page* page, PageId new_page_id,
+                     frame_id_t new_frame_id, bool read_from_disk);
+
+    FrameIO begin_frame_io(Partition &part, Page *page, PageId new_page_id, frame_id_t new_frame_id);
+
+    void finish_frame_io(FrameIO &io);
+
+    void abort_frame_io(FrameIO &io, bool written);
+
+    void wait_for_io(Partition &part, std::unique_lock<std::mutex> &lock, Page *page);
+
+    bool claim_frame(Partition &part, frame_id_t frame_id);
+
+    void release_frame(Partition &part, frame_id_t frame_id);
+
+    size_t clean_partition(Partition &part, size_t clean_target);
+
+    std::vector<bool> write_back_frames(std::vector<FrameIO> &batch);
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    void on_read_ahead_access(PageId page_id, bool prefetched_hit);
 };
\ No newline at end of file
@@ -11,13 +11,20 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <limits.h>    // for IOV_MAX
+#include <stdio.h>     // for rename
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for lseek, pread, pwrite
+
+#include <algorithm>
 
 #include "defs.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager() : io_backend_(IOBackend::create()) {
+    memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -28,12 +35,11 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用write()函数
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pwrite()函数，不修改文件偏移，缓冲池多个线程可以并发读写同一文件
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-    off_t offset_in_file = page_no * PAGE_SIZE;
-    lseek(fd, offset_in_file, SEEK_SET);
-    ssize_t bytes_written = write(fd, offset, num_bytes);
+    off_t offset_in_file = static_cast<off_t>(page_no) * PAGE_SIZE;
+    ssize_t bytes_written = pwrite(fd, offset, num_bytes, offset_in_file);
     if (bytes_written != num_bytes) {
         throw InternalError("DiskManager::write_page Error");
     }
@@ -49,18 +55,88 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    // 2.调用read()函数
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pread()函数，不修改文件偏移，缓冲池多个线程可以并发读写同一文件
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-    off_t offset_in_file = page_no * PAGE_SIZE;
-    lseek(fd, offset_in_file, SEEK_SET);
-    ssize_t bytes_read = read(fd, offset, num_bytes);
+    off_t offset_in_file = static_cast<off_t>(page_no) * PAGE_SIZE;
+    ssize_t bytes_read = pread(fd, offset, num_bytes, offset_in_file);
     if (bytes_read != num_bytes) {
         throw InternalError("DiskManager::read_page Error");
     }
 
 }
 
+/**
+ * @description: 批量读写页面，一批请求同时提交给I/O后端（io_uring可用时在内核中并发执行），全部完成后返回
+ * @param {vector<PageIORequest>&} requests 读写请求，完成后每个请求的result为实际读写的字节数
+ * @note 任一请求的读写字节数与num_bytes不等时 throw InternalError("DiskManager::submit_pages Error")，
+ * 此时其余请求也已完成，调用者可以根据result判断每个请求是否成功
+ */
+void DiskManager::submit_pages(std::vector<PageIORequest> &requests) {
+    if (requests.empty()) {
+        return;
+    }
+    io_backend_->submit_and_wait(requests.data(), requests.size());
+    for (auto &req : requests) {
+        if (req.result != req.num_bytes) {
+            throw InternalError("DiskManager::submit_pages Error");
+        }
+    }
+}
+
+/**
+ * @description: 将若干个页面写入文件中从start_page_no开始的连续页面，使用pwritev合并为尽量少的系统调用
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {vector<char*>&} bufs 每个页面的数据，每个页面大小为PAGE_SIZE
+ * @note 写入的字节数与预期不等时 throw InternalError("DiskManager::write_pages_contiguous Error");
+ */
+void DiskManager::write_pages_contiguous(int fd, page_id_t start_page_no, const std::vector<char *> &bufs) {
+    std::vector<iovec> iov(bufs.size());
+    for (size_t i = 0; i < bufs.size(); i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = PAGE_SIZE;
+    }
+    for (size_t begin = 0; begin < iov.size(); begin += IOV_MAX) {
+        int count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - begin));
+        off_t offset_in_file = static_cast<off_t>(start_page_no + begin) * PAGE_SIZE;
+        ssize_t bytes_written = pwritev(fd, iov.data() + begin, count, offset_in_file);
+        if (bytes_written != static_cast<ssize_t>(count) * PAGE_SIZE) {
+            throw InternalError("DiskManager::write_pages_contiguous Error");
+        }
+    }
+}
+
+/**
+ * @description: 从文件中start_page_no开始的连续页面读入若干个页面，使用preadv合并为尽量少的系统调用
+ * @return {int} 完整读入的页面数，读到文件末尾时可能少于bufs.size()
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {vector<char*>&} bufs 每个页面的读入地址，每个页面大小为PAGE_SIZE
+ * @note 读取出错时 throw InternalError("DiskManager::read_pages_contiguous Error");
+ */
+int DiskManager::read_pages_contiguous(int fd, page_id_t start_page_no, const std::vector<char *> &bufs) {
+    std::vector<iovec> iov(bufs.size());
+    for (size_t i = 0; i < bufs.size(); i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = PAGE_SIZE;
+    }
+    int pages_read = 0;
+    for (size_t begin = 0; begin < iov.size(); begin += IOV_MAX) {
+        int count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - begin));
+        off_t offset_in_file = static_cast<off_t>(start_page_no + begin) * PAGE_SIZE;
+        ssize_t bytes_read = preadv(fd, iov.data() + begin, count, offset_in_file);
+        if (bytes_read < 0) {
+            throw InternalError("DiskManager::read_pages_contiguous Error");
+        }
+        pages_read += static_cast<int>(bytes_read / PAGE_SIZE);
+        if (bytes_read != static_cast<ssize_t>(count) * PAGE_SIZE) {
+            break;
+        }
+    }
+    return pages_read;
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -145,6 +221,27 @@ void DiskManager::destroy_file(const std::string &path) {
     
 }
 
+/**
+ * @description: 重命名文件，new_path已经存在时会被替换
+ * @param {string} &old_path 原文件路径
+ * @param {string} &new_path 新文件路径
+ * @note 两个文件都不能处于打开状态
+ */
+void DiskManager::rename_file(const std::string &old_path, const std::string &new_path) {
+    if (!is_file(old_path)) {
+        throw FileNotFoundError(old_path);
+    }
+    if (path2fd_.count(old_path)) {
+        throw FileNotClosedError(old_path);
+    }
+    if (path2fd_.count(new_path)) {
+        throw FileNotClosedError(new_path);
+    }
+    if (rename(old_path.c_str(), new_path.c_str()) < 0) {
+        throw UnixError();
+    }
+}
+
 
 /**
  * @description: 打开指定路径文件 
@@ -17,11 +17,14 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 #include "errors.h"  
+#include "storage/io_backend.h"
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,6 +39,14 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void submit_pages(std::vector<PageIORequest> &requests);
+
+    void write_pages_contiguous(int fd, page_id_t start_page_no, const std::vector<char *> &bufs);
+
+    int read_pages_contiguous(int fd, page_id_t start_page_no, const std::vector<char *> &bufs);
+
+    const char *get_io_backend_name() const { return io_backend_->name(); }
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -54,6 +65,8 @@ class DiskManager {
 
     void destroy_file(const std::string &path);
 
+    void rename_file(const std::string &old_path, const std::string &new_path);
+
     int open_file(const std::string &path);
 
     void close_file(int fd);
@@ -95,5 +108,6 @@ class DiskManager {
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    std::unique_ptr<IOBackend> io_backend_;       // 批量页面读写使用的I/O后端
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
 };
\ No newline at end of file
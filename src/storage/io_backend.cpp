@@ -0,0 +1,251 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/io_backend.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define RMDB_HAVE_IO_URING 1
+#endif
+
+std::unique_ptr<IOBackend> IOBackend::create() {
+    if (auto backend = IOUringBackend::try_create()) {
+        return backend;
+    }
+    return std::make_unique<PosixIOBackend>();
+}
+
+/**
+ * @description: 逐个执行请求，使用pread/pwrite而不是lseek+read/write，多个线程可以并发读写同一文件
+ */
+void PosixIOBackend::submit_and_wait(PageIORequest *requests, size_t num_requests) {
+    for (size_t i = 0; i < num_requests; i++) {
+        PageIORequest &req = requests[i];
+        off_t offset = static_cast<off_t>(req.page_no) * PAGE_SIZE;
+        ssize_t bytes = req.is_write ? pwrite(req.fd, req.buf, req.num_bytes, offset)
+                                     : pread(req.fd, req.buf, req.num_bytes, offset);
+        req.result = bytes < 0 ? -errno : static_cast<int>(bytes);
+    }
+}
+
+#ifdef RMDB_HAVE_IO_URING
+
+/**
+ * @description: 一个io_uring实例，以及映射到用户态的提交队列(SQ)和完成队列(CQ)
+ */
+struct IOUringBackend::Ring {
+    int ring_fd = -1;
+    void *sq_ptr = MAP_FAILED;
+    void *cq_ptr = MAP_FAILED;
+    size_t sq_len = 0;
+    size_t cq_len = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqes_len = 0;
+    unsigned *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    io_uring_cqe *cqes;
+    unsigned sq_entries;
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_len);
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_len);
+        if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_len);
+        if (ring_fd >= 0) close(ring_fd);
+    }
+
+    /**
+     * @description: 创建io_uring实例并映射队列，失败时返回false
+     */
+    bool init(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0) return false;
+        // IORING_OP_READ/IORING_OP_WRITE需要5.6及以上的内核，与IORING_FEAT_NODROP同时引入
+        if (!(params.features & IORING_FEAT_NODROP)) return false;
+
+        sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_len = cq_len = std::max(sq_len, cq_len);
+
+        sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) return false;
+        if (single_mmap) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) return false;
+        }
+        sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(
+            mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) return false;
+
+        char *sq = static_cast<char *>(sq_ptr);
+        char *cq = static_cast<char *>(cq_ptr);
+        sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        sq_entries = params.sq_entries;
+        return true;
+    }
+
+    /**
+     * @description: 提交不超过sq_entries个请求，并等待已提交的请求全部完成
+     * @return {unsigned} 通过io_uring完成的请求个数，总是requests的一个前缀；
+     * io_uring_enter出错时，尚未提交的请求从提交队列中撤回，由调用者改用pread/pwrite完成
+     */
+    unsigned submit_and_wait(PageIORequest *requests, unsigned num_requests) {
+        unsigned tail = *sq_tail;
+        for (unsigned i = 0; i < num_requests; i++, tail++) {
+            PageIORequest &req = requests[i];
+            unsigned idx = tail & *sq_mask;
+            io_uring_sqe *sqe = &sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = req.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->fd = req.fd;
+            sqe->addr = reinterpret_cast<uint64_t>(req.buf);
+            sqe->len = static_cast<unsigned>(req.num_bytes);
+            sqe->off = static_cast<uint64_t>(req.page_no) * PAGE_SIZE;
+            sqe->user_data = i;
+            sq_array[idx] = idx;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        unsigned submitted = 0;     // 已被内核取走的请求个数，内核按顺序从提交队列中取出请求
+        unsigned completed = 0;
+        bool stop_submit = false;   // 出错后不再提交，只等待已提交的请求
+        while (completed < submitted || (!stop_submit && submitted < num_requests)) {
+            unsigned to_submit = stop_submit ? 0 : num_requests - submitted;
+            unsigned min_complete = (stop_submit ? submitted : num_requests) - completed;
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                                               IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret >= 0) {
+                submitted += static_cast<unsigned>(ret);
+            } else if (errno == EINTR || ((errno == EAGAIN || errno == EBUSY) && completed < submitted)) {
+                // 暂时性错误：被信号打断，或内核资源不足、需要等待已提交的请求完成后重试
+            } else if (!stop_submit) {
+                // 撤回尚未提交的请求；已提交的请求仍在内核中读写缓冲区，必须等待它们完成后才能返回
+                __atomic_store_n(sq_tail, tail - (num_requests - submitted), __ATOMIC_RELEASE);
+                stop_submit = true;
+            } else {
+                // io_uring_enter无法等待时直接检查完成队列，让出CPU期间内核会继续完成请求
+                sched_yield();
+            }
+            unsigned head = *cq_head;
+            while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                io_uring_cqe *cqe = &cqes[head & *cq_mask];
+                requests[cqe->user_data].result = cqe->res;
+                head++;
+                completed++;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return submitted;
+    }
+};
+
+IOUringBackend::~IOUringBackend() {
+    for (Ring *ring : all_rings_) {
+        delete ring;
+    }
+}
+
+std::unique_ptr<IOUringBackend> IOUringBackend::try_create() {
+    std::unique_ptr<IOUringBackend> backend(new IOUringBackend());
+    Ring *ring = backend->acquire_ring();
+    if (ring == nullptr) {
+        return nullptr;
+    }
+    backend->release_ring(ring);
+    return backend;
+}
+
+IOUringBackend::Ring *IOUringBackend::acquire_ring() {
+    {
+        std::scoped_lock lock{latch_};
+        if (!free_rings_.empty()) {
+            Ring *ring = free_rings_.back();
+            free_rings_.pop_back();
+            return ring;
+        }
+    }
+    Ring *ring = new Ring();
+    if (!ring->init(RING_ENTRIES)) {
+        delete ring;
+        return nullptr;
+    }
+    std::scoped_lock lock{latch_};
+    all_rings_.push_back(ring);
+    return ring;
+}
+
+void IOUringBackend::release_ring(Ring *ring) {
+    std::scoped_lock lock{latch_};
+    free_rings_.push_back(ring);
+}
+
+/**
+ * @description: 按提交队列的长度分批提交；无法取得io_uring实例或提交失败时，剩余请求改用pread/pwrite完成
+ */
+void IOUringBackend::submit_and_wait(PageIORequest *requests, size_t num_requests) {
+    if (num_requests == 1) {
+        // 单个请求直接使用pread/pwrite，少一次系统调用之外的开销
+        PosixIOBackend().submit_and_wait(requests, num_requests);
+        return;
+    }
+    Ring *ring = acquire_ring();
+    size_t done = 0;
+    if (ring != nullptr) {
+        while (done < num_requests) {
+            unsigned batch = static_cast<unsigned>(std::min<size_t>(num_requests - done, ring->sq_entries));
+            unsigned finished = ring->submit_and_wait(requests + done, batch);
+            done += finished;
+            if (finished < batch) break;
+        }
+        release_ring(ring);
+    }
+    if (done < num_requests) {
+        PosixIOBackend().submit_and_wait(requests + done, num_requests - done);
+    }
+}
+
+#else
+
+struct IOUringBackend::Ring {};
+
+IOUringBackend::~IOUringBackend() = default;
+
+std::unique_ptr<IOUringBackend> IOUringBackend::try_create() { return nullptr; }
+
+IOUringBackend::Ring *IOUringBackend::acquire_ring() { return nullptr; }
+
+void IOUringBackend::release_ring(Ring *) {}
+
+void IOUringBackend::submit_and_wait(PageIORequest *requests, size_t num_requests) {
+    PosixIOBackend().submit_and_wait(requests, num_requests);
+}
+
+#endif
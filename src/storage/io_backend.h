@@ -0,0 +1,96 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 一次页面读写请求
+ */
+struct PageIORequest {
+    int fd;                 // 磁盘文件的文件句柄
+    page_id_t page_no;      // 页面编号
+    char *buf;              // 读请求写入的目标地址，或写请求的数据来源
+    int num_bytes;          // 读写的数据大小
+    bool is_write;          // true为写请求，false为读请求
+    int result = 0;         // 完成后为实际读写的字节数，出错时为-errno
+};
+
+/**
+ * @description: 磁盘I/O后端，负责批量提交页面读写请求。
+ * 一批请求同时发出，全部完成后返回；不同线程可以并发提交各自的批次
+ */
+class IOBackend {
+   public:
+    IOBackend() = default;
+    virtual ~IOBackend() = default;
+
+    /**
+     * @description: 提交一批读写请求并等待全部完成，每个请求的结果写入其result字段。同一批次内的请求之间没有顺序保证
+     * @param {PageIORequest*} requests 请求数组
+     * @param {size_t} num_requests 请求个数
+     */
+    virtual void submit_and_wait(PageIORequest *requests, size_t num_requests) = 0;
+
+    virtual const char *name() const = 0;
+
+    /**
+     * @description: 创建当前系统上可用的I/O后端：优先使用io_uring，内核或编译环境不支持时使用pread/pwrite
+     */
+    static std::unique_ptr<IOBackend> create();
+};
+
+/**
+ * @description: 使用pread/pwrite逐个完成请求，在任何Linux系统上可用
+ */
+class PosixIOBackend : public IOBackend {
+   public:
+    void submit_and_wait(PageIORequest *requests, size_t num_requests) override;
+
+    const char *name() const override { return "pread/pwrite"; }
+};
+
+/**
+ * @description: 使用io_uring的I/O后端，一批请求通过一次io_uring_enter系统调用提交，在内核中并发执行。
+ * 每个io_uring实例同一时间只由一个线程使用：提交时从空闲链表中取出一个实例，用完后放回，不够时再创建
+ */
+class IOUringBackend : public IOBackend {
+   public:
+    ~IOUringBackend();
+
+    /**
+     * @description: 检查内核是否支持io_uring，不支持时返回nullptr
+     */
+    static std::unique_ptr<IOUringBackend> try_create();
+
+    void submit_and_wait(PageIORequest *requests, size_t num_requests) override;
+
+    const char *name() const override { return "io_uring"; }
+
+   private:
+    struct Ring;
+
+    static constexpr unsigned RING_ENTRIES = 64;    // 每个io_uring实例的提交队列长度，更大的批次分多次提交
+
+    IOUringBackend() = default;
+
+    Ring *acquire_ring();
+
+    void release_ring(Ring *ring);
+
+    std::mutex latch_;              // 保护free_rings_
+    std::vector<Ring *> free_rings_;    // 当前空闲的io_uring实例
+    std::vector<Ring *> all_rings_;     // 创建过的所有io_uring实例，析构时释放
+};
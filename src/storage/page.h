@@ -10,6 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+
 #include "common/config.h"
 
 /**
@@ -57,7 +63,7 @@ class Page {
 
     ~Page() = default;
 
-    PageId get_page_id() const { return id_; }
+    PageId get_page_id() const { return id_.load(); }
 
     inline char *get_data() { return data_; }
 
@@ -71,11 +77,20 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /** 页面读写latch，保护页面内容，用于B+树的latch crabbing；加latch前需要先pin住页面 */
+    inline void wlatch() { rwlatch_.lock(); }
+
+    inline void wunlatch() { rwlatch_.unlock(); }
+
+    inline void rlatch() { rwlatch_.lock_shared(); }
+
+    inline void runlatch() { rwlatch_.unlock_shared(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
-    /** page的唯一标识符 */
-    PageId id_;
+    /** page的唯一标识符，缓冲池命中时会在不持有latch的情况下读取 */
+    std::atomic<PageId> id_ = PageId{};
 
     /** The actual data that is stored within a page.
      *  该页面在bufferPool中的偏移地址
@@ -83,8 +98,17 @@ class Page {
     char data_[PAGE_SIZE] = {};
 
     /** 脏页判断 */
-    bool is_dirty_ = false;
+    std::atomic<bool> is_dirty_ = false;
+
+    /** The pin count of this page. 命中缓冲池时无锁地自增，-1表示帧正被淘汰或删除 */
+    std::atomic<int> pin_count_ = 0;
+
+    /** 帧上正在进行磁盘读写（淘汰写回或读入新页面），此时其他线程需要等待I/O完成后才能使用该页面 */
+    std::atomic<bool> io_pending_ = false;
+
+    /** 页面由预读装入缓冲池，之后尚未被访问过 */
+    std::atomic<bool> prefetched_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** 页面内容的读写latch */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
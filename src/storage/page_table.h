@@ -0,0 +1,163 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+#include "page.h"
+
+/**
+ * @description: 缓冲池的页表，记录PageId到帧号的映射。
+ * 容量固定的开放寻址哈希表（线性探测），容量为不小于最大表项数两倍的2的幂，不会扩容。
+ * 每个槽位带有一个版本号（seqlock）：写者通过CAS将版本号由偶数改为奇数来独占槽位，写完后再加一；
+ * 读者无需加锁，读取槽位前后版本号一致且为偶数时读到的内容才有效。
+ * 删除采用后移（backward shift）而不是墓碑，探测链不会因为反复插入删除而变长。
+ * @note 读操作find()可以与写操作并发执行；写操作insert()/erase()之间需要由调用者互斥（缓冲池中为分区latch）。
+ * 与写操作并发的find()可能返回false（假阴性），但不会返回错误的帧号，调用者此时应加锁后重新查找。
+ */
+class PageTable {
+   public:
+    /**
+     * @param {size_t} max_entries 表中最多同时存在的表项个数，即分区内的帧数
+     */
+    explicit PageTable(size_t max_entries) {
+        capacity_ = 2;
+        while (capacity_ < max_entries * 2) capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        slots_ = new Slot[capacity_];
+    }
+
+    ~PageTable() { delete[] slots_; }
+
+    PageTable(const PageTable &) = delete;
+    PageTable &operator=(const PageTable &) = delete;
+
+    /**
+     * @description: 无锁查找page_id对应的帧号
+     * @return {bool} 找到返回true；未找到或与写操作冲突时返回false
+     * @param {PageId&} page_id 目标页面
+     * @param {frame_id_t*} frame_id 找到时存储对应的帧号
+     */
+    bool find(const PageId &page_id, frame_id_t *frame_id) const {
+        uint64_t key = pack(page_id);
+        size_t idx = hash(key) & mask_;
+        for (size_t probe = 0; probe < capacity_; ++probe, idx = (idx + 1) & mask_) {
+            const Slot &slot = slots_[idx];
+            uint32_t version = slot.version_.load(std::memory_order_acquire);
+            if (version & 1) return false;  // 槽位正在被修改
+            uint64_t slot_key = slot.key_.load(std::memory_order_relaxed);
+            frame_id_t slot_frame = slot.frame_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version_.load(std::memory_order_relaxed) != version) return false;
+            if (slot_key == EMPTY_KEY) return false;
+            if (slot_key == key) {
+                *frame_id = slot_frame;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @description: 插入或更新page_id到frame_id的映射，调用者需保证写操作互斥
+     * @return {bool} 插入新表项返回true，更新已有表项返回false
+     */
+    bool insert(const PageId &page_id, frame_id_t frame_id) {
+        uint64_t key = pack(page_id);
+        size_t idx = hash(key) & mask_;
+        while (true) {
+            uint64_t slot_key = slots_[idx].key_.load(std::memory_order_relaxed);
+            if (slot_key == key || slot_key == EMPTY_KEY) {
+                write_slot(idx, key, frame_id);
+                if (slot_key == EMPTY_KEY) {
+                    ++size_;
+                    assert(size_ < capacity_);
+                    return true;
+                }
+                return false;
+            }
+            idx = (idx + 1) & mask_;
+        }
+    }
+
+    /**
+     * @description: 删除page_id的映射，并将其后探测链上的表项前移填补空位，调用者需保证写操作互斥
+     * @return {bool} 表项存在并被删除返回true，否则返回false
+     */
+    bool erase(const PageId &page_id) {
+        uint64_t key = pack(page_id);
+        size_t hole = hash(key) & mask_;
+        while (true) {
+            uint64_t slot_key = slots_[hole].key_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) return false;
+            if (slot_key == key) break;
+            hole = (hole + 1) & mask_;
+        }
+        // 后移删除：若后续表项的初始位置不在(hole, idx]之间，则把它移到hole处
+        for (size_t idx = (hole + 1) & mask_;; idx = (idx + 1) & mask_) {
+            uint64_t slot_key = slots_[idx].key_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) break;
+            size_t home = hash(slot_key) & mask_;
+            bool reachable = hole <= idx ? (hole < home && home <= idx) : (hole < home || home <= idx);
+            if (reachable) continue;
+            write_slot(hole, slot_key, slots_[idx].frame_.load(std::memory_order_relaxed));
+            hole = idx;
+        }
+        write_slot(hole, EMPTY_KEY, INVALID_FRAME_ID);
+        --size_;
+        return true;
+    }
+
+    size_t size() const { return size_; }
+
+    size_t capacity() const { return capacity_; }
+
+   private:
+    static constexpr uint64_t EMPTY_KEY = ~static_cast<uint64_t>(0);  // 即{fd = -1, page_no = -1}
+
+    struct Slot {
+        std::atomic<uint32_t> version_{0};
+        std::atomic<uint64_t> key_{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_{INVALID_FRAME_ID};
+    };
+
+    static uint64_t pack(const PageId &page_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+               static_cast<uint32_t>(page_id.page_no);
+    }
+
+    // 缓冲池按PageIdHash选择分区，同一分区内的PageIdHash低位相同，因此这里需要重新打散
+    static size_t hash(uint64_t key) {
+        key *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(key ^ (key >> 32));
+    }
+
+    void write_slot(size_t idx, uint64_t key, frame_id_t frame_id) {
+        Slot &slot = slots_[idx];
+        uint32_t version = slot.version_.load(std::memory_order_relaxed) & ~1u;
+        while (!slot.version_.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+            version &= ~1u;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.key_.store(key, std::memory_order_relaxed);
+        slot.frame_.store(frame_id, std::memory_order_relaxed);
+        slot.version_.store(version + 2, std::memory_order_release);
+    }
+
+    Slot *slots_;
+    size_t capacity_;
+    size_t mask_;
+    size_t size_ = 0;  // 只在写操作中修改
+};
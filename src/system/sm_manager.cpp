@@ -114,8 +114,18 @@ void SmManager::open_db(const std::string& db_name) {
         fhs_[tab_name] = rm_manager_->open_file(tab_name);
         //3.2加载索引(ix_manager)
         for (auto& index : db_.tabs_[tab_name].indexes) {
-            ihs_.emplace(ix_manager_->get_index_name(tab_name, index.cols),
-                         ix_manager_->open_index(tab_name, index.cols));
+            std::string ix_name = ix_manager_->get_index_name(tab_name, index.cols);
+            if (index.type == INDEX_HASH) {
+                hhs_.emplace(ix_name, ix_manager_->open_hash_index(tab_name, index.cols));
+            } else if (ix_manager_->get_file_version(tab_name, index.cols) != IX_FILE_VERSION) {
+                // 旧格式的B+树索引文件不能直接打开，用表中已有的记录重新构建
+                ix_manager_->destroy_index(tab_name, index.cols);
+                ix_manager_->create_index(tab_name, index.cols, index.unique);
+                ihs_.emplace(ix_name, ix_manager_->open_index(tab_name, index.cols));
+                load_index(tab_name, index.cols, ihs_.at(ix_name).get(), index.unique);
+            } else {
+                ihs_.emplace(ix_name, ix_manager_->open_index(tab_name, index.cols));
+            }
         }
     }
 }
@@ -146,12 +156,16 @@ void SmManager::close_db() {
         const IxIndexHandle* index_handle = entry.second.get();
         ix_manager_->close_index(index_handle);
     }
+    for (auto& entry : hhs_) {
+        ix_manager_->close_hash_index(entry.second.get());
+    }
 
     //3.删除已打开信息
     db_.name_.clear();
     db_.tabs_.clear();
     fhs_.clear();
     ihs_.clear();
+    hhs_.clear();
 
     //4.回到根目录
     if (chdir("..") < 0) {
@@ -255,14 +269,10 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
         //2.关闭并删除索引，清除索引记录
         for (auto& index : db_.tabs_[tab_name].indexes) {
             if (ix_manager_->exists(tab_name, index.cols)) {
-                //2.1关闭索引文件
-                std::string idx_name = ix_manager_->get_index_name(tab_name, index.cols);
-                const IxIndexHandle* ih = ihs_[idx_name].get();
-                ix_manager_->close_index(ih);
+                //2.1关闭索引文件，清除索引记录
+                close_index(tab_name, index);
                 //2.2删除索引文件
                 ix_manager_->destroy_index(tab_name, index.cols);
-                //2.3清除索引记录
-                ihs_.erase(idx_name);
             }
         }
         //3.清除表信息
@@ -279,11 +289,14 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {IndexType} type 索引的类型（CREATE INDEX ... USING HASH创建哈希索引），一组字段上只能建一个索引
+ * @param {bool} unique 是否为唯一索引（CREATE UNIQUE INDEX），表中已有重复的key时 throw UniqueConstraintError
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             IndexType type, bool unique) {
     //Lab3 Task1 Todo
     //1.检查索引是否已经存在，如果已经存在则throw一个Error
-    if (ix_manager_->exists(tab_name, col_names)) {
+    if (ix_manager_->exists(tab_name, col_names) || db_.get_table(tab_name).is_index(col_names)) {
         throw IndexExistsError(tab_name, col_names);
     }
     //2.1获取要索引的列的元数据，注意，同时get表名和列名
@@ -291,12 +304,6 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     for (auto& col_name : col_names) {
         index_cols.push_back(*(db_.get_table(tab_name).get_col(col_name)));
     }
-    //2.2调用IxManager的方法建立索引
-    ix_manager_->create_index(tab_name, index_cols);
-    //2.3打开索引并放入ihs中
-    std::string ix_name = ix_manager_->get_index_name(tab_name, col_names);
-    ihs_.emplace(ix_name, ix_manager_->open_index(tab_name, col_names));
-    //3.更新表上建立的索引(indexes)
     IndexMeta idx_meta;
     idx_meta.tab_name = tab_name;
     idx_meta.col_tot_len = 0;
@@ -305,7 +312,34 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
     }
     idx_meta.col_num = index_cols.size();
     idx_meta.cols = index_cols;
+    idx_meta.type = type;
+    idx_meta.unique = unique;
 
+    std::string ix_name = ix_manager_->get_index_name(tab_name, col_names);
+    if (type == INDEX_HASH) {
+        //2.2建立哈希索引，打开后放入hhs中
+        ix_manager_->create_hash_index(tab_name, index_cols);
+        hhs_.emplace(ix_name, ix_manager_->open_hash_index(tab_name, index_cols));
+    } else {
+        //2.2调用IxManager的方法建立索引
+        ix_manager_->create_index(tab_name, index_cols, unique);
+        //2.3打开索引并放入ihs中
+        ihs_.emplace(ix_name, ix_manager_->open_index(tab_name, col_names));
+    }
+    //2.4扫描表中已有的记录：B+树排序后自底向上批量构建，哈希索引逐条插入
+    //    唯一索引遇到重复的key时删除建了一半的索引
+    try {
+        if (type == INDEX_HASH) {
+            load_index(tab_name, index_cols, hhs_.at(ix_name).get(), unique);
+        } else {
+            load_index(tab_name, index_cols, ihs_.at(ix_name).get(), unique);
+        }
+    } catch (UniqueConstraintError&) {
+        close_index(tab_name, idx_meta);
+        ix_manager_->destroy_index(tab_name, index_cols);
+        throw;
+    }
+    //3.更新表上建立的索引(indexes)
     db_.tabs_[tab_name].indexes.push_back(idx_meta);
 }
 
@@ -323,16 +357,12 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
     if (!col->index) {
         throw IndexNotFoundError(tab_name, col_name);
     }*/
-    //1.关闭索引文件
-    std::string idx_name = ix_manager_->get_index_name(tab_name, col_names);
-    const IxIndexHandle* ih = ihs_[idx_name].get();
-    ix_manager_->close_index(ih);
+    auto idx_meta = db_.get_table(tab_name).get_index_meta(col_names);
+    //1.关闭索引文件，从ihs/hhs中清除索引
+    close_index(tab_name, *idx_meta);
     //2.删除索引文件
     ix_manager_->destroy_index(tab_name, col_names);
-    //3.从ihs中清除索引
-    ihs_.erase(ix_manager_->get_index_name(tab_name, col_names));
-    //4.更新表上建立的索引
-    auto idx_meta = db_.get_table(tab_name).get_index_meta(col_names);
+    //3.更新表上建立的索引
     db_.get_table(tab_name).indexes.erase(idx_meta);
 }
 
@@ -353,4 +383,121 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
     // 更新indexes
     auto idx_meta = db_.get_table(tab_name).//indexes;
     db_.get_table(tab_name).indexes.erase(idx_meta);
-}*/
\ No newline at end of file
+}*/
+
+/**
+ * @description: 重建索引(REINDEX)，回收删除操作留下的空闲页面并让结点重新按填充因子排列
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称，为空时重建表上的所有索引
+ * @param {Context*} context
+ * @note 与其他DDL语句一样由调用者独占ddl_latch_，重建期间其他语句都不能执行，原索引的句柄可以直接关闭。
+ * 新的B+树先在临时文件中批量构建，构建完成后再替换原索引文件，中途失败时原索引不受影响；哈希索引则是删除后原地重建
+ */
+void SmManager::reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+    TabMeta& tab = db_.get_table(tab_name);
+    std::vector<IndexMeta> indexes;
+    if (col_names.empty()) {
+        indexes = tab.indexes;
+    } else if (tab.is_index(col_names)) {
+        indexes.push_back(*tab.get_index_meta(col_names));
+    } else {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
+    for (auto& index : indexes) {
+        std::string ix_name = ix_manager_->get_index_name(tab_name, index.cols);
+        if (index.type == INDEX_HASH) {
+            // 哈希索引关闭并删除原索引后重新插入所有记录，目录和桶按现有的记录重新增长，旧文件中的空闲页面随文件一起删除
+            close_index(tab_name, index);
+            ix_manager_->destroy_index(tab_name, index.cols);
+            ix_manager_->create_hash_index(tab_name, index.cols);
+            hhs_.emplace(ix_name, ix_manager_->open_hash_index(tab_name, index.cols));
+            load_index(tab_name, index.cols, hhs_.at(ix_name).get(), index.unique);
+            continue;
+        }
+        IxIndexHandle* ih = ihs_.at(ix_name).get();
+        auto rebuilt = ix_manager_->create_rebuild_index(tab_name, index.cols, ih);
+        load_index(tab_name, index.cols, rebuilt.get(), index.unique);
+        ihs_[ix_name] = ix_manager_->replace_index(tab_name, index.cols, ih, rebuilt.get());
+    }
+}
+
+/* 索引字段的名称，用于唯一约束的报错信息 */
+static std::vector<std::string> index_col_names(const std::vector<ColMeta>& index_cols) {
+    std::vector<std::string> col_names;
+    for (auto& col : index_cols) {
+        col_names.push_back(col.name);
+    }
+    return col_names;
+}
+
+/**
+ * @description: 扫描表中已有的记录，排序后自底向上批量构建B+树
+ * @param {string&} tab_name 表名称
+ * @param {vector<ColMeta>&} index_cols 索引包含的字段
+ * @param {IxIndexHandle*} ih 空的索引
+ * @param {bool} unique 是否为唯一索引，有重复的key时 throw UniqueConstraintError
+ */
+void SmManager::load_index(const std::string& tab_name, const std::vector<ColMeta>& index_cols, IxIndexHandle* ih,
+                           bool unique) {
+    IxBulkLoader loader(ih);
+    size_t num_records = 0;
+    scan_index_keys(tab_name, index_cols, [&](const char* key, const Rid& rid) {
+        loader.add(key, rid);
+        num_records++;
+    });
+    // 重复的key只会写入一条
+    if (loader.finish() < num_records && unique) {
+        throw UniqueConstraintError(tab_name, index_col_names(index_cols));
+    }
+}
+
+/**
+ * @description: 扫描表中已有的记录，逐条插入哈希索引
+ * @param {IxHashHandle*} hh 空的哈希索引
+ * @param {bool} unique 是否为唯一索引，有重复的key时 throw UniqueConstraintError
+ */
+void SmManager::load_index(const std::string& tab_name, const std::vector<ColMeta>& index_cols, IxHashHandle* hh,
+                           bool unique) {
+    std::vector<Rid> rids;
+    scan_index_keys(tab_name, index_cols, [&](const char* key, const Rid& rid) {
+        if (unique && hh->get_value(key, &rids, nullptr)) {
+            throw UniqueConstraintError(tab_name, index_col_names(index_cols));
+        }
+        hh->insert_entry(key, rid, nullptr);
+    });
+}
+
+/**
+ * @description: 扫描表中的所有记录，对每条记录按索引字段的顺序拼接出key，与记录的rid一起交给visit
+ */
+void SmManager::scan_index_keys(const std::string& tab_name, const std::vector<ColMeta>& index_cols,
+                                const std::function<void(const char*, const Rid&)>& visit) {
+    int col_tot_len = 0;
+    for (auto& col : index_cols) {
+        col_tot_len += col.len;
+    }
+    std::vector<char> key(col_tot_len);
+    for (RmScan scan(fhs_.at(tab_name).get()); !scan.is_end(); scan.next()) {
+        const char* record = scan.record();
+        int offset = 0;
+        for (auto& col : index_cols) {
+            memcpy(key.data() + offset, record + col.offset, col.len);
+            offset += col.len;
+        }
+        visit(key.data(), scan.rid());
+    }
+}
+
+/**
+ * @description: 按索引的类型关闭索引文件，并从ihs/hhs中清除
+ */
+void SmManager::close_index(const std::string& tab_name, const IndexMeta& index) {
+    std::string ix_name = ix_manager_->get_index_name(tab_name, index.cols);
+    if (index.type == INDEX_HASH) {
+        ix_manager_->close_hash_index(hhs_.at(ix_name).get());
+        hhs_.erase(ix_name);
+    } else {
+        ix_manager_->close_index(ihs_.at(ix_name).get());
+        ihs_.erase(ix_name);
+    }
+}
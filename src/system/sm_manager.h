@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <functional>
+#include <shared_mutex>
+
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
@@ -30,6 +33,9 @@ class SmManager {
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxHashHandle>> hhs_;    // file name -> hash index handle, 当前数据库中每个哈希索引的文件
+    // DDL语句执行期间独占，其他语句执行期间共享：DDL会修改db_、fhs_、ihs_和hhs_，并关闭其他语句可能正在使用的文件
+    std::shared_mutex ddl_latch_;
    private:
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
@@ -72,9 +78,23 @@ class SmManager {
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    // 与SQL的CREATE INDEX一致，默认创建非唯一索引
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      IndexType type = INDEX_BTREE, bool unique = false);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+   private:
+    void load_index(const std::string& tab_name, const std::vector<ColMeta>& index_cols, IxIndexHandle* ih, bool unique);
+
+    void load_index(const std::string& tab_name, const std::vector<ColMeta>& index_cols, IxHashHandle* hh, bool unique);
+
+    void scan_index_keys(const std::string& tab_name, const std::vector<ColMeta>& index_cols,
+                         const std::function<void(const char*, const Rid&)>& visit);
+
+    void close_index(const std::string& tab_name, const IndexMeta& index);
 };
\ No newline at end of file
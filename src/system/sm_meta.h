@@ -11,8 +11,12 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -45,9 +49,46 @@ struct IndexMeta {
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
+    IndexType type = INDEX_BTREE;   // 索引的类型：B+树或者哈希索引
+    bool unique = false;            // 是否为唯一索引：插入和更新记录时检查key是否已经存在
+
+    /* 从记录中取出索引字段，按索引字段的顺序拼接成key，key的长度为col_tot_len */
+    void get_key(const char *record, char *key) const {
+        int offset = 0;
+        for(auto& col: cols) {
+            memcpy(key + offset, record + col.offset, col.len);
+            offset += col.len;
+        }
+    }
+
+    /* 把key中从第from个索引字段开始的所有字段设为该类型的最大值（is_max为true）或最小值，用来构造范围查找的边界 */
+    void fill_key_bound(char *key, size_t from, bool is_max) const {
+        int offset = 0;
+        for(size_t i = 0; i < cols.size(); ++i) {
+            if(i >= from) {
+                if(cols[i].type == TYPE_INT) {
+                    *(int *)(key + offset) = is_max ? INT_MAX : INT_MIN;
+                } else if(cols[i].type == TYPE_FLOAT) {
+                    *(float *)(key + offset) = is_max ? INFINITY : -INFINITY;
+                } else {
+                    memset(key + offset, is_max ? 0xff : 0, cols[i].len);
+                }
+            }
+            offset += cols[i].len;
+        }
+    }
+
+    std::vector<std::string> get_col_names() const {
+        std::vector<std::string> col_names;
+        for(auto& col: cols) {
+            col_names.push_back(col.name);
+        }
+        return col_names;
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num << " " << index.type << " "
+           << index.unique;
         for(auto& col: index.cols) {
             os << "\n" << col;
         }
@@ -56,6 +97,14 @@ struct IndexMeta {
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
         is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        // 索引的类型和唯一性与col_num在同一行；旧版本的db.meta中没有这两项，按原来的B+树读入，原来的B+树是唯一索引
+        std::string rest;
+        std::getline(is, rest);
+        std::istringstream rest_is(rest);
+        if(!(rest_is >> index.type >> index.unique)) {
+            index.type = INDEX_BTREE;
+            index.unique = true;
+        }
         for(int i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
@@ -76,6 +125,7 @@ struct TabMeta {
     TabMeta(const TabMeta &other) {
         name = other.name;
         for(auto col : other.cols) cols.push_back(col);
+        for(auto &index : other.indexes) indexes.push_back(index);
     }
 
     /* 判断当前表中是否存在名为col_name的字段 */
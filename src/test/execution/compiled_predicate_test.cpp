@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution_test.h"
+#include "index/ix_index_handle.h"
+
+/** CompiledPredicate的结果与逐条按字段名查找字段、用ix_compare比较后再按运算符判断的结果完全相同：
+ * INT、FLOAT、STRING三种类型，六种比较运算符，字段与常量比较以及字段与字段比较 */
+
+static const std::vector<CompOp> ALL_OPS = {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE};
+
+// 连接后的记录的字段：左表"l"在前，右表"r"在后
+std::vector<ColMeta> make_join_cols() {
+    auto cols = make_cols("l");
+    for (auto &col : make_cols("r")) {
+        col.offset += TEST_TUPLE_LEN;
+        cols.push_back(col);
+    }
+    return cols;
+}
+
+// 对照实现：按字段名查找字段，用ix_compare比较后按运算符判断
+bool eval_conds(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols, const char *record) {
+    auto find_col = [&](const TabCol &target) {
+        return *std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) {
+            return col.tab_name == target.tab_name && col.name == target.col_name;
+        });
+    };
+    for (auto &cond : conds) {
+        ColMeta lhs_col = find_col(cond.lhs_col);
+        const char *rhs = cond.is_rhs_val ? cond.rhs_val.raw->data : record + find_col(cond.rhs_col).offset;
+        int cmp = ix_compare(record + lhs_col.offset, rhs, lhs_col.type, lhs_col.len);
+        bool res;
+        switch (cond.op) {
+            case OP_EQ: res = cmp == 0; break;
+            case OP_NE: res = cmp != 0; break;
+            case OP_LT: res = cmp < 0; break;
+            case OP_GT: res = cmp > 0; break;
+            case OP_LE: res = cmp <= 0; break;
+            default: res = cmp >= 0; break;
+        }
+        if (!res) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 表"l"的字段col_name与常量val比较的条件
+Condition val_cond(const std::string &col_name, CompOp op, Value val, int len) {
+    Condition cond;
+    cond.lhs_col = {"l", col_name};
+    cond.op = op;
+    cond.is_rhs_val = true;
+    val.init_raw(len);
+    cond.rhs_val = std::move(val);
+    return cond;
+}
+
+/**
+ * @brief 用eval()和filter()分别对每条记录求值，与对照实现比较；返回满足条件的记录数
+ */
+size_t check_conds(const std::vector<Condition> &conds, const std::vector<ColMeta> &cols,
+                   const std::vector<std::string> &records) {
+    CompiledPredicate pred(conds, cols);
+    size_t tuple_len = records.front().size();
+    RecordBatch batch(tuple_len);
+    size_t num_matches = 0;
+    for (auto &record : records) {
+        bool expected = eval_conds(conds, cols, record.data());
+        EXPECT_EQ(expected, pred.eval(record.data()));
+        num_matches += expected;
+        if (batch.is_full()) {
+            pred.filter(batch);
+            batch.clear();
+        }
+        memcpy(batch.append_row(), record.data(), tuple_len);
+    }
+    // 最后一个batch：被保留的行恰好是满足条件的行
+    size_t offset = records.size() - batch.num_rows();
+    pred.filter(batch);
+    std::vector<uint16_t> expected_sel;
+    for (size_t i = 0; i < batch.num_rows(); i++) {
+        if (eval_conds(conds, cols, records[offset + i].data())) {
+            expected_sel.push_back(static_cast<uint16_t>(i));
+        }
+    }
+    EXPECT_EQ(expected_sel, batch.sel());
+    return num_matches;
+}
+
+/**
+ * @brief 字段与常量比较：常量取到字段的最小值、最大值以及中间的值
+ */
+TEST(CompiledPredicateTest, ColumnValueTest) {
+    auto rng = std::default_random_engine{2023};
+    const int num_keys = 20;
+    auto rows = make_rows(2000, num_keys, rng);
+    auto cols = make_cols("l");
+    for (int key : {-num_keys / 2 - 1, -num_keys / 2, -1, 0, 3, num_keys / 2 - 1, num_keys / 2}) {
+        for (CompOp op : ALL_OPS) {
+            Value int_val, float_val, str_val;
+            int_val.set_int(key);
+            float_val.set_float(key == 0 ? -0.0f : static_cast<float>(key) / 2);
+            char s[16];
+            snprintf(s, sizeof(s), "s%07d", key + num_keys);
+            str_val.set_str(s);
+            check_conds({val_cond("k", op, int_val, sizeof(int))}, cols, rows);
+            check_conds({val_cond("f", op, float_val, sizeof(float))}, cols, rows);
+            check_conds({val_cond("s", op, str_val, 8)}, cols, rows);
+        }
+    }
+}
+
+/**
+ * @brief 字段与字段比较：左表和右表的同名字段比较，以及同一条记录内两个INT字段的比较
+ */
+TEST(CompiledPredicateTest, ColumnColumnTest) {
+    auto rng = std::default_random_engine{2024};
+    const int num_keys = 10;
+    auto left_rows = make_rows(60, num_keys, rng);
+    auto right_rows = make_rows(60, num_keys, rng);
+    std::vector<std::string> records;
+    for (auto &l : left_rows) {
+        for (auto &r : right_rows) {
+            records.push_back(l + r);
+        }
+    }
+    auto cols = make_join_cols();
+    for (CompOp op : ALL_OPS) {
+        for (auto &col_name : {"k", "f", "s"}) {
+            size_t num_matches = check_conds({col_cond(col_name, op, col_name)}, cols, records);
+            if (op != OP_NE) {
+                EXPECT_GT(num_matches, 0);
+            }
+        }
+        Condition cond = col_cond("k", op, "v");
+        cond.rhs_col.tab_name = "l";
+        check_conds({cond}, cols, records);
+    }
+}
+
+/**
+ * @brief 多个条件之间为AND关系，字段与常量、字段与字段的条件混合
+ */
+TEST(CompiledPredicateTest, ConjunctionTest) {
+    auto rng = std::default_random_engine{2025};
+    const int num_keys = 10;
+    auto left_rows = make_rows(50, num_keys, rng);
+    auto right_rows = make_rows(50, num_keys, rng);
+    std::vector<std::string> records;
+    for (auto &l : left_rows) {
+        for (auto &r : right_rows) {
+            records.push_back(l + r);
+        }
+    }
+    auto cols = make_join_cols();
+    Value int_val, float_val;
+    int_val.set_int(0);
+    float_val.set_float(1.0f);
+    for (CompOp op : ALL_OPS) {
+        check_conds({col_cond("k", OP_EQ, "k"), val_cond("f", op, float_val, sizeof(float))}, cols, records);
+        check_conds({val_cond("k", op, int_val, sizeof(int)), col_cond("f", OP_LE, "f"), col_cond("s", op, "s")},
+                    cols, records);
+    }
+    // 没有条件时所有记录都满足
+    EXPECT_EQ(records.size(), check_conds({}, cols, records));
+    // 条件中的字段不存在
+    EXPECT_THROW(CompiledPredicate({col_cond("x", OP_EQ, "k")}, cols), ColumnNotFoundError);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "execution/execution_predicate.h"
+#include "execution/executor_abstract.h"
+
+/** 执行算子测试共用的数据源、测试数据和对照结果。
+ * 测试表的字段都是(k int, f float, s char(8), v int)，记录为TEST_TUPLE_LEN字节的std::string，
+ * 连接测试中左表名为"l"，右表名为"r" */
+
+static constexpr int TEST_TUPLE_LEN = 20;
+
+// 测试用的数据源：按顺序返回内存中的记录，只实现逐条接口，批量接口使用AbstractExecutor的默认实现；记录扫描的次数
+class VectorExecutor : public AbstractExecutor {
+   public:
+    VectorExecutor(std::vector<ColMeta> cols, std::vector<std::string> rows) : cols_(std::move(cols)), rows_(std::move(rows)) {
+        len_ = cols_.back().offset + cols_.back().len;
+    }
+
+    void beginTuple() override {
+        pos_ = 0;
+        num_scans_++;
+    }
+
+    void nextTuple() override { pos_++; }
+
+    bool is_end() const override { return pos_ >= rows_.size(); }
+
+    std::unique_ptr<RmRecord> Next() override {
+        return std::make_unique<RmRecord>(static_cast<int>(len_), rows_[pos_].data());
+    }
+
+    Rid &rid() override { return _abstract_rid; }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    int num_scans() const { return num_scans_; }
+
+   private:
+    std::vector<ColMeta> cols_;
+    std::vector<std::string> rows_;
+    size_t len_;
+    size_t pos_ = 0;
+    int num_scans_ = 0;
+};
+
+// 表tab_name的字段为(k int, f float, s char(8), v int)
+inline std::vector<ColMeta> make_cols(const std::string &tab_name) {
+    return {{tab_name, "k", TYPE_INT, 4, 0, false},
+            {tab_name, "f", TYPE_FLOAT, 4, 4, false},
+            {tab_name, "s", TYPE_STRING, 8, 8, false},
+            {tab_name, "v", TYPE_INT, 4, 16, false}};
+}
+
+/**
+ * @description: 生成num_rows条记录：k和f各自有num_keys种取值（包括负数），f中的0一半为-0.0；
+ * s由k决定，并且与k的顺序一致；v为记录的序号
+ */
+inline std::vector<std::string> make_rows(int num_rows, int num_keys, std::default_random_engine &rng) {
+    std::uniform_int_distribution<int> dist(-num_keys / 2, num_keys - num_keys / 2 - 1);
+    std::vector<std::string> rows;
+    for (int i = 0; i < num_rows; i++) {
+        int key = dist(rng);
+        float f = static_cast<float>(dist(rng)) / 2;
+        if (f == 0.0f && i % 2 == 0) {
+            f = -0.0f;
+        }
+        char s[9];
+        snprintf(s, sizeof(s), "s%07d", key + num_keys);
+        std::string row(TEST_TUPLE_LEN, '\0');
+        memcpy(&row[0], &key, sizeof(int));
+        memcpy(&row[4], &f, sizeof(float));
+        memcpy(&row[8], s, 8);
+        memcpy(&row[16], &i, sizeof(int));
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// 左表字段lhs_col与右表字段rhs_col比较的连接条件
+inline Condition col_cond(const std::string &lhs_col, CompOp op, const std::string &rhs_col) {
+    Condition cond;
+    cond.lhs_col = {"l", lhs_col};
+    cond.op = op;
+    cond.is_rhs_val = false;
+    cond.rhs_col = {"r", rhs_col};
+    return cond;
+}
+
+// 通过批量接口读出exec的全部记录，保持输出的顺序
+inline std::vector<std::string> collect(AbstractExecutor &exec) {
+    std::vector<std::string> result;
+    RecordBatch batch;
+    exec.beginTuple();
+    while (exec.NextBatch(batch)) {
+        for (size_t k = 0; k < batch.size(); k++) {
+            result.emplace_back(batch.selected_row(k), exec.tupleLen());
+        }
+    }
+    return result;
+}
+
+// 通过逐条接口读出exec的全部记录，保持输出的顺序
+inline std::vector<std::string> collect_tuples(AbstractExecutor &exec) {
+    std::vector<std::string> result;
+    for (exec.beginTuple(); !exec.is_end(); exec.nextTuple()) {
+        auto record = exec.Next();
+        result.emplace_back(record->data, record->size);
+    }
+    return result;
+}
+
+// 对照结果：逐对拼接左表和右表的记录并检查全部条件，排序后返回
+inline std::vector<std::string> nested_loop_join(const std::vector<std::string> &left_rows,
+                                                 const std::vector<std::string> &right_rows,
+                                                 const std::vector<Condition> &conds) {
+    auto cols = make_cols("l");
+    for (auto &col : make_cols("r")) {
+        col.offset += TEST_TUPLE_LEN;
+        cols.push_back(col);
+    }
+    CompiledPredicate pred(conds, cols);
+    std::vector<std::string> result;
+    for (auto &l : left_rows) {
+        for (auto &r : right_rows) {
+            if (pred.eval((l + r).data())) {
+                result.push_back(l + r);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
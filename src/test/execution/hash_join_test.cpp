@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_hash_join.h"
+#include "execution_test.h"
+
+/** 哈希连接的结果与逐对比较全部连接条件的嵌套循环连接相同（按多重集合比较，不要求顺序）：
+ * 内存足够时分别以较小的左表、右表为build侧；内存预算很小时走grace模式的多层分区，
+ * 连接键大量重复时分区到最大层数后仍在内存中连接 */
+
+void check_join(int num_left, int num_right, int num_keys, const std::vector<Condition> &conds, size_t mem_budget) {
+    auto rng = std::default_random_engine{static_cast<unsigned>(num_left * 31 + num_right)};
+    auto left_rows = make_rows(num_left, num_keys, rng);
+    auto right_rows = make_rows(num_right, num_keys, rng);
+    HashJoinExecutor join(std::make_unique<VectorExecutor>(make_cols("l"), left_rows),
+                          std::make_unique<VectorExecutor>(make_cols("r"), right_rows), conds, mem_budget);
+    auto expected = nested_loop_join(left_rows, right_rows, conds);
+    auto result = collect(join);
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result.size(), expected.size());
+    ASSERT_TRUE(result == expected);
+    // 重新beginTuple()之后结果相同
+    result = collect(join);
+    std::sort(result.begin(), result.end());
+    ASSERT_TRUE(result == expected);
+}
+
+/**
+ * @brief 内存模式：左表或右表较小，单个或多个连接键，附加非等值条件
+ */
+TEST(HashJoinTest, InMemoryTest) {
+    std::vector<std::vector<Condition>> conds_list = {
+        {col_cond("k", OP_EQ, "k")},
+        {col_cond("f", OP_EQ, "f")},
+        {col_cond("s", OP_EQ, "s"), col_cond("k", OP_EQ, "k")},
+        {col_cond("k", OP_EQ, "k"), col_cond("v", OP_LT, "v")},
+    };
+    for (auto &conds : conds_list) {
+        check_join(100, 5000, 50, conds, EXEC_MEMORY_BUDGET);
+        check_join(5000, 100, 50, conds, EXEC_MEMORY_BUDGET);
+        check_join(0, 3000, 50, conds, EXEC_MEMORY_BUDGET);
+        check_join(3000, 0, 50, conds, EXEC_MEMORY_BUDGET);
+    }
+}
+
+/**
+ * @brief grace模式：两侧都超过内存预算，需要多层分区
+ */
+TEST(HashJoinTest, GraceTest) {
+    check_join(3000, 4000, 2000, {col_cond("k", OP_EQ, "k")}, 4 * 1024);
+    check_join(4000, 3000, 2000, {col_cond("s", OP_EQ, "s"), col_cond("v", OP_GE, "v")}, 2 * 1024);
+}
+
+/**
+ * @brief 连接键大量重复，分区到最大层数后build侧仍然超过预算
+ */
+TEST(HashJoinTest, SkewTest) {
+    check_join(1500, 1500, 3, {col_cond("k", OP_EQ, "k")}, 4 * 1024);
+}
+
+/**
+ * @brief 逐条接口与批量接口的结果相同
+ */
+TEST(HashJoinTest, TupleInterfaceTest) {
+    auto rng = std::default_random_engine{};
+    auto left_rows = make_rows(3000, 100, rng);
+    auto right_rows = make_rows(200, 100, rng);
+    std::vector<Condition> conds = {col_cond("k", OP_EQ, "k")};
+    HashJoinExecutor join(std::make_unique<VectorExecutor>(make_cols("l"), left_rows),
+                          std::make_unique<VectorExecutor>(make_cols("r"), right_rows), conds);
+    auto result = collect_tuples(join);
+    std::sort(result.begin(), result.end());
+    ASSERT_TRUE(result == nested_loop_join(left_rows, right_rows, conds));
+}
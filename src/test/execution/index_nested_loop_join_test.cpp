@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_index_nestedloop_join.h"
+#include "execution_test.h"
+#include "storage/buffer_pool_manager.h"
+#include "record/rm.h"
+
+const std::string TEST_DB_NAME = "IndexNestedLoopJoinTest_db";  // 以数据库名作为根目录
+const std::string TEST_TAB_NAME = "r";                           // 内表的表名，与col_cond()中的右表相同
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，然后在此目录下创建内表r(k int, f float, s char(8), v int)和它上面的索引，
+ * 索引嵌套循环连接的结果与逐对比较内表条件和全部连接条件的嵌套循环连接相同（按多重集合比较，不要求顺序）：
+ * 索引的所有字段都来自连接条件、只有前缀来自连接条件、前缀中有内表的常量条件，以及哈希索引 */
+
+// 内表的字段与常量比较的条件
+Condition val_cond(const std::string &lhs_col, CompOp op, int val) {
+    Condition cond;
+    cond.lhs_col = {TEST_TAB_NAME, lhs_col};
+    cond.op = op;
+    cond.is_rhs_val = true;
+    cond.rhs_val.set_int(val);
+    cond.rhs_val.init_raw(sizeof(int));
+    return cond;
+}
+
+Condition val_cond(const std::string &lhs_col, CompOp op, float val) {
+    Condition cond;
+    cond.lhs_col = {TEST_TAB_NAME, lhs_col};
+    cond.op = op;
+    cond.is_rhs_val = true;
+    cond.rhs_val.set_float(val);
+    cond.rhs_val.init_raw(sizeof(float));
+    return cond;
+}
+
+class IndexNestedLoopJoinTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    std::vector<std::string> inner_rows_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(256, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+
+        // 如果测试目录存在，则先删除测试目录
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        // 进入测试目录
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+
+        // 内表中插入记录之后再建立索引
+        sm_->create_table(TEST_TAB_NAME, {{"k", TYPE_INT, 4}, {"f", TYPE_FLOAT, 4}, {"s", TYPE_STRING, 8}, {"v", TYPE_INT, 4}},
+                          context_.get());
+        auto rng = std::default_random_engine{};
+        inner_rows_ = make_rows(3000, 200, rng);
+        for (auto &row : inner_rows_) {
+            sm_->fhs_.at(TEST_TAB_NAME)->insert_record(row.data(), context_.get());
+        }
+        sm_->create_index(TEST_TAB_NAME, {"k"}, context_.get());
+        sm_->create_index(TEST_TAB_NAME, {"k", "f"}, context_.get());
+        sm_->create_index(TEST_TAB_NAME, {"s"}, context_.get(), INDEX_HASH);
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    void check_join(const std::vector<std::string> &index_col_names, const std::vector<Condition> &inner_conds,
+                    const std::vector<Condition> &conds) {
+        auto rng = std::default_random_engine{static_cast<unsigned>(conds.size() * 31 + inner_conds.size())};
+        auto outer_rows = make_rows(500, 250, rng);
+        IndexNestedLoopJoinExecutor join(sm_.get(), std::make_unique<VectorExecutor>(make_cols("l"), outer_rows),
+                                         TEST_TAB_NAME, inner_conds, index_col_names, conds, context_.get());
+        auto all_conds = inner_conds;
+        all_conds.insert(all_conds.end(), conds.begin(), conds.end());
+        auto expected = nested_loop_join(outer_rows, inner_rows_, all_conds);
+        ASSERT_FALSE(expected.empty());
+
+        auto result = collect(join);
+        std::sort(result.begin(), result.end());
+        ASSERT_EQ(result.size(), expected.size());
+        ASSERT_TRUE(result == expected);
+
+        // 逐条接口的结果相同
+        result = collect_tuples(join);
+        std::sort(result.begin(), result.end());
+        ASSERT_TRUE(result == expected);
+    }
+};
+
+/**
+ * @brief 索引的所有字段都来自连接条件，在B+树上批量查找
+ */
+TEST_F(IndexNestedLoopJoinTests, FullKeyTest) {
+    check_join({"k"}, {}, {col_cond("k", OP_EQ, "k")});
+    check_join({"k", "f"}, {}, {col_cond("f", OP_EQ, "f"), col_cond("k", OP_EQ, "k")});
+    check_join({"k"}, {val_cond("f", OP_LT, 5.0f)}, {col_cond("k", OP_EQ, "k"), col_cond("v", OP_NE, "v")});
+}
+
+/**
+ * @brief 只有索引的前缀来自连接条件或内表的常量条件，在B+树上按范围查找
+ */
+TEST_F(IndexNestedLoopJoinTests, PrefixTest) {
+    check_join({"k", "f"}, {}, {col_cond("k", OP_EQ, "k")});
+    check_join({"k", "f"}, {val_cond("f", OP_GT, 3.0f)}, {col_cond("k", OP_EQ, "k")});
+    check_join({"k", "f"}, {val_cond("k", OP_EQ, 17)}, {col_cond("f", OP_EQ, "f")});
+}
+
+/**
+ * @brief 在哈希索引上查找
+ */
+TEST_F(IndexNestedLoopJoinTests, HashIndexTest) {
+    check_join({"s"}, {}, {col_cond("s", OP_EQ, "s"), col_cond("f", OP_EQ, "f")});
+}
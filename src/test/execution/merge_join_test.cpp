@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_merge_join.h"
+#include "execution_test.h"
+
+/** 排序归并连接的结果与逐对比较全部连接条件的嵌套循环连接相同，并且按连接键有序：
+ * 两侧都有大量重复的连接键、重复的段跨越多个batch、一侧为空，以及附加非等值条件的情况 */
+
+// 按k有序的记录，s与k的顺序一致，因此同时也按s有序
+std::vector<std::string> make_sorted_rows(int num_rows, int num_keys, std::default_random_engine &rng) {
+    auto rows = make_rows(num_rows, num_keys, rng);
+    std::stable_sort(rows.begin(), rows.end(), [](const std::string &a, const std::string &b) {
+        int key_a, key_b;
+        memcpy(&key_a, a.data(), sizeof(int));
+        memcpy(&key_b, b.data(), sizeof(int));
+        return key_a < key_b;
+    });
+    return rows;
+}
+
+void check_join(int num_left, int num_right, int num_keys, const std::vector<Condition> &conds) {
+    auto rng = std::default_random_engine{static_cast<unsigned>(num_left * 31 + num_right + num_keys)};
+    auto left_rows = make_sorted_rows(num_left, num_keys, rng);
+    auto right_rows = make_sorted_rows(num_right, num_keys, rng);
+    MergeJoinExecutor join(std::make_unique<VectorExecutor>(make_cols("l"), left_rows),
+                           std::make_unique<VectorExecutor>(make_cols("r"), right_rows), conds);
+    auto result = collect(join);
+    // 输出按连接键有序
+    for (size_t i = 1; i < result.size(); i++) {
+        int prev, cur;
+        memcpy(&prev, result[i - 1].data(), sizeof(int));
+        memcpy(&cur, result[i].data(), sizeof(int));
+        ASSERT_LE(prev, cur);
+    }
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result.size(), nested_loop_join(left_rows, right_rows, conds).size());
+    ASSERT_TRUE(result == nested_loop_join(left_rows, right_rows, conds));
+}
+
+/**
+ * @brief 单个连接键：重复较少、两侧都有大量重复（重复的段跨越多个batch）、一侧为空
+ */
+TEST(MergeJoinTest, JoinTest) {
+    std::vector<Condition> conds = {col_cond("k", OP_EQ, "k")};
+    check_join(2000, 3000, 1000, conds);
+    check_join(3000, 2000, 5, conds);
+    check_join(1, 5000, 2, conds);
+    check_join(0, 100, 10, conds);
+    check_join(100, 0, 10, conds);
+}
+
+/**
+ * @brief 字符串连接键，以及连接键之外的其他条件
+ */
+TEST(MergeJoinTest, ExtraCondTest) {
+    check_join(2000, 2000, 50, {col_cond("s", OP_EQ, "s")});
+    check_join(2000, 2000, 50, {col_cond("k", OP_EQ, "k"), col_cond("v", OP_LT, "v")});
+    check_join(2000, 2000, 50, {col_cond("v", OP_GT, "v"), col_cond("k", OP_EQ, "k"), col_cond("s", OP_EQ, "s")});
+}
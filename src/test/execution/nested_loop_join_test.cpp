@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_nestedloop_join.h"
+#include "execution_test.h"
+
+/** block nested loop连接的结果与逐对比较全部连接条件的结果相同（按多重集合比较，不要求顺序）：
+ * 右表全部放入一个block，以及内存预算很小、右表被分成多个block的情况 */
+
+/**
+ * @param num_blocks 预期右表被分成的block数量，左表扫描的次数与之相同
+ */
+void check_join(int num_left, int num_right, const std::vector<Condition> &conds, size_t block_budget, int num_blocks) {
+    auto rng = std::default_random_engine{static_cast<unsigned>(num_left * 31 + num_right)};
+    auto left_rows = make_rows(num_left, 100, rng);
+    auto right_rows = make_rows(num_right, 100, rng);
+    auto left = std::make_unique<VectorExecutor>(make_cols("l"), left_rows);
+    auto left_ptr = left.get();
+    NestedLoopJoinExecutor join(std::move(left), std::make_unique<VectorExecutor>(make_cols("r"), right_rows), conds,
+                                block_budget);
+
+    auto result = collect(join);
+    std::sort(result.begin(), result.end());
+    auto expected = nested_loop_join(left_rows, right_rows, conds);
+    ASSERT_EQ(result.size(), expected.size());
+    ASSERT_TRUE(result == expected);
+    // beginTuple()中一次，每个block重新扫描一次
+    ASSERT_EQ(left_ptr->num_scans(), 1 + num_blocks);
+}
+
+TEST(NestedLoopJoinTest, SingleBlockTest) {
+    check_join(600, 1000, {col_cond("k", OP_LT, "k")}, EXEC_MEMORY_BUDGET, 1);
+    check_join(1000, 3000, {col_cond("k", OP_EQ, "k"), col_cond("v", OP_NE, "v")}, EXEC_MEMORY_BUDGET, 1);
+    check_join(100, 100, {}, EXEC_MEMORY_BUDGET, 1);
+    check_join(0, 100, {}, EXEC_MEMORY_BUDGET, 1);
+    check_join(100, 0, {}, EXEC_MEMORY_BUDGET, 0);
+}
+
+TEST(NestedLoopJoinTest, MultiBlockTest) {
+    // 每个block读入右表的一个batch（BATCH_SIZE条记录）
+    size_t budget = BATCH_SIZE * TEST_TUPLE_LEN;
+    check_join(500, 3000, {col_cond("k", OP_GE, "k")}, budget, 3);
+    check_join(500, 2 * BATCH_SIZE, {col_cond("v", OP_LT, "v"), col_cond("k", OP_NE, "k")}, budget, 2);
+}
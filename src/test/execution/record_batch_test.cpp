@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution_test.h"
+
+/** RecordBatch按行存放记录，过滤只改写选择向量；AbstractExecutor::NextBatch()把逐条接口适配为批量接口，
+ * 每个batch最多BATCH_SIZE条记录，输入在batch中间结束时最后一个batch不满 */
+
+/**
+ * @brief 追加、撤销和填满batch，改写选择向量后只能访问被选中的行
+ */
+TEST(RecordBatchTest, SelectionTest) {
+    RecordBatch batch(sizeof(int));
+    EXPECT_EQ(0, batch.size());
+    for (int i = 0; !batch.is_full(); i++) {
+        memcpy(batch.append_row({1, i}), &i, sizeof(int));
+        EXPECT_EQ(static_cast<size_t>(i + 1), batch.num_rows());
+        EXPECT_EQ(batch.num_rows(), batch.size());
+    }
+    EXPECT_EQ(BATCH_SIZE, batch.num_rows());
+
+    // 撤销最后一行后batch不再满，可以再追加一行
+    batch.pop_row();
+    EXPECT_FALSE(batch.is_full());
+    EXPECT_EQ(BATCH_SIZE - 1, batch.size());
+    int last = -1;
+    memcpy(batch.append_row({1, -1}), &last, sizeof(int));
+    EXPECT_TRUE(batch.is_full());
+    EXPECT_EQ(-1, batch.rid(BATCH_SIZE - 1).slot_no);
+
+    // 只保留偶数行：数据不移动，selected_row()按选择向量访问
+    auto &sel = batch.sel();
+    sel.erase(std::remove_if(sel.begin(), sel.end(), [](uint16_t i) { return i % 2 != 0; }), sel.end());
+    EXPECT_EQ(BATCH_SIZE / 2, batch.size());
+    EXPECT_EQ(BATCH_SIZE, batch.num_rows());
+    for (size_t k = 0; k < batch.size(); k++) {
+        int value;
+        memcpy(&value, batch.selected_row(k), sizeof(int));
+        EXPECT_EQ(static_cast<int>(2 * k), value);
+        EXPECT_EQ(value, batch.rid(batch.sel()[k]).slot_no);
+    }
+
+    // clear()之后重新追加，reset()可以改变记录长度
+    batch.clear();
+    EXPECT_EQ(0, batch.size());
+    EXPECT_EQ(0, batch.num_rows());
+    batch.reset(TEST_TUPLE_LEN);
+    EXPECT_EQ(static_cast<size_t>(TEST_TUPLE_LEN), batch.tuple_len());
+    EXPECT_EQ(batch.row(1), batch.append_row() + TEST_TUPLE_LEN);
+    EXPECT_EQ(1, batch.size());
+}
+
+/**
+ * @brief NextBatch()的默认实现：输入为空、恰好若干个满batch、在batch中间结束时都返回全部记录，
+ * 除最后一个batch外每个batch都是满的
+ */
+TEST(RecordBatchTest, NextBatchTest) {
+    auto rng = std::default_random_engine{2023};
+    for (int num_rows : {0, 1, static_cast<int>(BATCH_SIZE), static_cast<int>(BATCH_SIZE) * 2,
+                         static_cast<int>(BATCH_SIZE) * 2 + 17}) {
+        auto rows = make_rows(num_rows, 100, rng);
+        VectorExecutor exec(make_cols("t"), rows);
+        std::vector<std::string> result;
+        std::vector<size_t> sizes;
+        RecordBatch batch;
+        exec.beginTuple();
+        while (exec.NextBatch(batch)) {
+            EXPECT_EQ(static_cast<size_t>(TEST_TUPLE_LEN), batch.tuple_len());
+            sizes.push_back(batch.size());
+            for (size_t k = 0; k < batch.size(); k++) {
+                result.emplace_back(batch.selected_row(k), TEST_TUPLE_LEN);
+            }
+        }
+        EXPECT_TRUE(exec.is_end());
+        EXPECT_FALSE(exec.NextBatch(batch));
+        EXPECT_EQ(rows, result);
+        EXPECT_EQ((num_rows + BATCH_SIZE - 1) / BATCH_SIZE, sizes.size());
+        for (size_t i = 0; i + 1 < sizes.size(); i++) {
+            EXPECT_EQ(BATCH_SIZE, sizes[i]);
+        }
+    }
+}
+
+/**
+ * @brief 先用逐条接口读出若干条记录，再用批量接口读出剩余的记录，不重复也不遗漏
+ */
+TEST(RecordBatchTest, MixedTest) {
+    auto rng = std::default_random_engine{2024};
+    const int num_rows = BATCH_SIZE + 100;
+    auto rows = make_rows(num_rows, 100, rng);
+    for (int num_tuples : {0, 1, 100, num_rows - 1, num_rows}) {
+        VectorExecutor exec(make_cols("t"), rows);
+        std::vector<std::string> result;
+        exec.beginTuple();
+        for (int i = 0; i < num_tuples; i++, exec.nextTuple()) {
+            auto record = exec.Next();
+            result.emplace_back(record->data, record->size);
+        }
+        RecordBatch batch;
+        while (exec.NextBatch(batch)) {
+            for (size_t k = 0; k < batch.size(); k++) {
+                result.emplace_back(batch.selected_row(k), TEST_TUPLE_LEN);
+            }
+        }
+        EXPECT_EQ(rows, result);
+    }
+}
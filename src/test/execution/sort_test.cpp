@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_sort.h"
+#include "execution_test.h"
+
+/** 排序的结果与按同样的排序键用std::stable_sort排序的结果完全相同（排序键相同的记录保持输入顺序）：
+ * 输入放得下时只在内存中排序；内存预算很小时生成多个run做k路归并，run很多时先做若干趟归并 */
+
+std::vector<std::string> stable_sort(std::vector<std::string> rows, const std::vector<TabCol> &sel_cols,
+                                     const std::vector<bool> &is_descs) {
+    auto cols = make_cols("t");
+    std::stable_sort(rows.begin(), rows.end(), [&](const std::string &a, const std::string &b) {
+        for (size_t i = 0; i < sel_cols.size(); i++) {
+            auto col = std::find_if(cols.begin(), cols.end(), [&](const ColMeta &c) { return c.name == sel_cols[i].col_name; });
+            int cmp = ix_compare(a.data() + col->offset, b.data() + col->offset, col->type, col->len);
+            if (cmp != 0) {
+                return is_descs[i] ? cmp > 0 : cmp < 0;
+            }
+        }
+        return false;
+    });
+    return rows;
+}
+
+/**
+ * @param min_runs 至少生成的run的数量，为0时要求只在内存中排序
+ */
+void check_sort(int num_rows, int num_keys, const std::vector<std::string> &col_names, const std::vector<bool> &is_descs,
+                size_t mem_budget, size_t min_runs) {
+    auto rng = std::default_random_engine{static_cast<unsigned>(num_rows * 31 + num_keys)};
+    auto rows = make_rows(num_rows, num_keys, rng);
+    std::vector<TabCol> sel_cols;
+    for (auto &name : col_names) {
+        sel_cols.push_back({"t", name});
+    }
+    SortExecutor sort(std::make_unique<VectorExecutor>(make_cols("t"), rows), sel_cols, is_descs, mem_budget);
+    auto expected = stable_sort(rows, sel_cols, is_descs);
+
+    // 批量接口，重新beginTuple()之后结果相同
+    for (int round = 0; round < 2; round++) {
+        auto result = collect(sort);
+        ASSERT_EQ(result.size(), expected.size());
+        ASSERT_TRUE(result == expected);
+    }
+    if (min_runs == 0) {
+        ASSERT_EQ(sort.num_runs(), 0);
+    } else {
+        ASSERT_GE(sort.num_runs(), min_runs);
+    }
+
+    // 逐条接口
+    ASSERT_TRUE(collect_tuples(sort) == expected);
+}
+
+/**
+ * @brief 内存中排序：单个键升序或降序，多个键混合方向，规范化key超过8个字节
+ */
+TEST(SortTest, InMemoryTest) {
+    check_sort(5000, 100, {"k"}, {false}, EXEC_MEMORY_BUDGET, 0);
+    check_sort(5000, 100, {"f"}, {true}, EXEC_MEMORY_BUDGET, 0);
+    check_sort(5000, 10, {"s", "f"}, {false, true}, EXEC_MEMORY_BUDGET, 0);
+    check_sort(5000, 10, {"f", "s", "v"}, {true, false, true}, EXEC_MEMORY_BUDGET, 0);
+    check_sort(0, 10, {"k"}, {false}, EXEC_MEMORY_BUDGET, 0);
+}
+
+/**
+ * @brief 外部排序：生成多个run后一次归并
+ */
+TEST(SortTest, ExternalTest) {
+    check_sort(20000, 100, {"k"}, {false}, 256 * 1024, 2);
+    check_sort(20000, 10, {"s", "f"}, {true, false}, 256 * 1024, 2);
+}
+
+/**
+ * @brief run的数量超过一次归并的路数，先做若干趟归并
+ */
+TEST(SortTest, MultiPassTest) {
+    check_sort(3000, 10, {"k", "f"}, {false, true}, 4 * 1024, 20);
+    check_sort(3000, 1000, {"f", "k", "s"}, {false, false, true}, 4 * 1024, 20);
+}
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <random>  // for std::default_random_engine
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "system/sm.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+#include "record/rm.h"
+const std::string TEST_DB_NAME = "BPlusTreeBatchTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";               // 测试文件名的前缀
+const int TEST_KEY_LEN = 16;
+
+// 与索引中的顺序一致：同一个key的rid按(page_no, slot_no)排列
+struct RidLess {
+    bool operator()(const Rid &a, const Rid &b) const {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    }
+};
+using Mock = std::map<std::string, std::set<Rid, RidLess>>;
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，然后在此目录下创建表TEST_FILE_NAME
+ * 测试点在表的字符串字段上创建索引，用get_values()/insert_entries()/delete_entries()批量操作，
+ * 结果与std::map记录的结果一致，B+树的结构仍然正确 */
+
+class BPlusTreeBatchTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+    std::vector<ColMeta> index_cols_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        // 如果测试目录存在，则先删除测试目录
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        // 进入测试目录
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"name", TYPE_STRING, TEST_KEY_LEN});
+        coldef.push_back({"id", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+        index_cols_ = {*sm_->db_.get_table(TEST_FILE_NAME).get_col("name")};
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        close_index();
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    // order只对原始格式有效，规范化格式的结点大小由页面大小决定；批量操作中有重复的key，建立非唯一索引
+    void create_index(bool normalized, int order) {
+        close_index();
+        if (ix_manager_->exists(TEST_FILE_NAME, index_cols_)) {
+            ix_manager_->destroy_index(TEST_FILE_NAME, index_cols_);
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, index_cols_, normalized, false);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, index_cols_);
+        if (!normalized) {
+            assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+            ih_->file_hdr_->btree_order_ = order;
+        }
+    }
+
+    void close_index() {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+            // 重新创建的索引文件可能复用同一个fd，先从缓冲池中删除旧文件的页面
+            for (int page_no = 0; page_no < disk_manager_->get_fd2pageno(ih_->fd_); page_no++) {
+                buffer_pool_manager_->delete_page({.fd = ih_->fd_, .page_no = page_no});
+            }
+            ih_.reset();
+        }
+    }
+
+    // 第i个key：8位数字，末尾用'\0'补齐
+    static std::string make_key(int i) {
+        char buf[TEST_KEY_LEN + 1];
+        memset(buf, 0, sizeof(buf));
+        snprintf(buf, sizeof(buf), "key-%08d", i);
+        return std::string(buf, TEST_KEY_LEN);
+    }
+
+    static std::vector<const char *> key_ptrs(const std::vector<std::string> &keys) {
+        std::vector<const char *> ptrs;
+        for (auto &key : keys) {
+            ptrs.push_back(key.data());
+        }
+        return ptrs;
+    }
+
+    /**------ 以下为辅助检查函数 ------*/
+
+    /**
+     * @brief 检查叶子层的前驱指针和后继指针
+     */
+    void check_leaf(const IxIndexHandle *ih) {
+        page_id_t leaf_no = ih->file_hdr_->first_leaf_;
+        while (leaf_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *curr = ih->fetch_node(leaf_no);
+            IxNodeHandle *next = ih->fetch_node(curr->get_next_leaf());
+            EXPECT_EQ(next->get_prev_leaf(), leaf_no);
+            if (curr->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                EXPECT_EQ(ih->file_hdr_->last_leaf_, leaf_no);
+            }
+            leaf_no = curr->get_next_leaf();
+            buffer_pool_manager_->unpin_page(curr->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(next->get_page_id(), false);
+            delete curr;
+            delete next;
+        }
+    }
+
+    /**
+     * @brief dfs遍历整个树，检查结点的大小、父结点，以及key都在父结点给出的范围[lower, upper)内
+     */
+    void check_tree(const IxIndexHandle *ih, int now_page_no, const std::string *lower, const std::string *upper) {
+        IxNodeHandle *node = ih->fetch_node(now_page_no);
+        int len = ih->file_hdr_->col_tot_len_;
+        if (now_page_no != ih->file_hdr_->root_page_) {
+            EXPECT_GE(node->get_size(), node->get_min_size());
+        }
+        EXPECT_LT(node->get_size(), node->get_max_size());
+        std::vector<std::string> keys;
+        for (int i = 0; i < node->get_size(); i++) {
+            keys.emplace_back(node->get_key(i), len);
+        }
+        // 原始格式的key末尾的rid不能按字节比较
+        auto less = [ih](const std::string &a, const std::string &b) {
+            return ix_compare(a.data(), b.data(), ih->file_hdr_) < 0;
+        };
+        for (int i = 0; i < node->get_size(); i++) {
+            if (i > 0) {
+                EXPECT_TRUE(less(keys[i - 1], keys[i]));
+            }
+            if (node->is_leaf_page() || i > 0) {
+                EXPECT_TRUE(lower == nullptr || !less(keys[i], *lower));
+            }
+            EXPECT_TRUE(upper == nullptr || less(keys[i], *upper));
+        }
+        if (!node->is_leaf_page()) {
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+                EXPECT_EQ(child->get_parent_page_no(), now_page_no);
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+                const std::string *child_lower = i == 0 ? lower : &keys[i];
+                const std::string *child_upper = i + 1 == node->get_size() ? upper : &keys[i + 1];
+                check_tree(ih, node->value_at(i), child_lower, child_upper);
+            }
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+    }
+
+    /**
+     * @param mock 函数外部记录的(key,rid)，同一个key的rid按从小到大排列
+     */
+    void check_all(IxIndexHandle *ih, const Mock &mock) {
+        check_tree(ih, ih->file_hdr_->root_page_, nullptr, nullptr);
+        check_leaf(ih);
+
+        IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+        for (auto &entry : mock) {
+            for (auto &rid : entry.second) {
+                ASSERT_FALSE(scan.is_end());
+                ASSERT_EQ(scan.rid(), rid);
+                scan.next();
+            }
+        }
+        ASSERT_EQ(scan.is_end(), true);
+    }
+};
+
+/**
+ * @brief 随机的批量插入、删除和查找（批内有重复的key，也有已经存在或不存在的(key,rid)），
+ * 每个操作的返回值和查找结果与std::map一致，每一轮之后B+树的结构和内容都正确
+ */
+TEST_F(BPlusTreeBatchTests, BatchTest) {
+    const int scale = 20000;
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> key_dist(0, scale - 1);
+    for (bool normalized : {false, true}) {
+        create_index(normalized, 8);
+        Mock mock;
+        // 记录的rid的范围较小，同一个key的rid会重复出现，用来测试重复的(key,rid)
+        std::uniform_int_distribution<int> rid_dist(-3, 3);
+        for (int round = 0; round < 40; round++) {
+            int batch_size = std::vector<int>{1, 7, 100, 1000, 5000}[round % 5];
+            std::vector<std::string> keys;
+            std::vector<Rid> rids;
+            for (int i = 0; i < batch_size; i++) {
+                keys.push_back(make_key(key_dist(rng)));
+                rids.push_back(Rid{.page_no = rid_dist(rng), .slot_no = rid_dist(rng)});
+            }
+            size_t expected = 0;
+            if (round % 3 != 2) {
+                // 重复的key都插入，重复的(key,rid)只有第一个插入成功
+                for (int i = 0; i < batch_size; i++) {
+                    expected += mock[keys[i]].insert(rids[i]).second;
+                }
+                ASSERT_EQ(ih_->insert_entries(key_ptrs(keys), rids, txn_.get()), expected);
+            } else {
+                for (int i = 0; i < batch_size; i++) {
+                    auto pos = mock.find(keys[i]);
+                    if (pos != mock.end()) {
+                        expected += pos->second.erase(rids[i]);
+                        if (pos->second.empty()) {
+                            mock.erase(pos);
+                        }
+                    }
+                }
+                ASSERT_EQ(ih_->delete_entries(key_ptrs(keys), rids, txn_.get()), expected);
+            }
+            check_all(ih_.get(), mock);
+
+            std::vector<std::string> probes;
+            for (int i = 0; i < 2000; i++) {
+                probes.push_back(make_key(key_dist(rng)));
+            }
+            std::vector<std::vector<Rid>> result;
+            size_t num_found = ih_->get_values(key_ptrs(probes), &result, txn_.get());
+            expected = 0;
+            for (size_t i = 0; i < probes.size(); i++) {
+                auto pos = mock.find(probes[i]);
+                if (pos == mock.end()) {
+                    ASSERT_TRUE(result[i].empty());
+                    continue;
+                }
+                ASSERT_EQ(result[i], std::vector<Rid>(pos->second.begin(), pos->second.end()));
+                expected++;
+            }
+            ASSERT_EQ(num_found, expected);
+        }
+
+        // 全部删除后仍然可以批量插入
+        std::vector<std::pair<std::string, Rid>> entries;
+        for (auto &entry : mock) {
+            for (auto &rid : entry.second) {
+                entries.emplace_back(entry.first, rid);
+            }
+        }
+        std::shuffle(entries.begin(), entries.end(), rng);
+        std::vector<std::string> keys;
+        std::vector<Rid> rids;
+        for (auto &entry : entries) {
+            keys.push_back(entry.first);
+            rids.push_back(entry.second);
+        }
+        ASSERT_EQ(ih_->delete_entries(key_ptrs(keys), rids, txn_.get()), keys.size());
+        mock.clear();
+        check_all(ih_.get(), mock);
+        rids.clear();
+        for (size_t i = 0; i < keys.size(); i++) {
+            rids.push_back(Rid{.page_no = -1, .slot_no = static_cast<int>(i)});
+            mock[keys[i]].insert(rids.back());
+        }
+        ASSERT_EQ(ih_->insert_entries(key_ptrs(keys), rids, txn_.get()), keys.size());
+        check_all(ih_.get(), mock);
+    }
+}
+
+/**
+ * @brief 对比逐个调用get_value()和一次调用get_values()查找同一批key的耗时（只输出结果，不作断言）
+ * 默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+ */
+TEST_F(BPlusTreeBatchTests, DISABLED_LookupBenchmark) {
+    const int scale = 100000;
+    create_index(true, 0);
+    std::vector<std::string> keys;
+    std::vector<Rid> rids;
+    for (int i = 0; i < scale; i++) {
+        keys.push_back(make_key(i));
+        rids.push_back(Rid{.page_no = i, .slot_no = 0});
+    }
+    ASSERT_EQ(ih_->insert_entries(key_ptrs(keys), rids, txn_.get()), static_cast<size_t>(scale));
+
+    auto rng = std::default_random_engine{};
+    std::cout << std::setw(8) << "batch" << std::setw(12) << "get_value" << std::setw(12) << "get_values"
+              << "   (ns per key)" << std::endl;
+    for (int batch_size : {10, 100, 1000, 10000}) {
+        std::uniform_int_distribution<int> dist(0, scale - 1);
+        std::vector<std::string> probes;
+        for (int i = 0; i < batch_size; i++) {
+            probes.push_back(make_key(dist(rng)));
+        }
+        auto measure = [&](auto lookup) {
+            const int repeat = 200000 / batch_size;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeat; r++) {
+                lookup();
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            return static_cast<double>(ns.count()) / repeat / batch_size;
+        };
+        double single = measure([&]() {
+            std::vector<Rid> result;
+            for (auto &probe : probes) {
+                ih_->get_value(probe.data(), &result, txn_.get());
+            }
+            EXPECT_EQ(result.size(), probes.size());
+        });
+        double batch = measure([&]() {
+            std::vector<std::vector<Rid>> result;
+            EXPECT_EQ(ih_->get_values(key_ptrs(probes), &result, txn_.get()), probes.size());
+        });
+        std::cout << std::setw(8) << batch_size << std::fixed << std::setprecision(1) << std::setw(12) << single
+                  << std::setw(12) << batch << std::endl;
+    }
+}
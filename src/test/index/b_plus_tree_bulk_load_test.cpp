@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>  // for std::default_random_engine
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "system/sm.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+#include "record/rm.h"
+const std::string TEST_DB_NAME = "BPlusTreeBulkLoadTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                  // 测试文件名的前缀
+const std::vector<std::string> TEST_COL = {"col1"};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，然后在此目录下创建表TEST_FILE_NAME
+ * 测试点自己创建索引，再通过IxBulkLoader或者SmManager::create_index()批量构建B+树 */
+
+class BPlusTreeBulkLoadTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+    std::vector<ColMeta> index_cols_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        // 如果测试目录存在，则先删除测试目录
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        // 进入测试目录
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"col1", TYPE_INT, 4});
+        coldef.push_back({"col2", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+        index_cols_ = {*sm_->db_.get_table(TEST_FILE_NAME).get_col("col1")};
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        close_index();
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    // 创建一个新的空索引，order为每个结点最多存放的键值对数量
+    void create_index(int order, bool unique) {
+        close_index();
+        if (ix_manager_->exists(TEST_FILE_NAME, index_cols_)) {
+            ix_manager_->destroy_index(TEST_FILE_NAME, index_cols_);
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, index_cols_, unique);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, index_cols_);
+        assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+        ih_->file_hdr_->btree_order_ = order;
+    }
+
+    void close_index() {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+            // 重新创建的索引文件可能复用同一个fd，先从缓冲池中删除旧文件的页面
+            for (int page_no = 0; page_no < disk_manager_->get_fd2pageno(ih_->fd_); page_no++) {
+                buffer_pool_manager_->delete_page({.fd = ih_->fd_, .page_no = page_no});
+            }
+            ih_.reset();
+        }
+    }
+
+    /**------ 以下为辅助检查函数 ------*/
+
+    /**
+     * @brief 检查叶子层的前驱指针和后继指针
+     */
+    void check_leaf(const IxIndexHandle *ih) {
+        page_id_t leaf_no = ih->file_hdr_->first_leaf_;
+        while (leaf_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *curr = ih->fetch_node(leaf_no);
+            IxNodeHandle *prev = ih->fetch_node(curr->get_prev_leaf());
+            IxNodeHandle *next = ih->fetch_node(curr->get_next_leaf());
+            // Ensure prev->next == curr && next->prev == curr
+            ASSERT_EQ(prev->get_next_leaf(), leaf_no);
+            ASSERT_EQ(next->get_prev_leaf(), leaf_no);
+            if (curr->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                ASSERT_EQ(ih->file_hdr_->last_leaf_, leaf_no);
+            }
+            leaf_no = curr->get_next_leaf();
+            buffer_pool_manager_->unpin_page(curr->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(prev->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(next->get_page_id(), false);
+            delete curr;
+            delete prev;
+            delete next;
+        }
+    }
+
+    /**
+     * @brief dfs遍历整个树，检查孩子结点的父结点、第一个key和大小是否正确
+     */
+    void check_tree(const IxIndexHandle *ih, int now_page_no) {
+        IxNodeHandle *node = ih->fetch_node(now_page_no);
+        if (now_page_no != ih->file_hdr_->root_page_) {
+            // 除根结点外，批量构建的结点都不少于最小大小
+            ASSERT_GE(node->get_size(), node->get_min_size());
+        }
+        ASSERT_LE(node->get_size(), ih->file_hdr_->btree_order_);
+        if (node->is_leaf_page()) {
+            buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+            delete node;
+            return;
+        }
+        for (int i = 0; i < node->get_size(); i++) {
+            IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+            ASSERT_EQ(child->get_parent_page_no(), now_page_no);
+            int node_key = node->key_at(i);
+            int child_first_key = child->key_at(0);
+            int child_last_key = child->key_at(child->get_size() - 1);
+            if (i != 0) {
+                ASSERT_EQ(node_key, child_first_key);
+            }
+            if (i + 1 < node->get_size()) {
+                if (ih->file_hdr_->unique_) {
+                    ASSERT_LT(child_last_key, node->key_at(i + 1));
+                }
+                // 非唯一索引中重复的key可能跨越相邻的孩子，按附加了rid的完整key比较
+                ASSERT_LT(ix_compare(child->get_key(child->get_size() - 1), node->get_key(i + 1), ih->file_hdr_), 0);
+            }
+            buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+            delete child;
+
+            check_tree(ih, node->value_at(i));
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+    }
+
+    // 空闲页面链表的长度
+    int num_free_pages(const IxIndexHandle *ih) {
+        int num = 0;
+        page_id_t page_no = ih->file_hdr_->first_free_page_no_;
+        while (page_no != IX_NO_PAGE) {
+            IxNodeHandle *node = ih->fetch_node(page_no);
+            page_no = node->page_hdr->next_free_page_no;
+            buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+            delete node;
+            num++;
+        }
+        return num;
+    }
+
+    /**
+     * @param mock 函数外部记录的(key,rid)，std::map或std::multimap，同一个key的rid按从小到大的顺序插入
+     */
+    template <typename Mock>
+    void check_all(IxIndexHandle *ih, const Mock &mock) {
+        check_tree(ih, ih->file_hdr_->root_page_);
+        check_leaf(ih);
+
+        std::vector<Rid> rids;
+        for (auto it = mock.begin(); it != mock.end(); it = mock.upper_bound(it->first)) {
+            rids.clear();
+            ih->get_value((const char *)&it->first, &rids, txn_.get());
+            std::vector<Rid> expected;
+            for (auto pos = it; pos != mock.end() && pos->first == it->first; pos++) {
+                expected.push_back(pos->second);
+            }
+            ASSERT_EQ(rids, expected);
+        }
+
+        IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+        auto it = mock.begin();
+        while (!scan.is_end() && it != mock.end()) {
+            ASSERT_EQ(scan.rid(), it->second);
+            it++;
+            scan.next();
+        }
+        ASSERT_EQ(scan.is_end(), true);
+        ASSERT_EQ(it, mock.end());
+    }
+};
+
+/**
+ * @brief 不同的结点大小和数据量下，乱序添加的键值对经过批量构建后，B+树的结构和内容都正确；
+ * 构建完成后仍然可以正常插入和删除
+ */
+TEST_F(BPlusTreeBulkLoadTests, BuildTest) {
+    auto rng = std::default_random_engine{};
+    for (int order : {3, 4, 5, 16, 200}) {
+        for (int scale : {0, 1, 2, 3, 7, 10, 100, 1000, 5000}) {
+            create_index(order, true);
+            std::vector<int> keys;
+            for (int key = 1; key <= scale; key++) {
+                keys.push_back(key * 2);  // 留出奇数key用于之后的插入
+            }
+            std::shuffle(keys.begin(), keys.end(), rng);
+
+            std::map<int, Rid> mock;
+            IxBulkLoader loader(ih_.get());
+            for (int key : keys) {
+                Rid rid = {.page_no = key / 10, .slot_no = key % 10};
+                loader.add((const char *)&key, rid);
+                mock[key] = rid;
+            }
+            ASSERT_EQ(loader.finish(), static_cast<size_t>(scale));
+            ASSERT_EQ(loader.num_runs(), 0);
+            check_all(ih_.get(), mock);
+
+            // 插入奇数key，删除一半偶数key
+            for (int i = 0; i < scale; i++) {
+                int key = keys[i] + 1;
+                Rid rid = {.page_no = key / 10, .slot_no = key % 10};
+                ih_->insert_entry((const char *)&key, rid, txn_.get());
+                mock[key] = rid;
+                if (i % 2 == 0) {
+                    ASSERT_TRUE(ih_->delete_entry((const char *)&keys[i], txn_.get()));
+                    mock.erase(keys[i]);
+                }
+            }
+            if (!ih_->is_empty()) {
+                check_all(ih_.get(), mock);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 内存上限很小时使用外部排序，重复的key按rid排列，全部写入索引
+ */
+TEST_F(BPlusTreeBulkLoadTests, ExternalSortTest) {
+    const int scale = 20000;
+    const int order = 64;
+    create_index(order, false);
+
+    std::vector<std::pair<int, Rid>> entries;
+    for (int i = 0; i < scale; i++) {
+        int key = i / 2;  // 每个key出现两次
+        entries.push_back({key, Rid{.page_no = i, .slot_no = i % 7}});
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(entries.begin(), entries.end(), rng);
+
+    {
+        IxBulkLoader loader(ih_.get(), 1.0, 1000 * (sizeof(int) + 2 * sizeof(Rid)));
+        for (auto &entry : entries) {
+            loader.add((const char *)&entry.first, entry.second);
+        }
+        ASSERT_EQ(loader.finish(), entries.size());
+        ASSERT_GT(loader.num_runs(), 1);
+    }
+    // 同一个key的两个rid中page_no小的在前
+    std::multimap<int, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        mock.emplace(i / 2, Rid{.page_no = i, .slot_no = i % 7});
+    }
+    check_all(ih_.get(), mock);
+
+    // 析构后删除所有临时文件
+    std::string run_file = disk_manager_->get_file_name(ih_->fd_) + ".run0";
+    ASSERT_FALSE(disk_manager_->is_file(run_file));
+}
+
+/**
+ * @brief 在已有数据的表上创建索引，索引包含表中所有记录
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexTest) {
+    const int scale = 3000;
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+
+    std::vector<int> keys;
+    for (int key = 0; key < scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::map<int, Rid> mock;
+    for (int key : keys) {
+        int buf[2] = {key, -key};
+        mock[key] = fh->insert_record((char *)buf, nullptr);
+    }
+
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+    check_all(sm_->ihs_.at(ix_name).get(), mock);
+}
+
+/**
+ * @brief 表中有重复的key时不能创建唯一索引，建了一半的索引文件被删除；非唯一索引包含所有记录
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateUniqueIndexTest) {
+    const int scale = 1000;
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::multimap<int, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        int buf[2] = {i % (scale / 2), i};
+        mock.emplace(buf[0], fh->insert_record((char *)buf, nullptr));
+    }
+
+    ASSERT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true), UniqueConstraintError);
+    ASSERT_FALSE(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+    ASSERT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).indexes.empty());
+
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+    ASSERT_FALSE(sm_->ihs_.at(ix_name)->file_hdr_->unique_);
+    check_all(sm_->ihs_.at(ix_name).get(), mock);
+}
+
+/**
+ * @brief 删除操作释放的结点放入空闲页面链表，之后插入时优先复用，反复插入删除后文件中的页面数量不再增长
+ */
+TEST_F(BPlusTreeBulkLoadTests, FreePageReuseTest) {
+    const int scale = 3000;
+    const int order = 4;
+    create_index(order, true);
+
+    std::vector<int> keys;
+    for (int key = 0; key < scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+    // 每一轮按相同的顺序插入，B+树的形状相同，需要的结点数量也相同
+    std::vector<int> delete_keys = keys;
+    int max_pages = 0;
+    for (int round = 0; round < 3; round++) {
+        std::map<int, Rid> mock;
+        for (int key : keys) {
+            Rid rid = {.page_no = key / 10, .slot_no = key % 10};
+            ih_->insert_entry((const char *)&key, rid, txn_.get());
+            mock[key] = rid;
+        }
+        check_all(ih_.get(), mock);
+        if (round == 0) {
+            max_pages = ih_->file_hdr_->num_pages_;
+            ASSERT_EQ(num_free_pages(ih_.get()), 0);
+        }
+        // 第一轮之后新的结点都应该来自空闲页面链表
+        ASSERT_LE(ih_->file_hdr_->num_pages_, max_pages);
+
+        // 按随机的顺序删除所有key，只剩下空的根结点
+        std::shuffle(delete_keys.begin(), delete_keys.end(), rng);
+        for (int i = 0; i < scale; i++) {
+            ASSERT_TRUE(ih_->delete_entry((const char *)&delete_keys[i], txn_.get()));
+            mock.erase(delete_keys[i]);
+            if (i == scale / 2) {
+                check_all(ih_.get(), mock);
+            }
+        }
+        // 除了文件头、叶子链表头结点和根结点，其他页面都在空闲页面链表中
+        ASSERT_EQ(num_free_pages(ih_.get()), ih_->file_hdr_->num_pages_ - IX_INIT_NUM_PAGES);
+    }
+}
+
+/**
+ * @brief REINDEX在新文件中重新构建索引：回收空闲页面，内容与表中的记录一致，临时文件被替换
+ */
+TEST_F(BPlusTreeBulkLoadTests, ReindexTest) {
+    const int scale = 3000;
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::map<int, Rid> mock;
+    for (int key = 0; key < scale; key++) {
+        int buf[2] = {key, -key};
+        mock[key] = fh->insert_record((char *)buf, nullptr);
+    }
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true);
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+
+    // 插入再删除表中不存在的key，留下大量空闲页面
+    IxIndexHandle *ih = sm_->ihs_.at(ix_name).get();
+    for (int key = scale; key < scale * 10; key++) {
+        Rid rid = {.page_no = key, .slot_no = 0};
+        ih->insert_entry((const char *)&key, rid, txn_.get());
+    }
+    for (int key = scale; key < scale * 10; key++) {
+        ASSERT_TRUE(ih->delete_entry((const char *)&key, txn_.get()));
+    }
+    int old_num_pages = ih->file_hdr_->num_pages_;
+    ASSERT_GT(num_free_pages(ih), 0);
+    check_all(ih, mock);
+
+    sm_->reindex(TEST_FILE_NAME, TEST_COL, nullptr);
+    ih = sm_->ihs_.at(ix_name).get();
+    ASSERT_LT(ih->file_hdr_->num_pages_, old_num_pages);
+    ASSERT_EQ(num_free_pages(ih), 0);
+    check_all(ih, mock);
+    ASSERT_FALSE(disk_manager_->is_file(ix_name + IX_REBUILD_SUFFIX));
+
+    // 不指定字段时重建表上的所有索引；不存在的索引throw IndexNotFoundError
+    sm_->reindex(TEST_FILE_NAME, {}, nullptr);
+    check_all(sm_->ihs_.at(ix_name).get(), mock);
+    ASSERT_THROW(sm_->reindex(TEST_FILE_NAME, {"col2"}, nullptr), IndexNotFoundError);
+}
+
+/**
+ * @brief 打开旧版本的数据库：db.meta中的索引没有类型和唯一性，按唯一的B+树读入；
+ * 没有版本号的旧格式索引文件用表中的记录重新构建
+ */
+TEST_F(BPlusTreeBulkLoadTests, UpgradeTest) {
+    const int scale = 1000;
+    RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::map<int, Rid> mock;
+    for (int key = 0; key < scale; key++) {
+        int buf[2] = {key, -key};
+        mock[key] = fh->insert_record((char *)buf, nullptr);
+    }
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true);
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+    // SetUp()没有通过open_db()进入数据库，db.meta中还需要数据库名称
+    sm_->db_.name_ = TEST_DB_NAME;
+    sm_->close_db();
+
+    // 去掉db.meta中索引的类型和唯一性
+    std::string meta_name = TEST_DB_NAME + "/" + DB_META_NAME;
+    std::ifstream ifs(meta_name);
+    std::string meta((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ifs.close();
+    std::string new_line = TEST_FILE_NAME + " 4 1 " + std::to_string(INDEX_BTREE) + " 1\n";
+    size_t pos = meta.find(new_line);
+    ASSERT_NE(std::string::npos, pos);
+    meta.replace(pos, new_line.size(), TEST_FILE_NAME + " 4 1\n");
+    std::ofstream(meta_name) << meta;
+    // 旧格式的索引文件头在版本号的位置存放文件头的长度
+    int fd = disk_manager_->open_file(TEST_DB_NAME + "/" + ix_name);
+    int old_tot_len = 48;
+    disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, (const char *)&old_tot_len, sizeof(int));
+    disk_manager_->close_file(fd);
+
+    sm_->open_db(TEST_DB_NAME);
+    auto &index = *sm_->db_.get_table(TEST_FILE_NAME).get_index_meta(TEST_COL);
+    ASSERT_EQ(INDEX_BTREE, index.type);
+    ASSERT_TRUE(index.unique);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_name).get();
+    ASSERT_EQ(IX_FILE_VERSION, ih->file_hdr_->version_);
+    ASSERT_TRUE(ih->file_hdr_->unique_);
+    check_all(ih, mock);
+}
@@ -67,7 +67,7 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         coldef.push_back({"col1", TYPE_INT, 4});
         coldef.push_back({"col2", TYPE_INT, 4});
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
-        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
         // 打开测试文件
         ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
@@ -376,6 +376,23 @@ void DeleteHelper(IxIndexHandle *tree, const std::vector<int64_t> &keys,
     delete transaction;
 }
 
+// helper function to run fn on every shard in its own thread, returns the throughput (ops/s)
+template <typename Fn>
+double RunParallelThroughput(const std::vector<std::vector<int64_t>> &shards, Fn fn) {
+    std::vector<std::thread> thread_group;
+    size_t ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto &shard : shards) {
+        thread_group.push_back(std::thread(fn, std::cref(shard)));
+        ops += shard.size();
+    }
+    for (auto &thread : thread_group) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ops / seconds;
+}
+
 /**
  * @brief concurrent insert 1~10000
  * 
@@ -462,4 +479,67 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
         scan.next();
     }
     EXPECT_EQ(size, keys.size() - delete_keys.size());
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 不同线程数下并发插入和点查的吞吐量
+ * 每一轮插入一段新的key，各线程负责其中交错的一部分；全部插入完成后各线程再查找自己插入的key
+ * 默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+ */
+TEST_F(BPlusTreeConcurrentTest, DISABLED_ThroughputBenchmark) {
+    const int64_t keys_per_round = 10000;
+    const std::vector<int> thread_nums = {1, 2, 4, 8, 16, 32};
+    const int order = 255;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+    IxIndexHandle *tree = ih_.get();
+
+    auto insert_shard = [tree](const std::vector<int64_t> &keys) {
+        Transaction transaction(0);
+        for (auto key : keys) {
+            Rid rid = {.page_no = static_cast<int32_t>(key >> 32), .slot_no = static_cast<int32_t>(key & 0xFFFFFFFF)};
+            tree->insert_entry((const char *)&key, rid, &transaction);
+        }
+    };
+    auto lookup_shard = [tree](const std::vector<int64_t> &keys) {
+        Transaction transaction(0);
+        std::vector<Rid> rids;
+        for (auto key : keys) {
+            rids.clear();
+            tree->get_value((const char *)&key, &rids, &transaction);
+            EXPECT_EQ(rids.size(), 1);
+        }
+    };
+
+    auto rng = std::default_random_engine{};
+    int64_t next_key = 1;
+    printf("%8s %16s %16s\n", "threads", "insert ops/s", "lookup ops/s");
+    for (int thread_num : thread_nums) {
+        std::vector<int64_t> keys;
+        for (int64_t i = 0; i < keys_per_round; i++) {
+            keys.push_back(next_key++);
+        }
+        std::shuffle(keys.begin(), keys.end(), rng);
+        std::vector<std::vector<int64_t>> shards(thread_num);
+        for (size_t i = 0; i < keys.size(); i++) {
+            shards[i % thread_num].push_back(keys[i]);
+        }
+
+        double insert_ops = RunParallelThroughput(shards, insert_shard);
+        double lookup_ops = RunParallelThroughput(shards, lookup_shard);
+        printf("%8d %16.0f %16.0f\n", thread_num, insert_ops, lookup_ops);
+    }
+
+    // 检查树结构以及所有key是否按序插入
+    check_tree(tree, tree->file_hdr_->root_page_);
+    check_leaf(tree);
+    int64_t current_key = 1;
+    IxScan scan(tree, tree->leaf_begin(), tree->leaf_end(), buffer_pool_manager_.get());
+    while (!scan.is_end()) {
+        EXPECT_EQ(scan.rid().slot_no, current_key);
+        current_key++;
+        scan.next();
+    }
+    EXPECT_EQ(current_key, next_key);
+}
@@ -65,7 +65,7 @@ class BPlusTreeTests : public ::testing::Test {
         coldef.push_back({"col1", TYPE_INT, 4});
         coldef.push_back({"col2", TYPE_INT, 4});
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
-        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
         // 打开测试文件
         ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
@@ -243,7 +243,11 @@ class BPlusTreeTests : public ::testing::Test {
             }
             if (i + 1 < node->get_size()) {
                 // 满足制约大小关系
-                ASSERT_LT(child_last_key, node->key_at(i + 1));  // child_last_key < node->KeyAt(i + 1)
+                if (ih->file_hdr_->unique_) {
+                    ASSERT_LT(child_last_key, node->key_at(i + 1));  // child_last_key < node->KeyAt(i + 1)
+                }
+                // 非唯一索引中重复的key可能跨越相邻的孩子，按附加了rid的完整key比较
+                ASSERT_LT(ix_compare(child->get_key(child->get_size() - 1), node->get_key(i + 1), ih->file_hdr_), 0);
             }
 
             buffer_pool_manager_->unpin_page(child->get_page_id(), false);
@@ -491,4 +495,77 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
     }
     std::cout << "Insert keys count: " << add_cnt << '\n' << "Delete keys count: " << del_cnt << '\n';
     check_all(ih_.get(), mock);
-}
\ No newline at end of file
+}
+/**
+ * @brief 非唯一索引：少量key重复插入很多次，同一个key的键值对跨越多个叶结点；
+ * get_value()按rid的顺序返回key的所有rid，按(key,rid)删除只删除对应的一条
+ */
+TEST_F(BPlusTreeTests, DuplicateKeyTest) {
+    const int scale = 3000;
+    const int num_keys = 20;
+    const int order = 4;
+
+    // SetUp()中建立的是唯一索引，换成非唯一索引
+    ix_manager_->close_index(ih_.get());
+    sm_->drop_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+    ASSERT_FALSE(ih_->file_hdr_->unique_);
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> key_dist(0, num_keys - 1);
+    // rid按插入的顺序递增，multimap中同一个key的rid也就按从小到大排列
+    std::multimap<int, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        int key = key_dist(rng);
+        Rid rid = {.page_no = i / 10, .slot_no = i % 10};
+        ASSERT_TRUE(ih_->insert_entry((const char *)&key, rid, txn_.get()));
+        // 同一个(key,rid)不会重复插入
+        ASSERT_FALSE(ih_->insert_entry((const char *)&key, rid, txn_.get()));
+        mock.emplace(key, rid);
+    }
+    auto check_values = [&]() {
+        for (int key = -1; key <= num_keys; key++) {
+            std::vector<Rid> rids;
+            bool found = ih_->get_value((const char *)&key, &rids, txn_.get());
+            auto range = mock.equal_range(key);
+            std::vector<Rid> expected;
+            for (auto it = range.first; it != range.second; it++) {
+                expected.push_back(it->second);
+            }
+            ASSERT_EQ(found, !expected.empty());
+            ASSERT_EQ(rids, expected);
+        }
+    };
+    check_all(ih_.get(), mock);
+    check_values();
+
+    // 随机删除一半的键值对，rid不匹配时不删除
+    std::vector<std::pair<int, Rid>> entries(mock.begin(), mock.end());
+    std::shuffle(entries.begin(), entries.end(), rng);
+    for (int i = 0; i < scale / 2; i++) {
+        auto [key, rid] = entries[i];
+        Rid missing = {.page_no = rid.page_no, .slot_no = rid.slot_no + 10};
+        ASSERT_FALSE(ih_->delete_entry((const char *)&key, missing, txn_.get()));
+        ASSERT_TRUE(ih_->delete_entry((const char *)&key, rid, txn_.get()));
+        auto range = mock.equal_range(key);
+        mock.erase(std::find_if(range.first, range.second, [&](auto &entry) { return entry.second == rid; }));
+        if (i % 500 == 0) {
+            check_all(ih_.get(), mock);
+            check_values();
+        }
+    }
+    check_all(ih_.get(), mock);
+    check_values();
+
+    // 不指定rid时删除key的所有键值对
+    for (int key = 0; key < num_keys; key += 2) {
+        ASSERT_EQ(ih_->delete_entry((const char *)&key, txn_.get()), mock.count(key) > 0);
+        mock.erase(key);
+    }
+    check_all(ih_.get(), mock);
+    check_values();
+}
@@ -65,7 +65,7 @@ class BPlusTreeTests : public ::testing::Test {
         coldef.push_back({"col1", TYPE_INT, 4});
         coldef.push_back({"col2", TYPE_INT, 4});
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
-        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+        sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_BTREE, true);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
         // 打开测试文件
         ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
@@ -412,4 +412,37 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
         scan.next();
     }
     EXPECT_EQ(current_key, keys.size() + 1);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 结点很小时随机插入：更小的key插入第一个孩子后，内部结点的第0个key可能大于后面的key，查找时不能受它影响
+ */
+TEST_F(BPlusTreeTests, SmallOrderRandomTest) {
+    const int scale = 3000;
+    const int order = 4;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::vector<Rid> rids;
+    for (size_t i = 0; i < keys.size(); i++) {
+        Rid rid = {.page_no = keys[i], .slot_no = 0};
+        ASSERT_TRUE(ih_->insert_entry((const char *)&keys[i], rid, txn_.get()));
+        // 每插入一些key检查之前插入的key都能查到
+        if (i % 100 == 0 || i + 1 == keys.size()) {
+            for (size_t j = 0; j <= i; j++) {
+                rids.clear();
+                ih_->get_value((const char *)&keys[j], &rids, txn_.get());
+                ASSERT_EQ(rids.size(), 1) << "key " << keys[j];
+                ASSERT_EQ(rids[0].page_no, keys[j]);
+            }
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <iomanip>
+#include <iostream>
+#include <random>  // for std::default_random_engine
+
+#include "gtest/gtest.h"
+
+#include "index/ix_index_handle.h"
+#include "index/ix_node_search.h"
+
+/** 测试单个INT字段的结点内查找：唯一索引的key和非唯一索引附加了rid的key，各个SIMD实现与
+ * std::lower_bound/std::upper_bound的结果一致；并在不同的结点填充程度下对比各个实现与逐个调用ix_compare()的二分查找的耗时 */
+
+const std::vector<IxSearchImpl> TEST_IMPLS = {IxSearchImpl::SCALAR, IxSearchImpl::SSE2, IxSearchImpl::AVX2};
+
+using Key = std::array<int, IX_INT_RID_WIDTH>;
+
+// 一个INT key的结点最多存放的key数量，与IxManager::create_index()中btree_order的计算一致
+const int TEST_UNIQUE_NODE_SIZE = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (sizeof(int) + sizeof(Rid)));
+const int TEST_NODE_SIZE =
+    static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (IX_INT_RID_WIDTH * sizeof(int) + sizeof(Rid)));
+
+// n个不重复的有序key，包含INT_MIN和INT_MAX，rid都是IX_MIN_RID
+std::vector<Key> make_keys(int n, std::default_random_engine &rng) {
+    std::uniform_int_distribution<int> dist(INT_MIN, INT_MAX);
+    std::vector<int> keys;
+    if (n > 0) {
+        keys.push_back(INT_MIN);
+    }
+    if (n > 1) {
+        keys.push_back(INT_MAX);
+    }
+    while (static_cast<int>(keys.size()) < n) {
+        keys.push_back(dist(rng));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<Key> rid_keys;
+    for (int key : keys) {
+        rid_keys.push_back({key, IX_MIN_RID.page_no, IX_MIN_RID.slot_no});
+    }
+    return rid_keys;
+}
+
+// 改造前的查找方式：每次比较都调用通用的ix_compare()
+int generic_search(const Key *keys, int n, const Key &target, bool upper) {
+    std::vector<ColType> col_types(IX_INT_RID_WIDTH, TYPE_INT);
+    std::vector<int> col_lens(IX_INT_RID_WIDTH, sizeof(int));
+    int left = 0, right = n;
+    while (left < right) {
+        int mid = (left + right) / 2;
+        int cmp = ix_compare((const char *)target.data(), (const char *)keys[mid].data(), col_types, col_lens);
+        if (cmp > 0 || (upper && cmp == 0)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief 唯一索引的key：所有实现的结果都与std::lower_bound/std::upper_bound一致
+ */
+TEST(BPlusTreeNodeSearchTest, SearchTest) {
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> dist(-100, 100);
+    for (int n : {0, 1, 2, 7, 8, 9, 31, 32, 33, 65, 100, TEST_UNIQUE_NODE_SIZE}) {
+        std::vector<int> keys;
+        for (int i = 0; i < n; i++) {
+            keys.push_back(dist(rng) * 3);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<int> targets = {INT_MIN, INT_MAX};
+        for (int target = -301; target <= 301; target++) {
+            targets.push_back(target);
+        }
+        int size = static_cast<int>(keys.size());
+        for (int target : targets) {
+            int lower = std::lower_bound(keys.begin(), keys.end(), target) - keys.begin();
+            int upper = std::upper_bound(keys.begin(), keys.end(), target) - keys.begin();
+            ASSERT_EQ(ix_int_key_lower_bound(keys.data(), size, &target, 1), lower);
+            ASSERT_EQ(ix_int_key_upper_bound(keys.data(), size, &target, 1), upper);
+            for (auto impl : TEST_IMPLS) {
+                if (!ix_int_search_supported(impl)) {
+                    continue;
+                }
+                ASSERT_EQ(ix_int_key_search(impl, keys.data(), size, &target, 1, false), lower) << ix_search_impl_name(impl);
+                ASSERT_EQ(ix_int_key_search(impl, keys.data(), size, &target, 1, true), upper) << ix_search_impl_name(impl);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 非唯一索引附加了rid的key：少量不同的key各自重复多次，所有实现的结果都与按字典序比较的std::lower_bound/std::upper_bound一致
+ */
+TEST(BPlusTreeNodeSearchTest, RidSearchTest) {
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> dist(-3, 3);
+    for (int n : {0, 1, 2, 7, 8, 9, 31, 32, 33, 65, 100, TEST_NODE_SIZE}) {
+        std::vector<Key> keys;
+        for (int i = 0; i < n; i++) {
+            keys.push_back({dist(rng), dist(rng), dist(rng)});
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<Key> targets = {{INT_MIN, INT_MIN, INT_MIN}, {INT_MAX, INT_MAX, INT_MAX}};
+        for (int key = -4; key <= 4; key++) {
+            targets.push_back({key, INT_MIN, INT_MIN});
+            targets.push_back({key, INT_MAX, INT_MAX});
+            for (int i = 0; i < 10; i++) {
+                targets.push_back({key, dist(rng), dist(rng)});
+            }
+        }
+        const int *data = keys.empty() ? nullptr : keys[0].data();
+        int size = static_cast<int>(keys.size());
+        for (auto &target : targets) {
+            int lower = std::lower_bound(keys.begin(), keys.end(), target) - keys.begin();
+            int upper = std::upper_bound(keys.begin(), keys.end(), target) - keys.begin();
+            ASSERT_EQ(ix_int_key_lower_bound(data, size, target.data(), IX_INT_RID_WIDTH), lower);
+            ASSERT_EQ(ix_int_key_upper_bound(data, size, target.data(), IX_INT_RID_WIDTH), upper);
+            for (auto impl : TEST_IMPLS) {
+                if (!ix_int_search_supported(impl)) {
+                    continue;
+                }
+                ASSERT_EQ(ix_int_key_search(impl, data, size, target.data(), IX_INT_RID_WIDTH, false), lower)
+                    << ix_search_impl_name(impl);
+                ASSERT_EQ(ix_int_key_search(impl, data, size, target.data(), IX_INT_RID_WIDTH, true), upper)
+                    << ix_search_impl_name(impl);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 不同结点填充程度下非唯一索引每次结点内查找的平均耗时（只输出结果，不作断言）
+ * 默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+ */
+TEST(BPlusTreeNodeSearchTest, DISABLED_NodeSearchBenchmark) {
+    const int num_searches = 200000;
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> dist(INT_MIN, INT_MAX);
+    std::vector<Key> targets(num_searches);
+    for (Key &target : targets) {
+        target = {dist(rng), IX_MIN_RID.page_no, IX_MIN_RID.slot_no};
+    }
+
+    std::cout << "selected implementation: " << ix_search_impl_name(ix_int_search_impl()) << std::endl;
+    std::cout << std::setw(6) << "fill" << std::setw(6) << "keys" << std::setw(10) << "generic";
+    for (auto impl : TEST_IMPLS) {
+        std::cout << std::setw(10) << ix_search_impl_name(impl);
+    }
+    std::cout << "   (ns per search)" << std::endl;
+
+    for (int percent : {10, 25, 50, 75, 100}) {
+        int n = TEST_NODE_SIZE * percent / 100;
+        std::vector<Key> keys = make_keys(n, rng);
+        const int *data = keys.empty() ? nullptr : keys[0].data();
+        auto measure = [&](auto search) {
+            long checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const Key &target : targets) {
+                checksum += search(target);
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            EXPECT_GE(checksum, 0);
+            return static_cast<double>(ns.count()) / num_searches;
+        };
+
+        std::cout << std::setw(5) << percent << "%" << std::setw(6) << n << std::fixed << std::setprecision(1);
+        std::cout << std::setw(10) << measure([&](const Key &target) { return generic_search(keys.data(), n, target, false); });
+        for (auto impl : TEST_IMPLS) {
+            if (!ix_int_search_supported(impl)) {
+                std::cout << std::setw(10) << "-";
+                continue;
+            }
+            std::cout << std::setw(10)
+                      << measure([&](const Key &target) {
+                             return ix_int_key_search(impl, data, n, target.data(), IX_INT_RID_WIDTH, false);
+                         });
+        }
+        std::cout << std::endl;
+    }
+}
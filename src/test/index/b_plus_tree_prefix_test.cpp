@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>  // for std::default_random_engine
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "system/sm.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+#include "record/rm.h"
+const std::string TEST_DB_NAME = "BPlusTreePrefixTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                // 测试文件名的前缀
+const int TEST_KEY_LEN = 32;
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，然后在此目录下创建表TEST_FILE_NAME
+ * 测试点在表的字符串字段上创建规范化格式（或原始格式）的索引，key有很长的公共前缀 */
+
+class BPlusTreePrefixTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+    std::vector<ColMeta> index_cols_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        // 如果测试目录存在，则先删除测试目录
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        // 进入测试目录
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"name", TYPE_STRING, TEST_KEY_LEN});
+        coldef.push_back({"id", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+        index_cols_ = {*sm_->db_.get_table(TEST_FILE_NAME).get_col("name")};
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        close_index();
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    void create_index(bool normalized) {
+        close_index();
+        if (ix_manager_->exists(TEST_FILE_NAME, index_cols_)) {
+            ix_manager_->destroy_index(TEST_FILE_NAME, index_cols_);
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, index_cols_, normalized, true);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, index_cols_);
+    }
+
+    void close_index() {
+        if (ih_ != nullptr) {
+            ix_manager_->close_index(ih_.get());
+            // 重新创建的索引文件可能复用同一个fd，先从缓冲池中删除旧文件的页面
+            for (int page_no = 0; page_no < disk_manager_->get_fd2pageno(ih_->fd_); page_no++) {
+                buffer_pool_manager_->delete_page({.fd = ih_->fd_, .page_no = page_no});
+            }
+            ih_.reset();
+        }
+    }
+
+    // 第i个key：公共前缀 + 8位数字，末尾用'\0'补齐
+    static std::string make_key(int i) {
+        char buf[TEST_KEY_LEN + 1];
+        memset(buf, 0, sizeof(buf));
+        snprintf(buf, sizeof(buf), "warehouse-1/district-7/%08d", i);
+        return std::string(buf, TEST_KEY_LEN);
+    }
+
+    /**------ 以下为辅助检查函数 ------*/
+
+    /**
+     * @brief 检查叶子层的前驱指针和后继指针，返回叶结点的数量
+     */
+    int check_leaf(const IxIndexHandle *ih) {
+        int num_leaves = 0;
+        page_id_t leaf_no = ih->file_hdr_->first_leaf_;
+        while (leaf_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *curr = ih->fetch_node(leaf_no);
+            IxNodeHandle *next = ih->fetch_node(curr->get_next_leaf());
+            EXPECT_EQ(next->get_prev_leaf(), leaf_no);
+            if (curr->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+                EXPECT_EQ(ih->file_hdr_->last_leaf_, leaf_no);
+            }
+            leaf_no = curr->get_next_leaf();
+            buffer_pool_manager_->unpin_page(curr->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(next->get_page_id(), false);
+            delete curr;
+            delete next;
+            num_leaves++;
+        }
+        return num_leaves;
+    }
+
+    /**
+     * @brief dfs遍历整个树，检查结点的大小、父结点，以及key都在父结点给出的范围[lower, upper)内，
+     * 结点的公共前缀不长于范围两端的公共前缀（没有上界或下界时没有公共前缀）
+     */
+    void check_tree(const IxIndexHandle *ih, int now_page_no, const std::string *lower, const std::string *upper) {
+        IxNodeHandle *node = ih->fetch_node(now_page_no);
+        int len = ih->file_hdr_->col_tot_len_;
+        if (now_page_no != ih->file_hdr_->root_page_) {
+            EXPECT_GE(node->get_size(), node->get_min_size());
+        }
+        EXPECT_LT(node->get_size(), node->get_max_size());
+        if (lower == nullptr || upper == nullptr) {
+            EXPECT_EQ(node->get_prefix_len(), 0);
+        } else {
+            EXPECT_LE(node->get_prefix_len(), ix_common_prefix(lower->data(), upper->data(), len));
+        }
+        std::vector<std::string> keys;
+        for (int i = 0; i < node->get_size(); i++) {
+            keys.emplace_back(node->get_key(i), len);
+        }
+        for (int i = 0; i < node->get_size(); i++) {
+            if (i > 0) {
+                EXPECT_LT(keys[i - 1], keys[i]);
+            }
+            if (node->is_leaf_page() || i > 0) {
+                EXPECT_TRUE(lower == nullptr || *lower <= keys[i]);
+            }
+            EXPECT_TRUE(upper == nullptr || keys[i] < *upper);
+        }
+        if (!node->is_leaf_page()) {
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+                EXPECT_EQ(child->get_parent_page_no(), now_page_no);
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+                const std::string *child_lower = i == 0 ? lower : &keys[i];
+                const std::string *child_upper = i + 1 == node->get_size() ? upper : &keys[i + 1];
+                check_tree(ih, node->value_at(i), child_lower, child_upper);
+            }
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+    }
+
+    /**
+     * @param mock 函数外部记录的(key,rid)，key不重复
+     */
+    void check_all(IxIndexHandle *ih, const std::map<std::string, Rid> &mock) {
+        check_tree(ih, ih->file_hdr_->root_page_, nullptr, nullptr);
+        check_leaf(ih);
+
+        std::vector<Rid> rids;
+        for (auto &entry : mock) {
+            rids.clear();
+            ih->get_value(entry.first.data(), &rids, txn_.get());
+            ASSERT_EQ(rids.size(), 1);
+            ASSERT_EQ(rids[0], entry.second);
+        }
+
+        IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+        auto it = mock.begin();
+        while (!scan.is_end() && it != mock.end()) {
+            ASSERT_EQ(scan.rid(), it->second);
+            it++;
+            scan.next();
+        }
+        ASSERT_EQ(scan.is_end(), true);
+        ASSERT_EQ(it, mock.end());
+    }
+
+    // 检查lower_bound()：对不在索引中的key，结果是第一个更大的key，可能在下一个叶结点
+    void check_lower_bound(IxIndexHandle *ih, const std::map<std::string, Rid> &mock, int scale) {
+        for (int i = 0; i <= scale * 2 + 1; i += 7) {
+            std::string key = make_key(i);
+            Iid iid = ih->lower_bound(key.data());
+            auto pos = mock.lower_bound(key);
+            if (pos == mock.end()) {
+                ASSERT_EQ(iid, ih->leaf_end());
+            } else {
+                ASSERT_EQ(ih->get_rid(iid), pos->second);
+            }
+        }
+    }
+};
+
+/**
+ * @brief 规范化的key之间用memcmp比较，结果与ix_compare()一致，并且可以还原为原始的key
+ */
+TEST_F(BPlusTreePrefixTests, NormalizeKeyTest) {
+    std::vector<ColType> types = {TYPE_INT, TYPE_FLOAT, TYPE_STRING};
+    std::vector<int> lens = {4, 4, 4};
+    std::vector<float> floats = {0.0f, -0.0f, 1.5f, -1.5f, 1e-30f, -1e-30f, 3e38f, -3e38f, INFINITY, -INFINITY};
+    std::vector<int> ints = {0, 1, -1, 7, -7, INT32_MAX, INT32_MIN};
+    std::vector<std::string> strs = {std::string("\0\0\0\0", 4), "abc\0", "abd\0", "ab\xff\0", "zzzz"};
+
+    std::vector<std::string> keys;
+    for (int i : ints) {
+        for (float f : floats) {
+            for (auto &s : strs) {
+                char key[12];
+                memcpy(key, &i, 4);
+                memcpy(key + 4, &f, 4);
+                memcpy(key + 8, s.data(), 4);
+                keys.emplace_back(key, 12);
+            }
+        }
+    }
+    auto sign = [](int x) { return (x > 0) - (x < 0); };
+    for (auto &a : keys) {
+        char norm_a[12], raw_a[12];
+        ix_normalize_key(a.data(), norm_a, types, lens);
+        ix_denormalize_key(norm_a, raw_a, types, lens);
+        ASSERT_EQ(ix_compare(raw_a, a.data(), types, lens), 0);
+        for (auto &b : keys) {
+            char norm_b[12];
+            ix_normalize_key(b.data(), norm_b, types, lens);
+            ASSERT_EQ(sign(memcmp(norm_a, norm_b, 12)), sign(ix_compare(a.data(), b.data(), types, lens)));
+        }
+    }
+}
+
+/**
+ * @brief 规范化格式下乱序插入和删除，B+树的结构、公共前缀和内容都正确
+ */
+TEST_F(BPlusTreePrefixTests, InsertDeleteTest) {
+    const int scale = 5000;
+    create_index(true);
+    ASSERT_TRUE(ih_->file_hdr_->normalized_);
+
+    std::vector<int> keys;
+    for (int i = 1; i <= scale; i++) {
+        keys.push_back(i * 2);  // 留出奇数key用于lower_bound
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::map<std::string, Rid> mock;
+    for (int i : keys) {
+        Rid rid = {.page_no = i / 10, .slot_no = i % 10};
+        ih_->insert_entry(make_key(i).data(), rid, txn_.get());
+        mock[make_key(i)] = rid;
+    }
+    check_all(ih_.get(), mock);
+    check_lower_bound(ih_.get(), mock, scale);
+
+    // 删除大部分key，再重新插入一部分
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (int i = 0; i < scale * 9 / 10; i++) {
+        ASSERT_TRUE(ih_->delete_entry(make_key(keys[i]).data(), txn_.get()));
+        mock.erase(make_key(keys[i]));
+    }
+    check_all(ih_.get(), mock);
+    for (int i = 0; i < scale / 2; i++) {
+        Rid rid = {.page_no = keys[i], .slot_no = 0};
+        ih_->insert_entry(make_key(keys[i]).data(), rid, txn_.get());
+        mock[make_key(keys[i])] = rid;
+    }
+    check_all(ih_.get(), mock);
+    check_lower_bound(ih_.get(), mock, scale);
+
+    // 全部删除后只剩下空的根结点，仍然可以查找和重新插入
+    for (auto &entry : std::map<std::string, Rid>(mock)) {
+        ASSERT_TRUE(ih_->delete_entry(entry.first.data(), txn_.get()));
+    }
+    mock.clear();
+    check_all(ih_.get(), mock);
+    check_lower_bound(ih_.get(), mock, scale);
+    for (int i = 0; i < scale / 10; i++) {
+        Rid rid = {.page_no = keys[i], .slot_no = 1};
+        ih_->insert_entry(make_key(keys[i]).data(), rid, txn_.get());
+        mock[make_key(keys[i])] = rid;
+    }
+    check_all(ih_.get(), mock);
+}
+
+/**
+ * @brief 公共前缀很长时，规范化格式的结点能存放更多的键值对，叶结点的数量明显减少
+ */
+TEST_F(BPlusTreePrefixTests, FanoutTest) {
+    const int scale = 5000;
+    std::vector<int> keys;
+    for (int i = 0; i < scale; i++) {
+        keys.push_back(i);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    int num_leaves[2];
+    for (bool normalized : {false, true}) {
+        create_index(normalized);
+        std::map<std::string, Rid> mock;
+        for (int i : keys) {
+            Rid rid = {.page_no = i, .slot_no = 0};
+            ih_->insert_entry(make_key(i).data(), rid, txn_.get());
+            mock[make_key(i)] = rid;
+        }
+        check_all(ih_.get(), mock);
+        num_leaves[normalized] = check_leaf(ih_.get());
+    }
+    ASSERT_LT(num_leaves[1] * 2, num_leaves[0]);
+}
+
+/**
+ * @brief 规范化格式下批量构建的结点带有公共前缀，构建后仍然可以正常插入和删除
+ */
+TEST_F(BPlusTreePrefixTests, BulkLoadTest) {
+    auto rng = std::default_random_engine{};
+    for (int scale : {0, 1, 10, 300, 5000, 20000}) {
+        create_index(true);
+        std::vector<int> keys;
+        for (int i = 1; i <= scale; i++) {
+            keys.push_back(i * 2);
+        }
+        std::shuffle(keys.begin(), keys.end(), rng);
+
+        std::map<std::string, Rid> mock;
+        IxBulkLoader loader(ih_.get());
+        for (int i : keys) {
+            Rid rid = {.page_no = i / 10, .slot_no = i % 10};
+            loader.add(make_key(i).data(), rid);
+            mock[make_key(i)] = rid;
+        }
+        ASSERT_EQ(loader.finish(), static_cast<size_t>(scale));
+        if (scale == 0) {
+            continue;
+        }
+        check_all(ih_.get(), mock);
+        check_lower_bound(ih_.get(), mock, scale);
+
+        // 插入奇数key，删除一半偶数key
+        for (int i = 0; i < scale; i++) {
+            int key = keys[i] + 1;
+            Rid rid = {.page_no = key / 10, .slot_no = key % 10};
+            ih_->insert_entry(make_key(key).data(), rid, txn_.get());
+            mock[make_key(key)] = rid;
+            if (i % 2 == 0) {
+                ASSERT_TRUE(ih_->delete_entry(make_key(keys[i]).data(), txn_.get()));
+                mock.erase(make_key(keys[i]));
+            }
+        }
+        check_all(ih_.get(), mock);
+    }
+}
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>  // for std::default_random_engine
+#include <set>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "system/sm.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+#include "record/rm.h"
+const std::string TEST_DB_NAME = "HashIndexTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";          // 测试文件名的前缀
+
+struct RidLess {
+    bool operator()(const Rid &a, const Rid &b) const {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    }
+};
+using Mock = std::map<int, std::set<Rid, RidLess>>;
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，然后在此目录下创建INT字段上的哈希索引
+ * 测试点可以调小桶的容量，让少量的键值对也会触发桶的分裂、目录的扩大和溢出页，
+ * 查找结果与std::map记录的结果一致，目录和桶的局部深度仍然满足可扩展哈希的约束 */
+
+class HashIndexTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxHashHandle> hh_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+    std::vector<ColMeta> index_cols_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(256, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        txn_ = std::make_unique<Transaction>(0);
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        // 如果测试目录存在，则先删除测试目录
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        // 进入测试目录
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        index_cols_ = {{.tab_name = TEST_FILE_NAME, .name = "col1", .type = TYPE_INT, .len = sizeof(int), .offset = 0,
+                        .index = false}};
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        if (hh_ != nullptr) {
+            ix_manager_->close_hash_index(hh_.get());
+            hh_.reset();
+        }
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    // capacity为0时使用按页面大小计算的桶容量
+    void create_index(int capacity) {
+        ix_manager_->create_hash_index(TEST_FILE_NAME, index_cols_);
+        hh_ = ix_manager_->open_hash_index(TEST_FILE_NAME, index_cols_);
+        if (capacity > 0) {
+            assert(capacity <= hh_->file_hdr_->bucket_capacity_);
+            hh_->file_hdr_->bucket_capacity_ = capacity;
+        }
+    }
+
+    void reopen_index() {
+        int capacity = hh_->file_hdr_->bucket_capacity_;
+        ix_manager_->close_hash_index(hh_.get());
+        hh_ = ix_manager_->open_hash_index(TEST_FILE_NAME, index_cols_);
+        ASSERT_EQ(hh_->file_hdr_->bucket_capacity_, capacity);
+    }
+
+    void check_all(const Mock &mock) {
+        for (auto &entry : mock) {
+            std::vector<Rid> rids;
+            bool found = hh_->get_value((const char *)&entry.first, &rids, txn_.get());
+            ASSERT_EQ(found, !entry.second.empty());
+            ASSERT_EQ(std::vector<Rid>(entry.second.begin(), entry.second.end()), rids) << "key " << entry.first;
+        }
+    }
+
+    /**
+     * @brief 检查可扩展哈希的结构：指向同一个桶的槽位恰好有2^(global_depth - local_depth)个，且低local_depth位相同；
+     * 桶中每个键值对的哈希值都落在指向这个桶的槽位上；返回键值对的总数
+     */
+    size_t check_structure() {
+        auto &dir = hh_->dir_;
+        int global_depth = hh_->file_hdr_->global_depth_;
+        EXPECT_EQ(dir.size(), static_cast<size_t>(1) << global_depth);
+        std::map<page_id_t, std::vector<size_t>> slots;
+        for (size_t i = 0; i < dir.size(); i++) {
+            slots[dir[i]].push_back(i);
+        }
+        size_t num_entries = 0;
+        for (auto &entry : slots) {
+            Page *bucket = hh_->fetch_page(entry.first);
+            int local_depth = IxHashHandle::bucket_hdr(bucket)->local_depth;
+            EXPECT_LE(local_depth, global_depth);
+            EXPECT_EQ(entry.second.size(), static_cast<size_t>(1) << (global_depth - local_depth));
+            uint64_t mask = (static_cast<uint64_t>(1) << local_depth) - 1;
+            for (size_t slot : entry.second) {
+                EXPECT_EQ(slot & mask, entry.second[0] & mask);
+            }
+            for (page_id_t page_no = entry.first; page_no != IX_NO_PAGE;) {
+                Page *page = page_no == entry.first ? bucket : hh_->fetch_page(page_no);
+                auto hdr = IxHashHandle::bucket_hdr(page);
+                EXPECT_LE(hdr->num_entries, hh_->file_hdr_->bucket_capacity_);
+                for (int i = 0; i < hdr->num_entries; i++) {
+                    EXPECT_EQ(hh_->entry_hash(hh_->entry_at(page, i)) & mask, entry.second[0] & mask);
+                }
+                num_entries += hdr->num_entries;
+                page_no = hdr->next_overflow;
+                if (page != bucket) {
+                    hh_->unpin_page(page, false);
+                }
+            }
+            hh_->unpin_page(bucket, false);
+        }
+        return num_entries;
+    }
+};
+
+/**
+ * @brief 随机插入和删除带有重复key的键值对，结果与std::map一致；重复的(key, rid)不能插入，不存在的不能删除
+ */
+TEST_F(HashIndexTests, InsertDeleteTest) {
+    create_index(4);
+    auto rng = std::default_random_engine{};
+    std::uniform_int_distribution<int> key_dist(-300, 300);
+    std::uniform_int_distribution<int> rid_dist(0, 7);
+    Mock mock;
+    size_t num_entries = 0;
+    for (int round = 0; round < 20000; round++) {
+        int key = key_dist(rng);
+        Rid rid = {rid_dist(rng), rid_dist(rng)};
+        bool exists = mock[key].count(rid) > 0;
+        if (round % 3 == 2) {
+            ASSERT_EQ(hh_->delete_entry((const char *)&key, rid, txn_.get()), exists);
+            mock[key].erase(rid);
+            num_entries -= exists;
+        } else {
+            ASSERT_EQ(hh_->insert_entry((const char *)&key, rid, txn_.get()), !exists);
+            mock[key].insert(rid);
+            num_entries += !exists;
+        }
+    }
+    EXPECT_GT(static_cast<size_t>(1) << hh_->get_global_depth(), static_cast<size_t>(IX_HASH_DIR_SLOTS_PER_PAGE));
+    check_all(mock);
+    EXPECT_EQ(check_structure(), num_entries);
+    // 目录占用多个目录页时也能正确写回和读入
+    reopen_index();
+    check_all(mock);
+    EXPECT_EQ(check_structure(), num_entries);
+
+    // 批量接口与逐个调用的结果相同
+    std::vector<int> keys;
+    std::vector<Rid> rids;
+    for (auto &entry : mock) {
+        for (auto &rid : entry.second) {
+            keys.push_back(entry.first);
+            rids.push_back(rid);
+        }
+    }
+    std::vector<const char *> key_ptrs;
+    for (auto &key : keys) {
+        key_ptrs.push_back((const char *)&key);
+    }
+    std::vector<std::vector<Rid>> result;
+    hh_->get_values(key_ptrs, &result, txn_.get());
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(std::vector<Rid>(mock[keys[i]].begin(), mock[keys[i]].end()), result[i]);
+    }
+    EXPECT_EQ(hh_->delete_entries(key_ptrs, rids, txn_.get()), keys.size());
+    EXPECT_EQ(hh_->delete_entries(key_ptrs, rids, txn_.get()), 0u);
+    EXPECT_EQ(check_structure(), 0u);
+    EXPECT_EQ(hh_->insert_entries(key_ptrs, rids, txn_.get()), keys.size());
+    check_all(mock);
+}
+
+/**
+ * @brief 同一个key的大量重复无法通过分裂分开，存放在溢出页中；删除后溢出页被回收，再次插入时复用
+ */
+TEST_F(HashIndexTests, OverflowTest) {
+    create_index(4);
+    const int key = 42, other = 7;
+    Mock mock;
+    for (int i = 0; i < 200; i++) {
+        Rid rid = {i / 10, i % 10};
+        ASSERT_TRUE(hh_->insert_entry((const char *)&key, rid, txn_.get()));
+        mock[key].insert(rid);
+    }
+    ASSERT_TRUE(hh_->insert_entry((const char *)&other, {1, 1}, txn_.get()));
+    mock[other].insert({1, 1});
+    EXPECT_LE(hh_->get_global_depth(), IX_HASH_MAX_DEPTH);
+    check_all(mock);
+    EXPECT_EQ(check_structure(), 201u);
+
+    int num_pages = hh_->file_hdr_->num_pages_;
+    for (auto &rid : mock[key]) {
+        ASSERT_TRUE(hh_->delete_entry((const char *)&key, rid, txn_.get()));
+    }
+    EXPECT_NE(hh_->file_hdr_->first_free_page_no_, IX_NO_PAGE);
+    for (auto &rid : mock[key]) {
+        ASSERT_TRUE(hh_->insert_entry((const char *)&key, rid, txn_.get()));
+    }
+    EXPECT_EQ(hh_->file_hdr_->num_pages_, num_pages);
+    check_all(mock);
+}
+
+/**
+ * @brief 关闭并重新打开索引之后，目录和所有键值对保持不变
+ */
+TEST_F(HashIndexTests, ReopenTest) {
+    create_index(0);
+    Mock mock;
+    for (int i = 0; i < 30000; i++) {
+        int key = i % 10000;
+        Rid rid = {i, i % 3};
+        ASSERT_TRUE(hh_->insert_entry((const char *)&key, rid, txn_.get()));
+        mock[key].insert(rid);
+    }
+    int global_depth = hh_->get_global_depth();
+    EXPECT_GT(global_depth, 0);
+    std::vector<page_id_t> dir = hh_->dir_;
+    reopen_index();
+    EXPECT_EQ(hh_->get_global_depth(), global_depth);
+    EXPECT_EQ(hh_->dir_, dir);
+    check_all(mock);
+    EXPECT_EQ(check_structure(), 30000u);
+}
+
+/**
+ * @brief 多个线程同时插入和删除不同的键值对
+ */
+TEST_F(HashIndexTests, ConcurrentTest) {
+    create_index(8);
+    const int num_threads = 4, per_thread = 3000;
+    auto insert_range = [&](int tid) {
+        Transaction txn(tid + 1);
+        for (int i = 0; i < per_thread; i++) {
+            int key = (i * num_threads + tid) % 2000;
+            EXPECT_TRUE(hh_->insert_entry((const char *)&key, {tid, i}, &txn));
+        }
+    };
+    auto delete_half = [&](int tid) {
+        Transaction txn(tid + 1);
+        for (int i = 0; i < per_thread; i += 2) {
+            int key = (i * num_threads + tid) % 2000;
+            EXPECT_TRUE(hh_->delete_entry((const char *)&key, {tid, i}, &txn));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back(insert_range, tid);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    EXPECT_EQ(check_structure(), static_cast<size_t>(num_threads * per_thread));
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back(delete_half, tid);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    Mock mock;
+    for (int tid = 0; tid < num_threads; tid++) {
+        for (int i = 1; i < per_thread; i += 2) {
+            mock[(i * num_threads + tid) % 2000].insert({tid, i});
+        }
+    }
+    check_all(mock);
+    EXPECT_EQ(check_structure(), static_cast<size_t>(num_threads * per_thread / 2));
+}
@@ -0,0 +1,87 @@
+#include "record/bitmap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 逐位查找的参考实现（改写前的Bitmap::next_bit）
+ */
+static int next_bit_bitwise(bool bit, const char *bm, int max_n, int curr) {
+    for (int i = curr + 1; i < max_n; i++) {
+        if (Bitmap::is_set(bm, i) == bit) {
+            return i;
+        }
+    }
+    return max_n;
+}
+
+/**
+ * @brief 与逐位查找的结果对比，覆盖各种长度（含不足一个字、不是8的倍数）与密度
+ */
+TEST(BitmapTest, NextBitTest) {
+    std::mt19937 rng(0);
+    for (int max_n : {1, 7, 8, 9, 63, 64, 65, 127, 200, 1000}) {
+        for (int density : {0, 1, 50, 99, 100}) {
+            std::vector<char> bm((max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH);
+            Bitmap::init(bm.data(), bm.size());
+            int expected_count = 0;
+            for (int i = 0; i < max_n; i++) {
+                if (static_cast<int>(rng() % 100) < density) {
+                    Bitmap::set(bm.data(), i);
+                    expected_count++;
+                }
+            }
+            EXPECT_EQ(expected_count, Bitmap::count(bm.data(), max_n));
+            for (int curr = -1; curr < max_n; curr++) {
+                for (bool bit : {false, true}) {
+                    ASSERT_EQ(next_bit_bitwise(bit, bm.data(), max_n, curr), Bitmap::next_bit(bit, bm.data(), max_n, curr))
+                        << "max_n=" << max_n << " density=" << density << " curr=" << curr << " bit=" << bit;
+                }
+            }
+            EXPECT_EQ(next_bit_bitwise(false, bm.data(), max_n, -1), Bitmap::first_bit(false, bm.data(), max_n));
+        }
+    }
+    // 最后一个字节中超出max_n的位不影响结果
+    char bm[2] = {static_cast<char>(0xff), static_cast<char>(0xf0)};
+    EXPECT_EQ(10, Bitmap::next_bit(false, bm, 10, -1));
+    EXPECT_EQ(10, Bitmap::count(bm, 10));
+    EXPECT_EQ(12, Bitmap::first_bit(false, bm, 16));
+}
+
+/**
+ * @brief 对比逐位查找和按64位字查找：模拟扫描页面中所有记录（找1）和插入时查找空闲slot（找0）
+ * 默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+ */
+TEST(BitmapTest, DISABLED_SearchBenchmark) {
+    const int max_n = 2000;  // 记录很小时一个页面中的slot个数
+    const int rounds = 2000;
+    std::vector<char> bm((max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH);
+    std::mt19937 rng(0);
+    for (int density : {5, 50, 95}) {
+        Bitmap::init(bm.data(), bm.size());
+        for (int i = 0; i < max_n; i++) {
+            if (static_cast<int>(rng() % 100) < density) Bitmap::set(bm.data(), i);
+        }
+        auto run = [&](auto next_bit) {
+            long checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < rounds; r++) {
+                for (int i = next_bit(true, bm.data(), max_n, -1); i < max_n; i = next_bit(true, bm.data(), max_n, i)) {
+                    checksum += i;
+                }
+                checksum += next_bit(false, bm.data(), max_n, -1);
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            return std::make_pair(checksum, ms);
+        };
+        auto bitwise = run(next_bit_bitwise);
+        auto wordwise = run(Bitmap::next_bit);
+        EXPECT_EQ(bitwise.first, wordwise.first);
+        printf("density %3d%%: bit-at-a-time %8.2f ms, word-at-a-time %8.2f ms, speedup %.1fx\n", density,
+               bitwise.second, wordwise.second, bitwise.second / wordwise.second);
+    }
+}
@@ -427,3 +427,285 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+/**
+ * @brief 分区缓冲池并发测试（多文件）
+ * @note 每个线程在各自的文件上反复新建、写入、读取页面；页面数远大于缓冲池帧数，
+ * 淘汰写回与读入在不同分区上并发进行，检查所有页面的数据在淘汰后仍然正确
+ */
+TEST_F(BufferPoolManagerTest, PartitionedConcurrencyTest) {
+    const int num_threads = 8;
+    const int num_partitions = 4;
+    const int buffer_pool_size = 64;
+    const int pages_per_thread = 64;
+    const int num_rounds = 5;
+
+    // 分别使用各种置换策略
+    for (const std::string &replacer_type : std::vector<std::string>{"LRU", "CLOCK", "LRU-K"}) {
+        auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+        auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, num_partitions, replacer_type);
+        EXPECT_EQ(bpm->get_num_partitions(), static_cast<size_t>(num_partitions));
+
+        std::vector<int> fds;
+        for (int tid = 0; tid < num_threads; tid++) {
+            std::string filename = "partitioned_test_" + replacer_type + std::to_string(tid);
+            disk_manager_->create_file(filename);
+            fds.push_back(disk_manager_->open_file(filename));
+        }
+
+        std::vector<std::vector<PageId>> all_page_ids(num_threads);
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.emplace_back([&bpm, &fds, &all_page_ids, tid]() {
+                int fd = fds[tid];
+                std::vector<PageId> &page_ids = all_page_ids[tid];
+                for (int i = 0; i < pages_per_thread; i++) {
+                    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+                    Page *page = bpm->new_page(&page_id);
+                    while (page == nullptr) {
+                        page = bpm->new_page(&page_id);
+                    }
+                    std::string data = std::to_string(tid) + "_" + std::to_string(page_id.page_no) + "_0";
+                    strcpy(page->get_data(), data.c_str());
+                    EXPECT_TRUE(bpm->unpin_page(page_id, true));
+                    page_ids.push_back(page_id);
+                }
+                for (int round = 1; round <= num_rounds; round++) {
+                    for (auto &page_id : page_ids) {
+                        Page *page = bpm->fetch_page(page_id);
+                        while (page == nullptr) {
+                            page = bpm->fetch_page(page_id);
+                        }
+                        std::string expected = std::to_string(tid) + "_" + std::to_string(page_id.page_no) + "_" +
+                                               std::to_string(round - 1);
+                        EXPECT_STREQ(expected.c_str(), page->get_data());
+                        std::string data = std::to_string(tid) + "_" + std::to_string(page_id.page_no) + "_" +
+                                           std::to_string(round);
+                        strcpy(page->get_data(), data.c_str());
+                        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        // 刷盘后直接从磁盘读取，检查最后一轮写入的数据
+        char buf[PAGE_SIZE];
+        for (int tid = 0; tid < num_threads; tid++) {
+            bpm->flush_all_pages(fds[tid]);
+            for (auto &page_id : all_page_ids[tid]) {
+                disk_manager_->read_page(page_id.fd, page_id.page_no, buf, PAGE_SIZE);
+                std::string expected =
+                    std::to_string(tid) + "_" + std::to_string(page_id.page_no) + "_" + std::to_string(num_rounds);
+                EXPECT_STREQ(expected.c_str(), buf);
+            }
+        }
+
+        bpm.reset();
+        for (int fd : fds) {
+            disk_manager_->close_file(fd);
+        }
+    }
+}
+
+/**
+ * @brief 测试批量获取页面：缺页合并读入，重复的页面和超出缓冲池容量的请求也能正确处理
+ */
+TEST_F(BufferPoolManagerTest, FetchPagesTest) {
+    const int buffer_pool_size = 16;
+    const int num_pages = 64;
+    const std::string filename = "fetch_pages_test";
+
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+
+    // 每批获取8个页面（含一个重复页面），批次之间淘汰脏页
+    for (int start = 0; start + 7 <= num_pages; start += 7) {
+        std::vector<PageId> batch(page_ids.begin() + start, page_ids.begin() + start + 7);
+        batch.push_back(page_ids[start]);
+        std::vector<Page *> pages = bpm->fetch_pages(batch);
+        ASSERT_EQ(batch.size(), pages.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            ASSERT_NE(nullptr, pages[i]);
+            EXPECT_STREQ(std::to_string(batch[i].page_no).c_str(), pages[i]->get_data());
+        }
+        EXPECT_EQ(pages[0], pages.back());
+        for (size_t i = 0; i < batch.size(); i++) {
+            EXPECT_TRUE(bpm->unpin_page(batch[i], false));
+        }
+    }
+
+    // 请求超过缓冲池容量：无法获得帧的页面为nullptr
+    std::vector<Page *> pages = bpm->fetch_pages(page_ids);
+    int fetched = 0;
+    for (size_t i = 0; i < page_ids.size(); i++) {
+        if (pages[i] != nullptr) {
+            EXPECT_STREQ(std::to_string(page_ids[i].page_no).c_str(), pages[i]->get_data());
+            EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+            fetched++;
+        }
+    }
+    EXPECT_EQ(buffer_pool_size, fetched);
+
+    bpm.reset();
+    disk_manager->close_file(fd);
+}
+
+/**
+ * @brief 测试后台清理线程：按页面号顺序写回未被固定的脏页，之后的淘汰不再需要前台写回
+ */
+TEST_F(BufferPoolManagerTest, PageCleanerTest) {
+    const int buffer_pool_size = 32;
+    const std::string filename = "page_cleaner_test";
+
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+
+    std::vector<PageId> page_ids;
+    auto write_new_page = [&]() {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        EXPECT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    };
+
+    // 写满缓冲池，前半部分页面保持固定
+    for (int i = 0; i < buffer_pool_size; i++) {
+        write_new_page();
+    }
+    for (int i = 0; i < buffer_pool_size / 2; i++) {
+        EXPECT_NE(nullptr, bpm->fetch_page(page_ids[i]));
+    }
+
+    // 一轮清理只写回未被固定的脏页，且不超过目标个数
+    EXPECT_EQ(8, bpm->clean_pages(8));
+    EXPECT_EQ(0, bpm->clean_pages(8));
+    EXPECT_EQ(8, bpm->clean_pages(buffer_pool_size));
+    EXPECT_EQ(0, bpm->clean_pages(buffer_pool_size));
+    EXPECT_EQ(16, bpm->get_stats().cleaner_writes);
+
+    // 被清理的页面已经在磁盘上
+    char buf[PAGE_SIZE];
+    for (int i = buffer_pool_size / 2; i < buffer_pool_size; i++) {
+        disk_manager->read_page(fd, page_ids[i].page_no, buf, PAGE_SIZE);
+        EXPECT_STREQ(std::to_string(page_ids[i].page_no).c_str(), buf);
+    }
+    // 淘汰干净的页面不需要写回
+    for (int i = 0; i < buffer_pool_size / 2; i++) {
+        write_new_page();
+    }
+    EXPECT_EQ(buffer_pool_size / 2, bpm->get_stats().evictions);
+    EXPECT_EQ(0, bpm->get_stats().eviction_writes);
+    for (int i = 0; i < buffer_pool_size / 2; i++) {
+        EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+    }
+
+    // 后台清理线程运行时，反复读写所有页面，数据保持正确
+    bpm->start_page_cleaner(buffer_pool_size / 2, std::chrono::milliseconds(1));
+    for (int round = 0; round < 20; round++) {
+        for (auto &page_id : page_ids) {
+            Page *page = bpm->fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_STREQ(std::to_string(page_id.page_no).c_str(), page->get_data());
+            EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        }
+    }
+    bpm->stop_page_cleaner();
+    BufferPoolStats stats = bpm->get_stats();
+    // 页面数多于缓冲池容量，每一轮都要淘汰页面
+    EXPECT_GT(stats.evictions, buffer_pool_size / 2);
+    EXPECT_LE(stats.eviction_writes, stats.evictions);
+
+    bpm->flush_all_pages(fd);
+    for (auto &page_id : page_ids) {
+        disk_manager->read_page(fd, page_id.page_no, buf, PAGE_SIZE);
+        EXPECT_STREQ(std::to_string(page_id.page_no).c_str(), buf);
+    }
+    bpm.reset();
+    disk_manager->close_file(fd);
+}
+
+/**
+ * @brief 测试预读：显式预读的页面不被固定且内容正确；顺序读取时缓冲池自动预读，随机读取时不预读
+ */
+TEST_F(BufferPoolManagerTest, ReadAheadTest) {
+    const int buffer_pool_size = 32;
+    const int num_pages = 64;
+    const int window = 8;
+    const std::string filename = "read_ahead_test";
+
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());
+        EXPECT_TRUE(bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+    bpm->flush_all_pages(fd);
+
+    // 显式预读：预读的页面不被固定，超出文件末尾的部分被忽略
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+    bpm->set_read_ahead_window(0);
+    EXPECT_EQ(8, bpm->prefetch_pages(fd, 0, 8));
+    EXPECT_EQ(0, bpm->prefetch_pages(fd, 0, 8));
+    EXPECT_EQ(4, bpm->prefetch_pages(fd, num_pages - 4, 8));
+    for (int i = 0; i < 8; i++) {
+        Page *page = bpm->fetch_page(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        EXPECT_STREQ(std::to_string(i).c_str(), page->get_data());
+        EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+    }
+    BufferPoolStats stats = bpm->get_stats();
+    EXPECT_EQ(12, stats.prefetch_pages);
+    EXPECT_EQ(8, stats.prefetch_hits);
+
+    // 顺序读取：连续READ_AHEAD_TRIGGER次顺序缺页后开始预读，之后每个页面都命中预读
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+    bpm->set_read_ahead_window(window);
+    for (auto &page_id : page_ids) {
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_STREQ(std::to_string(page_id.page_no).c_str(), page->get_data());
+        EXPECT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    stats = bpm->get_stats();
+    EXPECT_EQ(num_pages - READ_AHEAD_TRIGGER - 1, stats.prefetch_hits);
+    EXPECT_EQ(stats.prefetch_hits, stats.prefetch_pages);
+    EXPECT_EQ(0, stats.prefetch_unused);
+
+    // 跳跃读取不触发预读
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+    bpm->set_read_ahead_window(window);
+    for (int i = 0; i < num_pages; i += 2) {
+        ASSERT_NE(nullptr, bpm->fetch_page(page_ids[i]));
+        EXPECT_TRUE(bpm->unpin_page(page_ids[i], false));
+    }
+    EXPECT_EQ(0, bpm->get_stats().prefetch_pages);
+
+    bpm.reset();
+    disk_manager->close_file(fd);
+}
@@ -147,3 +147,60 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 测试批量读写页面：分别使用当前系统上可用的I/O后端和pread/pwrite后端
+ */
+TEST_F(DiskManagerTest, BatchPageOperation) {
+    const std::string filename = "BatchPageOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    printf("io backend: %s\n", disk_manager_->get_io_backend_name());
+
+    std::vector<std::vector<char>> data(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<std::vector<char>> buf(MAX_PAGES, std::vector<char>(PAGE_SIZE));
+    std::vector<PageIORequest> requests;
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        rand_buf(data[page_no].data(), PAGE_SIZE);
+        requests.push_back({fd, page_no, data[page_no].data(), PAGE_SIZE, true});
+    }
+    disk_manager_->submit_pages(requests);
+
+    // 批量读（逆序提交），与写入的数据比较
+    requests.clear();
+    for (int page_no = MAX_PAGES - 1; page_no >= 0; page_no--) {
+        requests.push_back({fd, page_no, buf[page_no].data(), PAGE_SIZE, false});
+    }
+    disk_manager_->submit_pages(requests);
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        EXPECT_EQ(std::memcmp(buf[page_no].data(), data[page_no].data(), PAGE_SIZE), 0);
+    }
+
+    // pread/pwrite后端的结果应当一致
+    PosixIOBackend posix_backend;
+    for (auto &req : requests) {
+        std::memset(req.buf, 0, PAGE_SIZE);
+    }
+    posix_backend.submit_and_wait(requests.data(), requests.size());
+    for (int page_no = 0; page_no < MAX_PAGES; page_no++) {
+        EXPECT_EQ(requests[MAX_PAGES - 1 - page_no].result, PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf[page_no].data(), data[page_no].data(), PAGE_SIZE), 0);
+    }
+
+    // 读取文件末尾之后的页面：抛出异常，其余请求仍然完成
+    std::vector<PageIORequest> bad_requests = {{fd, 0, buf[0].data(), PAGE_SIZE, false},
+                                               {fd, MAX_PAGES + 10, buf[1].data(), PAGE_SIZE, false}};
+    try {
+        disk_manager_->submit_pages(bad_requests);
+        assert(false);
+    } catch (const InternalError &e) {
+    }
+    EXPECT_EQ(bad_requests[0].result, PAGE_SIZE);
+    EXPECT_NE(bad_requests[1].result, PAGE_SIZE);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
@@ -0,0 +1,140 @@
+#include "replacer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_replacer.h"
+
+/**
+ * @brief 简单测试LRUKReplacer的基本功能（K = 2）
+ */
+TEST(LRUKReplacerTest, SimpleTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+
+    // Scenario: 帧1~6各访问一次，帧1再访问一次
+    for (int i = 1; i <= 6; i++) {
+        lru_k_replacer.unpin(i);
+    }
+    lru_k_replacer.pin(1);
+    lru_k_replacer.unpin(1);
+    EXPECT_EQ(6, lru_k_replacer.Size());
+
+    // Scenario: 只访问过一次的帧优先按访问先后淘汰，访问过两次的帧1最后淘汰
+    int value;
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+
+    // Scenario: 帧4、5再访问一次，与帧1一起按倒数第二次访问时间排序：1(t1) < 4(t4) < 5(t5)
+    lru_k_replacer.pin(4);
+    lru_k_replacer.unpin(4);
+    lru_k_replacer.pin(5);
+    lru_k_replacer.unpin(5);
+    EXPECT_EQ(4, lru_k_replacer.Size());
+
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+
+    // Scenario: 固定的帧不会被淘汰
+    lru_k_replacer.pin(4);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    EXPECT_FALSE(lru_k_replacer.victim(&value));
+
+    // Scenario: remove清空访问历史，帧4重新装入页面后只算一次访问
+    lru_k_replacer.remove(4);
+    lru_k_replacer.unpin(4);
+    lru_k_replacer.unpin(2);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+}
+
+/**
+ * @brief 模拟缓冲池：热点页面被反复点查，期间穿插大表的顺序扫描，统计各置换策略的命中率
+ * @note 每次访问按照缓冲池的方式调用replacer：命中时pin再unpin，缺页时淘汰victim帧
+ */
+class ReplacerSimulator {
+   public:
+    ReplacerSimulator(Replacer *replacer, int pool_size) : replacer_(replacer), pool_size_(pool_size) {}
+
+    bool access(int page_no) {
+        auto it = page_table_.find(page_no);
+        frame_id_t frame_id;
+        bool hit = it != page_table_.end();
+        if (hit) {
+            frame_id = it->second;
+            replacer_->pin(frame_id);
+        } else {
+            if (next_free_ < pool_size_) {
+                frame_id = next_free_++;
+            } else {
+                EXPECT_TRUE(replacer_->victim(&frame_id));
+                page_table_.erase(frame_page_[frame_id]);
+            }
+            replacer_->remove(frame_id);
+            page_table_[page_no] = frame_id;
+            frame_page_[frame_id] = page_no;
+        }
+        replacer_->unpin(frame_id);
+        return hit;
+    }
+
+   private:
+    Replacer *replacer_;
+    int pool_size_;
+    int next_free_ = 0;
+    std::unordered_map<int, frame_id_t> page_table_;
+    std::unordered_map<frame_id_t, int> frame_page_;
+};
+
+// 只比较命中率的基准测试，默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+TEST(LRUKReplacerTest, DISABLED_HitRatioBenchmark) {
+    const int pool_size = 1000;
+    const int hot_pages = 800;        // 热点页面（如索引内部节点）
+    const int table_pages = 10000;    // 被顺序扫描的表
+    const int num_rounds = 20;
+    const int point_per_round = 20000;
+
+    std::vector<std::pair<std::string, std::unique_ptr<Replacer>>> replacers;
+    replacers.emplace_back("LRU", std::make_unique<LRUReplacer>(pool_size));
+    replacers.emplace_back("CLOCK", std::make_unique<ClockReplacer>(pool_size));
+    replacers.emplace_back("LRU-K", std::make_unique<LRUKReplacer>(pool_size));
+
+    std::vector<double> hot_hit_ratio;
+    for (auto &[name, replacer] : replacers) {
+        ReplacerSimulator sim(replacer.get(), pool_size);
+        std::mt19937 rng(2023);
+        long hot_hits = 0, hot_accesses = 0, hits = 0, accesses = 0;
+        for (int round = 0; round < num_rounds; round++) {
+            for (int i = 0; i < point_per_round; i++) {
+                bool hit = sim.access(rng() % hot_pages);
+                hot_hits += hit;
+                hot_accesses++;
+                hits += hit;
+                accesses++;
+                // 点查中穿插一次全表扫描
+                if (i == point_per_round / 2) {
+                    for (int page_no = hot_pages; page_no < hot_pages + table_pages; page_no++) {
+                        hits += sim.access(page_no);
+                        accesses++;
+                    }
+                }
+            }
+        }
+        hot_hit_ratio.push_back(1.0 * hot_hits / hot_accesses);
+        printf("%-6s hot page hit ratio: %.4f, overall hit ratio: %.4f\n", name.c_str(), hot_hit_ratio.back(),
+               1.0 * hits / accesses);
+    }
+    // LRU-K不会因为扫描而丢失热点页面
+    EXPECT_GT(hot_hit_ratio[2], hot_hit_ratio[0]);
+}
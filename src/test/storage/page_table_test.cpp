@@ -0,0 +1,180 @@
+#include "storage/page_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 测试PageTable的插入、查找、更新和删除
+ */
+TEST(PageTableTest, SimpleTest) {
+    PageTable table(8);
+    EXPECT_EQ(16, table.capacity());
+
+    frame_id_t frame_id;
+    EXPECT_FALSE(table.find({.fd = 3, .page_no = 0}, &frame_id));
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(table.insert({.fd = 3, .page_no = i}, i));
+    }
+    EXPECT_EQ(8, table.size());
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(table.find({.fd = 3, .page_no = i}, &frame_id));
+        EXPECT_EQ(i, frame_id);
+    }
+    // 不同文件的相同页面号是不同的表项
+    EXPECT_FALSE(table.find({.fd = 4, .page_no = 0}, &frame_id));
+
+    // 更新已有表项
+    EXPECT_FALSE(table.insert({.fd = 3, .page_no = 5}, 7));
+    EXPECT_TRUE(table.find({.fd = 3, .page_no = 5}, &frame_id));
+    EXPECT_EQ(7, frame_id);
+
+    EXPECT_TRUE(table.erase({.fd = 3, .page_no = 2}));
+    EXPECT_FALSE(table.erase({.fd = 3, .page_no = 2}));
+    EXPECT_FALSE(table.find({.fd = 3, .page_no = 2}, &frame_id));
+    EXPECT_EQ(7, table.size());
+}
+
+/**
+ * @brief 与std::unordered_map对照，随机插入删除后检查所有表项；表项数保持在容量上限附近，检验后移删除的正确性
+ */
+TEST(PageTableTest, MixTest) {
+    const int max_entries = 1000;
+    const int num_ops = 200000;
+    PageTable table(max_entries);
+    std::unordered_map<PageId, frame_id_t, PageIdHash> mock;
+    std::vector<PageId> keys;
+
+    std::mt19937 rng(2023);
+    for (int op = 0; op < num_ops; op++) {
+        if (keys.size() < static_cast<size_t>(max_entries) && (keys.empty() || rng() % 2 == 0)) {
+            PageId page_id = {.fd = static_cast<int>(rng() % 4), .page_no = static_cast<page_id_t>(rng() % 100000)};
+            frame_id_t frame_id = rng() % max_entries;
+            if (mock.count(page_id) == 0) keys.push_back(page_id);
+            mock[page_id] = frame_id;
+            table.insert(page_id, frame_id);
+        } else {
+            size_t idx = rng() % keys.size();
+            PageId page_id = keys[idx];
+            keys[idx] = keys.back();
+            keys.pop_back();
+            mock.erase(page_id);
+            EXPECT_TRUE(table.erase(page_id));
+        }
+    }
+    EXPECT_EQ(mock.size(), table.size());
+    for (auto &entry : mock) {
+        frame_id_t frame_id;
+        EXPECT_TRUE(table.find(entry.first, &frame_id));
+        EXPECT_EQ(entry.second, frame_id);
+    }
+}
+
+/**
+ * @brief 一个写线程不断删除并重新插入表项，多个读线程并发无锁查找；
+ * 读者可能因冲突查找失败，但找到的帧号必须正确
+ */
+TEST(PageTableTest, ConcurrencyTest) {
+    const int max_entries = 512;
+    const int num_readers = 4;
+    PageTable table(max_entries);
+    // 表项{fd, page_no}的帧号固定为page_no % max_entries，读者据此检查结果
+    for (int i = 0; i < max_entries; i++) {
+        table.insert({.fd = 1, .page_no = i}, i % max_entries);
+    }
+
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> readers;
+    std::atomic<long> hits = 0;
+    for (int tid = 0; tid < num_readers; tid++) {
+        readers.emplace_back([&table, &stop, &hits, tid]() {
+            std::mt19937 rng(tid);
+            long local_hits = 0;
+            while (!stop) {
+                page_id_t page_no = rng() % (max_entries * 2);
+                frame_id_t frame_id;
+                if (table.find({.fd = 1, .page_no = page_no}, &frame_id)) {
+                    EXPECT_EQ(page_no % max_entries, frame_id);
+                    local_hits++;
+                }
+            }
+            hits += local_hits;
+        });
+    }
+
+    // 写者让页面号在[0, 2 * max_entries)之间轮换，表项数保持为max_entries
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < max_entries; i++) {
+            page_id_t old_page_no = (round % 2) * max_entries + i;
+            page_id_t new_page_no = ((round + 1) % 2) * max_entries + i;
+            EXPECT_TRUE(table.erase({.fd = 1, .page_no = old_page_no}));
+            EXPECT_TRUE(table.insert({.fd = 1, .page_no = new_page_no}, new_page_no % max_entries));
+        }
+    }
+    stop = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(hits, 0);
+    EXPECT_EQ(max_entries, table.size());
+}
+
+/**
+ * @brief 微基准：缓冲池命中场景下PageTable与std::unordered_map的查找吞吐
+ * @note 只打印结果，不作为正确性判断；unordered_map按缓冲池原来的方式在mutex保护下查找
+ * 默认禁用，需要时使用--gtest_also_run_disabled_tests运行
+ */
+TEST(PageTableTest, DISABLED_LookupBenchmark) {
+    const int num_entries = 8192;
+    const int num_lookups = 4000000;
+    PageTable table(num_entries);
+    std::unordered_map<PageId, frame_id_t, PageIdHash> map;
+    std::mutex latch;
+    std::vector<PageId> probes;
+    for (int i = 0; i < num_entries; i++) {
+        PageId page_id = {.fd = 3 + i % 4, .page_no = i};
+        table.insert(page_id, i);
+        map[page_id] = i;
+    }
+    std::mt19937 rng(42);
+    for (int i = 0; i < num_lookups; i++) {
+        probes.push_back({.fd = 3 + static_cast<int>(i % 4), .page_no = static_cast<page_id_t>(rng() % num_entries)});
+    }
+
+    for (int num_threads : {1, 4}) {
+        auto run = [&](auto &&lookup) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            std::atomic<long> sum = 0;
+            for (int tid = 0; tid < num_threads; tid++) {
+                threads.emplace_back([&, tid]() {
+                    long local = 0;
+                    for (int i = tid; i < num_lookups; i += num_threads) local += lookup(probes[i]);
+                    sum += local;
+                });
+            }
+            for (auto &thread : threads) thread.join();
+            EXPECT_GT(sum, 0);
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        double map_ms = run([&](const PageId &page_id) {
+            std::scoped_lock lock{latch};
+            auto it = map.find(page_id);
+            return it == map.end() ? 0 : it->second;
+        });
+        double table_ms = run([&](const PageId &page_id) {
+            frame_id_t frame_id = 0;
+            table.find(page_id, &frame_id);
+            return frame_id;
+        });
+        printf("threads=%d lookups=%d unordered_map+mutex: %.1f ms, PageTable: %.1f ms\n", num_threads, num_lookups,
+               map_ms, table_ms);
+    }
+}
@@ -223,4 +223,74 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 测试按页扫描：扫描期间只固定当前页面，record()直接指向页面中的记录数据，扫描结束后不残留固定
+ */
+TEST(RecordManagerTest, ScanTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    auto pinned_frames = [&]() {
+        int pinned = 0;
+        for (size_t i = 0; i < buffer_pool_manager->pool_size_; i++) {
+            pinned += buffer_pool_manager->pages_[i].pin_count_ > 0;
+        }
+        return pinned;
+    };
+
+    std::string filename = "scan_test.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, sizeof(int));
+    auto file_handle = rm_manager->open_file(filename);
+    const int num_records = file_handle->file_hdr_.num_records_per_page * 3 + 5;
+    for (int i = 0; i < num_records; i++) {
+        file_handle->insert_record(reinterpret_cast<char *>(&i), nullptr);
+    }
+    EXPECT_EQ(5, file_handle->file_hdr_.num_pages);
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_handle->file_hdr_.num_pages; page_no++) {
+        RmPageHandle ph = file_handle->fetch_page_handle(page_no);
+        EXPECT_EQ(ph.page_hdr->num_records, Bitmap::count(ph.bitmap, file_handle->file_hdr_.num_records_per_page));
+        buffer_pool_manager->unpin_page(ph.page->get_page_id(), false);
+    }
+    EXPECT_EQ(0, pinned_frames());
+
+    // 逐条扫描
+    int next_value = 0;
+    {
+        RmScan scan(file_handle.get());
+        for (; !scan.is_end(); scan.next()) {
+            EXPECT_EQ(1, pinned_frames());
+            EXPECT_EQ(next_value++, *reinterpret_cast<int *>(scan.record()));
+        }
+        EXPECT_EQ(0, pinned_frames());
+    }
+    EXPECT_EQ(num_records, next_value);
+
+    // 按页扫描
+    next_value = 0;
+    int num_pages = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next_page()) {
+        ASSERT_EQ(scan.page_slot_nos().size(), scan.page_records().size());
+        EXPECT_EQ(scan.page_slot_nos().front(), scan.rid().slot_no);
+        for (size_t i = 0; i < scan.page_records().size(); i++) {
+            EXPECT_EQ(next_value++, *reinterpret_cast<int *>(scan.page_records()[i]));
+        }
+        num_pages++;
+    }
+    EXPECT_EQ(num_records, next_value);
+    EXPECT_EQ(4, num_pages);
+
+    // 提前结束的扫描在析构时释放固定
+    {
+        RmScan scan(file_handle.get());
+        scan.next();
+        EXPECT_EQ(1, pinned_frames());
+    }
+    EXPECT_EQ(0, pinned_frames());
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}